@@ -0,0 +1,226 @@
+/* Check of the adaptive Symbol table library (symtableadapt): runs phases
+of different workloads on a table, compares every result with an array of
+flags and checks the representations the table moves to */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtableadapt.h"
+#include "runsymcheck.h"
+
+#define NUM_RANGES 200      /* ranges in the range phase */
+#define WINDOW 256          /* operations between two cost estimates */
+#define WRITE_EVERY 3       /* windows of gets between two writes */
+#define NUM_WRITES 100      /* writes of the thrashing check */
+#define MAX_FREEZES 5       /* largest accepted moves to frozen */
+#define MIN_FROZEN WINDOW   /* smallest table that must freeze */
+#define MAX_FROZEN 4096     /* largest table whose freezing pays back */
+#define MIN_THRASH 256      /* smallest table that must not thrash */
+
+/* Struct passed to check_bind by a range */
+struct rangecheck {
+    const char *low;
+    const char *high;
+    char last[KEY_LEN];
+    int count;
+    int failed;
+};
+
+void check_bind(const char *pcKey, void *pvValue, void *pvExtra);
+int check_range(SymTableAdapt_T oSymTable, int i, int j);
+int check_phases(void);
+int check_thrash(void);
+
+/* Operations of an adaptive table */
+const struct checkops adapt_ops = {
+    SymTableAdapt_put, SymTableAdapt_remove, SymTableAdapt_get,
+    SymTableAdapt_contains, SymTableAdapt_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    int failed;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    failed = check_phases();
+    memset(flags, 0, num_keys);
+    failed += check_thrash();
+
+    return check_finish(failed);
+}
+
+
+/* check_bind
+
+Function used by SymTableAdapt_range() to check that every binding is in
+the table, within the range and after the previous one, and to count the
+bindings.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value, which is the flag of the key.
+pvExtra: pointer to a struct rangecheck.
+
+Returns: void */
+void check_bind(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct rangecheck *range;
+    int i;
+
+    range = pvExtra;
+    i = atoi(pcKey + 1);
+    if (i < 0 || i >= num_keys || !flags[i] || pvValue != &flags[i] ||
+        strcmp(pcKey, range->low) < 0 || strcmp(pcKey, range->high) >= 0 ||
+        (range->count && strcmp(pcKey, range->last) <= 0)) {
+        range->failed = 1;
+    }
+    strcpy(range->last, pcKey);
+    range->count++;
+    return;
+}
+
+
+/* check_range
+
+Runs a range from key number i to key number j and checks its bindings
+and their number against the flags.
+
+Parameters:
+oSymTable: a SymTableAdapt_T type.
+i: number of the key of the lower bound.
+j: number of the key of the upper bound.
+
+Returns: 1 if the range is wrong, 0 otherwise */
+int check_range(SymTableAdapt_T oSymTable, int i, int j) {
+    struct rangecheck range;
+    char low[KEY_LEN], high[KEY_LEN], key[KEY_LEN];
+    int k, expected;
+    unsigned int count;
+
+    check_key(low, i);
+    check_key(high, j);
+    range.low = low;
+    range.high = high;
+    range.count = 0;
+    range.failed = 0;
+    count = SymTableAdapt_range(oSymTable, low, high, check_bind, &range);
+
+    expected = 0;
+    for (k = 0; k < num_keys; k++) {
+        check_key(key, k);
+        expected += flags[k] && strcmp(key, low) >= 0 && strcmp(key, high) < 0;
+    }
+
+    return range.failed || range.count != expected || (int) count != expected;
+}
+
+
+/* check_phases
+
+Runs phases of puts, gets, ranges and random changes on one table and
+checks every result. Reads alone must freeze a table of MIN_FROZEN to
+MAX_FROZEN keys, since larger tables take too long to move, and the
+changes that follow must move it out of the frozen representation.
+
+Returns: the number of failed checks */
+int check_phases(void) {
+    SymTableAdapt_T oSymTable;
+    int i, op, size, failed, wrong, frozen;
+
+    oSymTable = SymTableAdapt_new();
+    failed = 0;
+
+    wrong = 0;
+    for (i = 0; i < num_keys; i++) {
+        wrong |= check_op(&adapt_ops, oSymTable, 0, rand() % num_keys);
+    }
+    failed += report("puts", wrong);
+
+    wrong = 0;
+    for (op = 0; op < NUM_OPS * num_keys; op++) {
+        wrong |= check_op(&adapt_ops, oSymTable, 2 + rand() % 2,
+                          rand() % num_keys);
+    }
+    failed += report("gets", wrong);
+    frozen = SymTableAdapt_getKind(oSymTable) == SYMTABLEADAPT_FROZEN;
+    failed += report("frozen by gets", num_keys >= MIN_FROZEN &&
+                     num_keys <= MAX_FROZEN && !frozen);
+
+    wrong = 0;
+    for (op = 0; op < NUM_RANGES; op++) {
+        wrong |= check_range(oSymTable, rand() % num_keys, rand() % num_keys);
+    }
+    failed += report("ranges", wrong);
+
+    wrong = 0;
+    for (op = 0; op < NUM_OPS * num_keys; op++) {
+        wrong |= check_op(&adapt_ops, oSymTable, rand() % 4,
+                          rand() % num_keys);
+    }
+    failed += report("changes", wrong);
+    frozen = SymTableAdapt_getKind(oSymTable) == SYMTABLEADAPT_FROZEN;
+    failed += report("unfrozen", frozen);
+
+    size = 0;
+    for (i = 0; i < num_keys; i++) {
+        size += flags[i];
+    }
+    failed += report("length", (int) SymTableAdapt_getLength(oSymTable) != size);
+    SymTableAdapt_free(oSymTable);
+
+    return failed;
+}
+
+
+/* check_thrash
+
+Freezes a table with gets, then writes to it once every WRITE_EVERY
+windows of gets. Each write moves the table out of the frozen
+representation. From MIN_THRASH keys on, two moves cost more than the
+gets between two writes save, so the table must not be frozen again after
+every write.
+
+Returns: the number of failed checks */
+int check_thrash(void) {
+    SymTableAdapt_T oSymTable;
+    int i, op, write, kind, last, freezes, wrong;
+
+    oSymTable = SymTableAdapt_new();
+    wrong = 0;
+    for (i = 0; i < num_keys; i++) {
+        wrong |= check_op(&adapt_ops, oSymTable, 0, i);
+    }
+    for (op = 0; op < NUM_OPS * num_keys; op++) {
+        wrong |= check_op(&adapt_ops, oSymTable, 2, rand() % num_keys);
+    }
+
+    freezes = 0;
+    last = SymTableAdapt_getKind(oSymTable);
+    for (write = 0; write < NUM_WRITES; write++) {
+        wrong |= check_op(&adapt_ops, oSymTable, write % 2, num_keys - 1);
+        for (op = 0; op < WRITE_EVERY * WINDOW; op++) {
+            wrong |= check_op(&adapt_ops, oSymTable, 2, rand() % num_keys);
+            kind = SymTableAdapt_getKind(oSymTable);
+            freezes += kind == SYMTABLEADAPT_FROZEN &&
+                       last != SYMTABLEADAPT_FROZEN;
+            last = kind;
+        }
+    }
+    printf("++> %d writes, %d moves to frozen\n", NUM_WRITES, freezes);
+    SymTableAdapt_free(oSymTable);
+
+    return report("thrash results", wrong) +
+           report("thrash freezes",
+                  num_keys >= MIN_THRASH && freezes > MAX_FREEZES);
+}
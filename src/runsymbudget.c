@@ -0,0 +1,171 @@
+/* Check of the memory budget library (symbudget): runs random operations
+on a table attached to a small budget whose shrink callback evicts
+bindings from that same table, and compares every result with an array of
+flags from which the evicted keys are cleared */
+
+#include <stdio.h>
+#include "symtable.h"
+#include "symbudget.h"
+#include "runsymcheck.h"
+
+#define LIMIT 8192      /* bytes of the budget */
+#define NUM_MERGED 40   /* keys merged from another table */
+
+int evictions;          /* bindings removed by evict */
+int victim;             /* number of the next key evict tries */
+SymTable_T protected;   /* table whose keys are not evicted, or NULL */
+
+int evict(size_t uiNeeded, void *pvExtra);
+int check_same(SymTable_T oSymTable, SymTable_T oOther);
+int check_budget(int sorted);
+
+/* Operations of a list table */
+const struct checkops list_ops = {
+    SymTable_put, SymTable_remove, SymTable_get, SymTable_contains,
+    SymTable_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    int i, failed;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    failed = check_budget(0);
+    for (i = 0; i < num_keys; i++) {
+        flags[i] = 0;
+    }
+    failed += check_budget(1);
+
+    return check_finish(failed);
+}
+
+
+/* evict
+
+Shrink callback that removes one binding from the table being charged,
+taking the keys in turn, and clears its flag. The keys of the protected
+table are skipped: a merge from it would insert them again.
+
+Parameters:
+uiNeeded: number of bytes being charged.
+pvExtra: the SymTable_T type attached to the budget.
+
+Returns: 1 if a binding was removed, 0 if the table is empty */
+int evict(size_t uiNeeded, void *pvExtra) {
+    char key[KEY_LEN];
+    int tries;
+
+    for (tries = 0; tries < num_keys; tries++) {
+        victim = (victim + 1) % num_keys;
+        if (!flags[victim]) {
+            continue;
+        }
+        check_key(key, victim);
+        if (protected && SymTable_contains(protected, key)) {
+            continue;
+        }
+        if (SymTable_remove(pvExtra, key)) {
+            check_clear(victim);
+            evictions++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* check_same
+
+Checks that oSymTable and oOther, if not NULL, contain exactly the keys
+whose flags are set.
+
+Parameters:
+oSymTable: a SymTable_T type.
+oOther: a SymTable_T type or NULL.
+
+Returns: 1 if a key is wrong, 0 otherwise */
+int check_same(SymTable_T oSymTable, SymTable_T oOther) {
+    char key[KEY_LEN];
+    int i, wrong;
+
+    wrong = 0;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        wrong |= SymTable_contains(oSymTable, key) != flags[i];
+        if (oOther) {
+            wrong |= SymTable_contains(oOther, key) != flags[i];
+        }
+    }
+    return wrong;
+}
+
+
+/* check_budget
+
+Runs random operations, a merge and a clone on a table attached to a
+budget of LIMIT bytes that evicts from the table itself, and checks the
+results, that the budget was kept and that freeing the tables releases
+all their memory.
+
+Parameters:
+sorted: 1 for a sorted table, 0 otherwise.
+
+Returns: the number of failed checks */
+int check_budget(int sorted) {
+    SymBudget_T oBudget;
+    SymTable_T oSymTable, oOther, oClone;
+    char key[KEY_LEN];
+    int i, failed, over;
+
+    printf("++> ----------%s----------\n", sorted ? "Sorted" : "Unsorted");
+    oBudget = SymBudget_new(LIMIT);
+    oSymTable = sorted ? SymTable_newSorted() : SymTable_new();
+    SymTable_setBudget(oSymTable, oBudget);
+    SymBudget_addShrink(oBudget, evict, oSymTable);
+    evictions = 0;
+
+    failed = report("operations", check_ops(&list_ops, oSymTable));
+    over = SymBudget_getUsed(oBudget) > LIMIT;
+
+    /* the keys of a small table are merged in while other keys are
+    evicted */
+    oOther = sorted ? SymTable_newSorted() : SymTable_new();
+    for (i = 0; i < num_keys; i += num_keys / NUM_MERGED + 1) {
+        check_key(key, i);
+        SymTable_put(oOther, key, &flags[i]);
+        flags[i] = 1;
+    }
+    protected = oOther;
+    SymTable_merge(oSymTable, oOther, NULL, NULL);
+    protected = NULL;
+    failed += report("merge", check_same(oSymTable, NULL));
+    over |= SymBudget_getUsed(oBudget) > LIMIT;
+
+    /* the copy is charged to the budget of the table it copies */
+    oClone = SymTable_clone(oSymTable);
+    failed += report("clone", !oClone || check_same(oSymTable, oClone));
+    over |= SymBudget_getUsed(oBudget) > LIMIT;
+    SymTable_free(oClone);
+
+    printf("++> %d evictions\n", evictions);
+    failed += report("evictions", num_keys > LIMIT / 16 && !evictions);
+    failed += report("limit", over);
+    SymTable_free(oOther);
+    SymTable_free(oSymTable);
+    failed += report("released", SymBudget_getUsed(oBudget) != 0);
+    SymBudget_free(oBudget);
+
+    return failed;
+}
@@ -0,0 +1,294 @@
+/* Harness shared by the module checkers (runsym*.c) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "runsymcheck.h"
+
+char *flags;            /* flags[i] is 1 if key i is in the table */
+int num_keys;
+
+static char *seen;      /* seen[i] is 1 if the current map visited key i */
+static int size;        /* number of flags set, kept by check_ops */
+static void (*make_key)(char *key, int i);
+
+
+/* default_key
+
+Writes key number i to key. Keys of different lengths are used.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+static void default_key(char *key, int i) {
+    sprintf(key, "k%d%.*s", i, i % 11, "abcdefghijk");
+    return;
+}
+
+
+/* check_start
+
+Reads NUM_KEYS from the command line, allocates the flags and seeds
+rand().
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+pfMakeKey: function that writes key number i, or NULL for keys "k<i>"
+followed by up to 10 letters.
+
+Returns: 1 if the checks can run, 0 after printing the usage */
+int check_start(int argc, char **argv, void (*pfMakeKey)(char *key, int i)) {
+    if (argc != 2) {
+        printf("Usage: %s {NUM_KEYS}\n", argv[0]);
+        return 0;
+    }
+    num_keys = atoi(argv[1]);
+    if (num_keys <= 0) {
+        printf("NUM_KEYS must be > 0\n");
+        return 0;
+    }
+    flags = calloc(num_keys, 1);
+    seen = calloc(num_keys, 1);
+    assert(flags && seen);
+    make_key = pfMakeKey ? pfMakeKey : default_key;
+    srand(1);
+
+    return 1;
+}
+
+
+/* check_finish
+
+Prints the number of failed checks and frees the flags.
+
+Parameters:
+failed: number of failed checks.
+
+Returns: 0 if all checks passed, 1 otherwise */
+int check_finish(int failed) {
+    free(flags);
+    free(seen);
+    printf("++> %d checks failed\n", failed);
+    return failed != 0;
+}
+
+
+/* check_key
+
+Writes key number i to key with the function given to check_start.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void check_key(char *key, int i) {
+    make_key(key, i);
+    return;
+}
+
+
+/* report
+
+Prints the result of a check.
+
+Parameters:
+name: name of the check.
+failed: 1 if the check failed, 0 otherwise.
+
+Returns: failed */
+int report(const char *name, int failed) {
+    printf("++> %-16s %s\n", name, failed ? "FAILED" : "ok");
+    return failed;
+}
+
+
+/* check_op
+
+Runs one operation on key number i and compares its result with the
+flags, which it updates.
+
+Parameters:
+ops: the operations of pvTable.
+pvTable: a table.
+op: 0 for put, 1 for remove, 2 for get, 3 for contains.
+i: number of the key.
+
+Returns: 1 if the result is wrong, 0 otherwise */
+int check_op(const struct checkops *ops, void *pvTable, int op, int i) {
+    char key[KEY_LEN];
+    int failed;
+
+    make_key(key, i);
+    size -= flags[i];
+    switch (op) {
+    case 0:
+        failed = ops->pfPut(pvTable, key, &flags[i]) != !flags[i];
+        flags[i] = 1;
+        break;
+    case 1:
+        failed = ops->pfRemove(pvTable, key) != flags[i];
+        flags[i] = 0;
+        break;
+    case 2:
+        if (ops->pfGet) {
+            failed = ops->pfGet(pvTable, key) != (flags[i] ? &flags[i] : NULL);
+            break;
+        }
+        /* fall through to contains */
+    default:
+        failed = ops->pfContains(pvTable, key) != flags[i];
+    }
+    size += flags[i];
+
+    return failed;
+}
+
+
+/* check_ops
+
+Runs NUM_OPS random operations per key on pvTable and compares their
+results and the length of the table with the flags.
+
+Parameters:
+ops: the operations of pvTable.
+pvTable: a table whose keys match the flags.
+
+Returns: 1 if the check failed, 0 otherwise */
+int check_ops(const struct checkops *ops, void *pvTable) {
+    int i, op, failed;
+
+    size = 0;
+    for (i = 0; i < num_keys; i++) {
+        size += flags[i];
+    }
+    failed = 0;
+    for (op = 0; op < NUM_OPS * num_keys; op++) {
+        i = rand() % num_keys;
+        failed |= check_op(ops, pvTable, rand() % 4, i);
+        failed |= (int) ops->pfGetLength(pvTable) != size;
+    }
+
+    return failed;
+}
+
+
+/* check_clear
+
+Clears the flag of key number i, which was removed from the table by
+other means than check_op, for example by a shrink callback.
+
+Parameters:
+i: number of the key.
+
+Returns: void */
+void check_clear(int i) {
+    size -= flags[i];
+    flags[i] = 0;
+    return;
+}
+
+
+/* check_index
+
+Returns: the number of the key whose value is pvValue, or -1 if pvValue
+is not the value of a key in the table */
+int check_index(const void *pvValue) {
+    long i;
+
+    i = (const char *) pvValue - flags;
+    if (i < 0 || i >= num_keys || !flags[i]) {
+        return -1;
+    }
+
+    return (int) i;
+}
+
+
+/* count_index
+
+Counts key number i in the counter of a map, or sets the counter to -1
+if i is -1 or was already visited */
+static void count_index(int i, int *counter) {
+    if (*counter < 0 || i < 0 || seen[i]) {
+        *counter = -1;
+        return;
+    }
+    seen[i] = 1;
+    (*counter)++;
+}
+
+
+/* check_count_bind, check_count_value, check_count_key
+
+Functions used by the map of a table to count its bindings, given
+pointer to an integer counter as pvExtra. The counter is set to -1 when a
+binding is not in the flags, has the wrong key or is visited twice.
+check_count_key only knows the keys of the default key function.
+
+Returns: void */
+void check_count_bind(const char *pcKey, void *pvValue, void *pvExtra) {
+    char key[KEY_LEN];
+    int i;
+
+    i = check_index(pvValue);
+    if (i >= 0) {
+        make_key(key, i);
+        if (strcmp(key, pcKey)) {
+            i = -1;
+        }
+    }
+    count_index(i, pvExtra);
+    return;
+}
+
+void check_count_value(void *pvValue, void *pvExtra) {
+    count_index(check_index(pvValue), pvExtra);
+    return;
+}
+
+void check_count_key(const char *pcKey, void *pvExtra) {
+    char key[KEY_LEN];
+    int i;
+
+    i = atoi(pcKey + 1);
+    if (i < 0 || i >= num_keys || !flags[i]) {
+        i = -1;
+    }
+    else {
+        make_key(key, i);
+        if (strcmp(key, pcKey)) {
+            i = -1;
+        }
+    }
+    count_index(i, pvExtra);
+    return;
+}
+
+
+/* check_mapped
+
+Checks the counter of a map against the flags and prepares the next map.
+
+Parameters:
+name: name of the check.
+count: counter of check_count_bind, check_count_value or check_count_key.
+
+Returns: 1 if the check failed, 0 otherwise */
+int check_mapped(const char *name, int count) {
+    int i, size;
+
+    size = 0;
+    for (i = 0; i < num_keys; i++) {
+        size += flags[i];
+    }
+    memset(seen, 0, num_keys);
+
+    return report(name, count != size);
+}
@@ -0,0 +1,151 @@
+/* Harness shared by the module checkers (runsym*.c). A checker runs random
+operations on a table of NUM_KEYS keys and compares every result with an
+array of flags: flags[i] is 1 if key number i is in the table, and the
+value of key i is the address of flags[i], so a value tells its key. */
+
+#ifndef RUNSYMCHECK_INCLUDE
+#define RUNSYMCHECK_INCLUDE
+
+#define KEY_LEN 96      /* largest key, with its '\0' */
+#define NUM_OPS 20      /* random operations per key */
+
+extern char *flags;     /* flags[i] is 1 if key i is in the table */
+extern int num_keys;
+
+/* Operations of a table, called with the table as first argument. get can
+be NULL for tables without values, and getLength for tables without a
+length if check_ops is not used. */
+struct checkops {
+    int (*pfPut)(void *pvTable, const char *pcKey, const void *pvValue);
+    int (*pfRemove)(void *pvTable, const char *pcKey);
+    void *(*pfGet)(void *pvTable, const char *pcKey);
+    int (*pfContains)(void *pvTable, const char *pcKey);
+    unsigned int (*pfGetLength)(void *pvTable);
+};
+
+
+/* check_start
+
+Reads NUM_KEYS from the command line, allocates the flags and seeds
+rand().
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+pfMakeKey: function that writes key number i, or NULL for keys "k<i>"
+followed by up to 10 letters.
+
+Returns: 1 if the checks can run, 0 after printing the usage */
+int check_start(int argc, char **argv, void (*pfMakeKey)(char *key, int i));
+
+
+/* check_finish
+
+Prints the number of failed checks and frees the flags.
+
+Parameters:
+failed: number of failed checks.
+
+Returns: 0 if all checks passed, 1 otherwise */
+int check_finish(int failed);
+
+
+/* check_key
+
+Writes key number i to key with the function given to check_start.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void check_key(char *key, int i);
+
+
+/* report
+
+Prints the result of a check.
+
+Parameters:
+name: name of the check.
+failed: 1 if the check failed, 0 otherwise.
+
+Returns: failed */
+int report(const char *name, int failed);
+
+
+/* check_op
+
+Runs one operation on key number i and compares its result with the
+flags, which it updates.
+
+Parameters:
+ops: the operations of pvTable.
+pvTable: a table.
+op: 0 for put, 1 for remove, 2 for get, 3 for contains.
+i: number of the key.
+
+Returns: 1 if the result is wrong, 0 otherwise */
+int check_op(const struct checkops *ops, void *pvTable, int op, int i);
+
+
+/* check_ops
+
+Runs NUM_OPS random operations per key on pvTable and compares their
+results and the length of the table with the flags.
+
+Parameters:
+ops: the operations of pvTable.
+pvTable: a table whose keys match the flags.
+
+Returns: 1 if the check failed, 0 otherwise */
+int check_ops(const struct checkops *ops, void *pvTable);
+
+
+/* check_clear
+
+Clears the flag of key number i, which was removed from the table by
+other means than check_op, for example by a shrink callback.
+
+Parameters:
+i: number of the key.
+
+Returns: void */
+void check_clear(int i);
+
+
+/* check_index
+
+Returns: the number of the key whose value is pvValue, or -1 if pvValue
+is not the value of a key in the table */
+int check_index(const void *pvValue);
+
+
+/* check_count_bind, check_count_value, check_count_key
+
+Functions used by the map of a table to count its bindings, given
+pointer to an integer counter as pvExtra. The counter is set to -1 when a
+binding is not in the flags, has the wrong key or is visited twice.
+check_count_key only knows the keys of the default key function.
+
+Returns: void */
+void check_count_bind(const char *pcKey, void *pvValue, void *pvExtra);
+void check_count_value(void *pvValue, void *pvExtra);
+void check_count_key(const char *pcKey, void *pvExtra);
+
+
+/* check_mapped
+
+Checks the counter of a map against the flags and prepares the next map.
+
+Parameters:
+name: name of the check.
+count: counter of check_count_bind, check_count_value or check_count_key.
+
+Returns: 1 if the check failed, 0 otherwise */
+int check_mapped(const char *name, int count);
+
+
+#endif
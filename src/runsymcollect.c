@@ -0,0 +1,207 @@
+/* Check of the Symbol collection library (symcollect): several threads
+insert overlapping sets of keys, then the merged bindings are compared with
+the keys and values each thread was given */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "symcollect.h"
+#include "runsymcheck.h"
+
+#define NUM_THREADS 4   /* threads that insert keys */
+#define NUM_PARTS 8     /* partitions of each collector */
+#define NUM_WORKERS 3   /* threads that merge partitions */
+
+int thread_ids[NUM_THREADS];    /* values put by each thread */
+
+/* Struct given to an inserting thread */
+struct inserter {
+    SymCollect_T oCollect;
+    int thread;
+    int failed;
+};
+
+int has_key(int thread, int i);
+void *insert_keys(void *pvArg);
+void *keep_new(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra);
+void count_bind(const char *pcKey, void *pvValue, void *pvExtra);
+int check_collect(int keep_lowest);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    int i, failed;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        thread_ids[i] = i;
+    }
+
+    failed = check_collect(1);
+    failed += check_collect(0);
+
+    return check_finish(failed);
+}
+
+
+/* has_key
+
+Tells whether a thread inserts key number i. Thread t inserts the keys
+whose number has bit t set, so most keys are inserted by more than one
+thread and key 0 by none.
+
+Parameters:
+thread: index of the thread.
+i: number of the key.
+
+Returns: 1 if the thread inserts the key, 0 otherwise */
+int has_key(int thread, int i) {
+    return (i >> thread) & 1;
+}
+
+
+/* insert_keys
+
+Thread function that puts the keys of one thread twice, checking that
+only the first put of each key creates a binding.
+
+Parameters:
+pvArg: pointer to a struct inserter.
+
+Returns: NULL */
+void *insert_keys(void *pvArg) {
+    struct inserter *ins;
+    char key[KEY_LEN];
+    int i, round;
+
+    ins = pvArg;
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < num_keys; i++) {
+            if (!has_key(ins->thread, i)) {
+                continue;
+            }
+            check_key(key, i);
+            ins->failed |= SymCollect_put(ins->oCollect, ins->thread, key,
+                                          &thread_ids[ins->thread]) != !round;
+        }
+    }
+    return NULL;
+}
+
+
+/* keep_new
+
+Conflict resolution that keeps the value of the higher numbered thread.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvOld: value of the lower numbered thread.
+pvNew: value of the higher numbered thread.
+pvExtra: not used.
+
+Returns: pvNew */
+void *keep_new(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra) {
+    return pvNew;
+}
+
+
+/* count_bind
+
+Function used by SymCollect_map() to count the merged bindings.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value.
+pvExtra: pointer to an integer counter.
+
+Returns: void */
+void count_bind(const char *pcKey, void *pvValue, void *pvExtra) {
+    (*(int *) pvExtra)++;
+    return;
+}
+
+
+/* check_collect
+
+Inserts the keys of every thread from NUM_THREADS threads, merges them and
+checks the merged bindings: every key inserted by some thread must be found
+with the value of the lowest or the highest numbered thread that inserted
+it, and no other key must be found.
+
+Parameters:
+keep_lowest: 1 to merge without a resolve function, 0 to keep the value
+of the higher numbered thread on a conflict.
+
+Returns: the number of failed checks */
+int check_collect(int keep_lowest) {
+    SymCollect_T oCollect;
+    pthread_t threads[NUM_THREADS];
+    struct inserter ins[NUM_THREADS];
+    char key[KEY_LEN];
+    int i, t, expected, merged, count, failed, wrong;
+    int *value;
+
+    printf("++> ----------%s----------\n",
+           keep_lowest ? "Keep lowest thread" : "Keep highest thread");
+    oCollect = SymCollect_new(NUM_THREADS, NUM_PARTS);
+    for (t = 0; t < NUM_THREADS; t++) {
+        ins[t].oCollect = oCollect;
+        ins[t].thread = t;
+        ins[t].failed = 0;
+        if (pthread_create(&threads[t], NULL, insert_keys, &ins[t]) != 0) {
+            printf("Could not create thread %d\n", t);
+            exit(1);
+        }
+    }
+    failed = 0;
+    for (t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        failed |= ins[t].failed;
+    }
+    failed = report("puts", failed);
+
+    merged = SymCollect_merge(oCollect, NUM_WORKERS,
+                              keep_lowest ? NULL : keep_new, NULL);
+
+    expected = 0;
+    wrong = 0;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        value = SymCollect_get(oCollect, key);
+        if (keep_lowest) {
+            for (t = 0; t < NUM_THREADS && !has_key(t, i); t++)
+                ;
+        }
+        else {
+            for (t = NUM_THREADS - 1; t >= 0 && !has_key(t, i); t--)
+                ;
+        }
+        if (t < 0 || t == NUM_THREADS) {
+            wrong |= value != NULL;
+        }
+        else {
+            expected++;
+            wrong |= value != &thread_ids[t];
+        }
+    }
+    failed += report("gets", wrong);
+
+    count = 0;
+    SymCollect_map(oCollect, count_bind, &count);
+    failed += report("merged count", merged != expected || count != expected);
+    SymCollect_free(oCollect);
+
+    return failed;
+}
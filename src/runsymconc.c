@@ -0,0 +1,458 @@
+/* Check of the concurrent Symbol table library (symtableconc): runs
+random operations on a table from one thread and compares every result
+with an array of flags, then checks the counters incremented by several
+threads at once, the lookup caches of a thread whose keys are changed by
+other threads, the snapshots of a table changed while they are visited
+and the values computed once for threads that miss on the same keys */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include "symtableconc.h"
+#include "runsymcheck.h"
+
+#define NUM_THREADS 4   /* threads that use the table at once */
+#define BLOCK 64        /* keys cached before other threads change them */
+
+/* Struct given to a thread */
+struct worker {
+    SymTableConc_T oSymTable;
+    int thread;
+    int failed;
+};
+
+int block;              /* number of the first key of the current block */
+char changed;           /* value of the keys changed by other threads */
+int *computes;          /* computes[i] counts the computations of key i */
+
+/* Struct given to the function applied by SymTableConc_mapSnapshot */
+struct snapshot {
+    SymTableConc_T oSymTable;
+    int count;          /* counter of check_count_bind */
+};
+
+void run_threads(SymTableConc_T oSymTable, void *(*pfRun)(void *pvArg),
+                 struct worker *workers);
+long delta(int i);
+void *add_counters(void *pvArg);
+int check_counters(void);
+void *change_value(const char *pcKey, void *pvValue, void *pvExtra);
+void *change_block(void *pvArg);
+void *cached_value(SymTableConc_T oSymTable, int i);
+int check_cached(void);
+void *change_evens(void *pvArg);
+void change_during_map(const char *pcKey, void *pvValue, void *pvExtra);
+int check_snapshot(void);
+void *compute(const char *pcKey, void *pvExtra);
+void *get_or_compute(void *pvArg);
+int check_compute(void);
+
+/* Operations of a concurrent table */
+const struct checkops conc_ops = {
+    SymTableConc_put, SymTableConc_remove, SymTableConc_get,
+    SymTableConc_contains, SymTableConc_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    SymTableConc_T oSymTable;
+    int failed, count;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    oSymTable = SymTableConc_new();
+    failed = report("operations", check_ops(&conc_ops, oSymTable));
+    count = 0;
+    SymTableConc_map(oSymTable, check_count_bind, &count);
+    failed += check_mapped("map", count);
+    SymTableConc_free(oSymTable);
+
+    printf("++> ----------Threads----------\n");
+    failed += check_counters();
+    failed += check_cached();
+    failed += check_snapshot();
+    failed += check_compute();
+
+    return check_finish(failed);
+}
+
+
+/* run_threads
+
+Runs pfRun in NUM_THREADS threads on oSymTable and waits for them.
+
+Parameters:
+oSymTable: a SymTableConc_T type.
+pfRun: thread function, given a struct worker.
+workers: array of NUM_THREADS struct worker, whose failed fields are
+set by pfRun.
+
+Returns: void */
+void run_threads(SymTableConc_T oSymTable, void *(*pfRun)(void *pvArg),
+                 struct worker *workers) {
+    pthread_t threads[NUM_THREADS];
+    int t;
+
+    for (t = 0; t < NUM_THREADS; t++) {
+        workers[t].oSymTable = oSymTable;
+        workers[t].thread = t;
+        workers[t].failed = 0;
+        if (pthread_create(&threads[t], NULL, pfRun, &workers[t]) != 0) {
+            printf("Could not create thread %d\n", t);
+            exit(1);
+        }
+    }
+    for (t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return;
+}
+
+
+/* delta
+
+Returns: the value each thread adds to the counter of key number i at
+every round, between -1 and 3 */
+long delta(int i) {
+    return i % 5 - 1;
+}
+
+
+/* add_counters
+
+Thread function that adds delta(i) to the counter of every key NUM_OPS
+times. Each thread starts at a different key, so the first increments of
+a key, which create its binding, race with each other.
+
+Parameters:
+pvArg: pointer to a struct worker.
+
+Returns: NULL */
+void *add_counters(void *pvArg) {
+    struct worker *w;
+    char key[KEY_LEN];
+    int i, j, round;
+
+    w = pvArg;
+    for (round = 0; round < NUM_OPS; round++) {
+        for (j = 0; j < num_keys; j++) {
+            i = (j + w->thread * num_keys / NUM_THREADS) % num_keys;
+            check_key(key, i);
+            SymTableConc_addInt(w->oSymTable, key, delta(i));
+        }
+    }
+    return NULL;
+}
+
+
+/* check_counters
+
+Increments the counters of all keys from NUM_THREADS threads at once and
+checks that no increment was lost and that every key has one binding.
+
+Returns: the number of failed checks */
+int check_counters(void) {
+    SymTableConc_T oSymTable;
+    struct worker workers[NUM_THREADS];
+    char key[KEY_LEN];
+    int i, wrong;
+
+    oSymTable = SymTableConc_new();
+    run_threads(oSymTable, add_counters, workers);
+
+    wrong = SymTableConc_getLength(oSymTable) != (unsigned int) num_keys;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        wrong |= SymTableConc_getInt(oSymTable, key)
+                 != (long) NUM_THREADS * NUM_OPS * delta(i);
+    }
+    SymTableConc_free(oSymTable);
+
+    return report("addInt", wrong);
+}
+
+
+/* change_value
+
+Function used by SymTableConc_update() to replace a value.
+
+Returns: the address of changed */
+void *change_value(const char *pcKey, void *pvValue, void *pvExtra) {
+    return &changed;
+}
+
+
+/* change_block
+
+Thread function that changes the keys of the current block whose number
+is thread modulo NUM_THREADS: keys whose number is a multiple of 3 are
+removed, keys whose number is 1 more than a multiple of 3 are bound to
+the address of changed, and the others are left alone.
+
+Parameters:
+pvArg: pointer to a struct worker.
+
+Returns: NULL */
+void *change_block(void *pvArg) {
+    struct worker *w;
+    char key[KEY_LEN];
+    int i;
+
+    w = pvArg;
+    for (i = block + w->thread; i < block + BLOCK && i < num_keys;
+         i += NUM_THREADS) {
+        check_key(key, i);
+        if (i % 3 == 0) {
+            w->failed |= SymTableConc_remove(w->oSymTable, key) != 1;
+        }
+        else if (i % 3 == 1) {
+            w->failed |= SymTableConc_update(w->oSymTable, key, change_value,
+                                             NULL) != 0;
+        }
+    }
+    return NULL;
+}
+
+
+/* cached_value
+
+Returns: the value of key number i found by SymTableConc_getCached */
+void *cached_value(SymTableConc_T oSymTable, int i) {
+    char key[KEY_LEN];
+
+    check_key(key, i);
+    return SymTableConc_getCached(oSymTable, key);
+}
+
+
+/* check_cached
+
+Puts every key, then, one block of BLOCK keys at a time, looks the keys
+of the block up twice so that they are cached, lets NUM_THREADS threads
+change them with change_block and checks that the next lookups see the
+changes instead of the cached values.
+
+Returns: the number of failed checks */
+int check_cached(void) {
+    SymTableConc_T oSymTable;
+    struct worker workers[NUM_THREADS];
+    char key[KEY_LEN];
+    int i, t, wrong, failed;
+    void *expected;
+
+    oSymTable = SymTableConc_new();
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        SymTableConc_put(oSymTable, key, &flags[i]);
+    }
+
+    wrong = 0;
+    failed = 0;
+    for (block = 0; block < num_keys; block += BLOCK) {
+        for (i = block; i < block + BLOCK && i < num_keys; i++) {
+            wrong |= cached_value(oSymTable, i) != &flags[i];
+            wrong |= cached_value(oSymTable, i) != &flags[i];
+        }
+        run_threads(oSymTable, change_block, workers);
+        for (t = 0; t < NUM_THREADS; t++) {
+            failed |= workers[t].failed;
+        }
+        for (i = block; i < block + BLOCK && i < num_keys; i++) {
+            expected = i % 3 == 0 ? NULL : i % 3 == 1 ? &changed : &flags[i];
+            wrong |= cached_value(oSymTable, i) != expected;
+        }
+    }
+    SymTableConc_free(oSymTable);
+    failed = report("changes", failed);
+
+    return failed + report("getCached", wrong);
+}
+
+
+/* change_evens
+
+Thread function that binds the keys with an even number whose half is
+thread modulo NUM_THREADS to the address of changed, creating the keys
+that were removed.
+
+Parameters:
+pvArg: pointer to a struct worker.
+
+Returns: NULL */
+void *change_evens(void *pvArg) {
+    struct worker *w;
+    char key[KEY_LEN];
+    int i;
+
+    w = pvArg;
+    for (i = 2 * w->thread; i < num_keys; i += 2 * NUM_THREADS) {
+        check_key(key, i);
+        SymTableConc_update(w->oSymTable, key, change_value, NULL);
+    }
+    return NULL;
+}
+
+
+/* change_during_map
+
+Function used by SymTableConc_mapSnapshot() to count the visited bindings
+while changing the table: it removes the visited key, puts the next key,
+which is not in the snapshot, and every BLOCK bindings lets NUM_THREADS
+threads change the values of all even keys with change_evens.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value.
+pvExtra: pointer to a struct snapshot.
+
+Returns: void */
+void change_during_map(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct snapshot *snap;
+    struct worker workers[NUM_THREADS];
+    char key[KEY_LEN];
+    int i;
+
+    snap = pvExtra;
+    check_count_bind(pcKey, pvValue, &snap->count);
+    i = check_index(pvValue);
+    if (i < 0) {
+        return;
+    }
+    SymTableConc_remove(snap->oSymTable, pcKey);
+    if (i + 1 < num_keys) {
+        check_key(key, i + 1);
+        SymTableConc_put(snap->oSymTable, key, &flags[i + 1]);
+    }
+    if (snap->count % BLOCK == 0) {
+        run_threads(snap->oSymTable, change_evens, workers);
+    }
+    return;
+}
+
+
+/* check_snapshot
+
+Puts the keys with an even number and visits them with
+SymTableConc_mapSnapshot while change_during_map changes the table, and
+checks that exactly the bindings put before the snapshot are visited,
+with their values from before the snapshot.
+
+Returns: the number of failed checks */
+int check_snapshot(void) {
+    struct snapshot snap;
+    char key[KEY_LEN];
+    int i;
+    unsigned int visited;
+
+    snap.oSymTable = SymTableConc_new();
+    for (i = 0; i < num_keys; i++) {
+        flags[i] = i % 2 == 0;
+        if (flags[i]) {
+            check_key(key, i);
+            SymTableConc_put(snap.oSymTable, key, &flags[i]);
+        }
+    }
+
+    snap.count = 0;
+    visited = SymTableConc_mapSnapshot(snap.oSymTable, change_during_map,
+                                       &snap);
+    SymTableConc_free(snap.oSymTable);
+
+    return check_mapped("mapSnapshot",
+                        (int) visited == snap.count ? snap.count : -1);
+}
+
+
+/* compute
+
+Function used by SymTableConc_getOrCompute() to compute the value of a
+key. It counts the computation and yields a few times so that other
+threads miss on the key while it runs.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvExtra: the value of the key, the address of its flag.
+
+Returns: pvExtra */
+void *compute(const char *pcKey, void *pvExtra) {
+    int i;
+
+    __atomic_add_fetch(&computes[(char *) pvExtra - flags], 1,
+                       __ATOMIC_RELAXED);
+    for (i = 0; i < 3; i++) {
+        sched_yield();
+    }
+    return pvExtra;
+}
+
+
+/* get_or_compute
+
+Thread function that gets every key with SymTableConc_getOrCompute, in
+the same order as the other threads, and checks the values.
+
+Parameters:
+pvArg: pointer to a struct worker.
+
+Returns: NULL */
+void *get_or_compute(void *pvArg) {
+    struct worker *w;
+    char key[KEY_LEN];
+    int i;
+
+    w = pvArg;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        w->failed |= SymTableConc_getOrCompute(w->oSymTable, key, compute,
+                                               &flags[i]) != &flags[i];
+    }
+    return NULL;
+}
+
+
+/* check_compute
+
+Gets every key of an empty table from NUM_THREADS threads at once with
+SymTableConc_getOrCompute and checks that the value of each key was
+computed exactly once.
+
+Returns: the number of failed checks */
+int check_compute(void) {
+    SymTableConc_T oSymTable;
+    struct worker workers[NUM_THREADS];
+    int i, t, wrong;
+
+    computes = calloc(num_keys, sizeof(int));
+    if (!computes) {
+        printf("Could not allocate the counts\n");
+        exit(1);
+    }
+    oSymTable = SymTableConc_new();
+    run_threads(oSymTable, get_or_compute, workers);
+
+    wrong = SymTableConc_getLength(oSymTable) != (unsigned int) num_keys;
+    for (t = 0; t < NUM_THREADS; t++) {
+        wrong |= workers[t].failed;
+    }
+    for (i = 0; i < num_keys; i++) {
+        wrong |= computes[i] != 1;
+    }
+    SymTableConc_free(oSymTable);
+    free(computes);
+
+    return report("getOrCompute", wrong);
+}
@@ -0,0 +1,423 @@
+/* Demo of the Symbol table library stored in a file (symtabledisk):
+measures the page reads and writes per operation, or checks random
+operations against the set of keys that should be in the table */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "symtabledisk.h"
+
+#define KEY_LEN 32
+#define NUM_GETS 10000
+
+#define CHECK_PAGES 8       /* buffer pool of a check: the smallest one */
+#define CHECK_OPS 20        /* random operations per key in a check */
+#define CHECK_REOPENS 4     /* times the table is closed and reopened */
+#define RANGE_EVERY 500     /* operations between two range checks */
+#define VALUE_PAD 200       /* longest padding of a value */
+
+/* Struct used by SymTableDisk_range() to check the visited bindings */
+struct arange {
+    const char *low, *high;
+    char last[KEY_LEN];
+    int count;
+    int wrong;
+};
+
+char *flags;            /* flags[i] is 1 if key i is in the table */
+int num_keys;
+
+void count_bind(const char *pcKey, const char *pcValue, void *pvExtra);
+void report(SymTableDisk_T oSymTable, const char *name, int ops,
+            clock_t start, unsigned long *reads, unsigned long *writes);
+int check_result(const char *name, int failed);
+void make_key(char *key, int i);
+void make_value(char *value, int i);
+void check_bind(const char *pcKey, const char *pcValue, void *pvExtra);
+int check_range(SymTableDisk_T oSymTable, const char *low, const char *high);
+int check_all(SymTableDisk_T oSymTable);
+int check_op(SymTableDisk_T oSymTable, int op, int i);
+int check_disk(const char *path);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 4.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: path of the table file
+    3rd argument: number of keys to insert
+    4th argument: number of pages in the buffer pool
+
+    For a check, which replaces the file:
+    2nd argument: -check
+    3rd argument: path of the table file
+    4th argument: number of distinct keys */
+int main(int argc, char **argv) {
+    SymTableDisk_T oSymTable;
+    int i, num_pages, count;
+    unsigned long reads, writes;
+    char key[KEY_LEN], value[KEY_LEN];
+    clock_t start;
+
+    if (argc == 4 && !strcmp(argv[1], "-check")) {
+        num_keys = atoi(argv[3]);
+        if (num_keys <= 0) {
+            printf("NUM_KEYS must be > 0\n");
+            return 1;
+        }
+        return check_disk(argv[2]);
+    }
+    if (argc != 4) {
+        printf("Usage: %s {FILE} {NUM_KEYS} {NUM_PAGES}\n", argv[0]);
+        printf("       %s -check {FILE} {NUM_KEYS}\n", argv[0]);
+        return 1;
+    }
+    num_keys = atoi(argv[2]);
+    num_pages = atoi(argv[3]);
+    if (num_keys <= 0 || num_pages < 8) {
+        printf("NUM_KEYS must be > 0 and NUM_PAGES >= 8\n");
+        return 1;
+    }
+    oSymTable = SymTableDisk_open(argv[1], num_pages);
+    if (!oSymTable) {
+        printf("%s is not a table file\n", argv[1]);
+        return 1;
+    }
+    srand(1);
+    reads = writes = 0;
+
+    printf("++> Table has %u bindings\n", SymTableDisk_getLength(oSymTable));
+    start = clock();
+    for (i = 0; i < num_keys; i++) {
+        sprintf(key, "key%010d", rand());
+        sprintf(value, "%d", i);
+        if (SymTableDisk_put(oSymTable, key, value) < 0) {
+            printf("Could not read or write %s\n", argv[1]);
+            SymTableDisk_close(oSymTable);
+            return 1;
+        }
+    }
+    report(oSymTable, "put", num_keys, start, &reads, &writes);
+
+    start = clock();
+    for (i = 0; i < NUM_GETS; i++) {
+        sprintf(key, "key%010d", rand());
+        SymTableDisk_get(oSymTable, key);
+    }
+    report(oSymTable, "get", NUM_GETS, start, &reads, &writes);
+
+    start = clock();
+    count = 0;
+    SymTableDisk_map(oSymTable, count_bind, &count);
+    report(oSymTable, "scan", count, start, &reads, &writes);
+
+    printf("++> Table has %u bindings\n", SymTableDisk_getLength(oSymTable));
+    if (!SymTableDisk_close(oSymTable)) {
+        printf("Could not read or write %s\n", argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/* count_bind
+
+Function used by SymTableDisk_map() to count the bindings.
+
+Parameters:
+pcKey: ignored.
+pcValue: ignored.
+pvExtra: pointer to an integer counter.
+
+Returns: void */
+void count_bind(const char *pcKey, const char *pcValue, void *pvExtra) {
+    (*(int *) pvExtra)++;
+    return;
+}
+
+
+/* report
+
+Prints the CPU time and the page reads and writes per operation since the
+previous report.
+
+Parameters:
+oSymTable: a SymTableDisk_T type.
+name: name of the operation.
+ops: number of operations.
+start: CPU time at the start of the operations.
+reads: page reads at the previous report. Updated.
+writes: page writes at the previous report. Updated.
+
+Returns: void */
+void report(SymTableDisk_T oSymTable, const char *name, int ops,
+            clock_t start, unsigned long *reads, unsigned long *writes) {
+    unsigned long new_reads, new_writes;
+
+    SymTableDisk_getIO(oSymTable, &new_reads, &new_writes);
+    if (ops) {
+        printf("++> %-4s %8d ops, %.2f us/op, %.2f page reads/op, %.2f page writes/op\n",
+               name, ops, ((double) (clock() - start)) / CLOCKS_PER_SEC * 1e6 / ops,
+               (double) (new_reads - *reads) / ops,
+               (double) (new_writes - *writes) / ops);
+    }
+    *reads = new_reads;
+    *writes = new_writes;
+    return;
+}
+
+
+/* check_result
+
+Prints the result of a check.
+
+Parameters:
+name: name of the check.
+failed: 1 if the check failed, 0 otherwise.
+
+Returns: failed */
+int check_result(const char *name, int failed) {
+    printf("++> %-16s %s\n", name, failed ? "FAILED" : "ok");
+    return failed;
+}
+
+
+/* make_key
+
+Writes key number i to key. Keys of different lengths are used.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void make_key(char *key, int i) {
+    sprintf(key, "k%d%.*s", i, i % 11, "abcdefghijk");
+    return;
+}
+
+
+/* make_value
+
+Writes the value of key number i to value: the number of the key padded
+to a length that depends on i, so that pages hold different numbers of
+entries.
+
+Parameters:
+value: array of at least VALUE_PAD + KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void make_value(char *value, int i) {
+    sprintf(value, "%d:%0*d", i, i % VALUE_PAD, 0);
+    return;
+}
+
+
+/* check_bind
+
+Function used by SymTableDisk_range() to check a visited binding: it must
+be in the table, within the bounds of the range, after the previous
+binding and have the value of its key.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pcValue: pointer to a character array (value).
+pvExtra: pointer to a struct arange.
+
+Returns: void */
+void check_bind(const char *pcKey, const char *pcValue, void *pvExtra) {
+    struct arange *range;
+    char key[KEY_LEN], value[VALUE_PAD + KEY_LEN];
+    int i;
+
+    range = pvExtra;
+    range->count++;
+    i = atoi(pcKey + 1);
+    make_key(key, i);
+    make_value(value, i);
+    range->wrong |= i < 0 || i >= num_keys || !flags[i]
+                    || strcmp(key, pcKey) || strcmp(value, pcValue);
+    range->wrong |= (range->low && strcmp(pcKey, range->low) < 0)
+                    || (range->high && strcmp(pcKey, range->high) >= 0);
+    range->wrong |= range->last[0] && strcmp(range->last, pcKey) >= 0;
+    strcpy(range->last, pcKey);
+    return;
+}
+
+
+/* check_range
+
+Visits the bindings of oSymTable between low and high and checks that
+exactly the keys in the table within these bounds are visited, in order.
+
+Parameters:
+oSymTable: a SymTableDisk_T type.
+low: a key or NULL for no lower bound.
+high: a key or NULL for no upper bound.
+
+Returns: 1 if the range is wrong, 0 otherwise */
+int check_range(SymTableDisk_T oSymTable, const char *low, const char *high) {
+    struct arange range;
+    char key[KEY_LEN];
+    int i, expected;
+    unsigned int visited;
+
+    expected = 0;
+    for (i = 0; i < num_keys; i++) {
+        make_key(key, i);
+        expected += flags[i] && (!low || strcmp(key, low) >= 0)
+                    && (!high || strcmp(key, high) < 0);
+    }
+    range.low = low;
+    range.high = high;
+    range.last[0] = '\0';
+    range.count = 0;
+    range.wrong = 0;
+    visited = SymTableDisk_range(oSymTable, low, high, check_bind, &range);
+
+    return range.wrong || range.count != expected
+           || (int) visited != expected;
+}
+
+
+/* check_all
+
+Checks the length of oSymTable, that every key is found if and only if it
+is in the table, and that a map visits exactly the keys in the table, in
+order.
+
+Parameters:
+oSymTable: a SymTableDisk_T type.
+
+Returns: 1 if the table is wrong, 0 otherwise */
+int check_all(SymTableDisk_T oSymTable) {
+    struct arange range;
+    char key[KEY_LEN];
+    int i, wrong, length;
+
+    wrong = 0;
+    length = 0;
+    for (i = 0; i < num_keys; i++) {
+        make_key(key, i);
+        wrong |= SymTableDisk_contains(oSymTable, key) != flags[i];
+        length += flags[i];
+    }
+    wrong |= (int) SymTableDisk_getLength(oSymTable) != length;
+
+    range.low = range.high = NULL;
+    range.last[0] = '\0';
+    range.count = 0;
+    range.wrong = 0;
+    SymTableDisk_map(oSymTable, check_bind, &range);
+
+    return wrong || range.wrong || range.count != length;
+}
+
+
+/* check_op
+
+Runs one operation on key number i and compares its result with the
+flags, which it updates.
+
+Parameters:
+oSymTable: a SymTableDisk_T type.
+op: 0 for put, 1 for remove, 2 for get, 3 for contains.
+i: number of the key.
+
+Returns: 1 if the result is wrong, 0 otherwise */
+int check_op(SymTableDisk_T oSymTable, int op, int i) {
+    char key[KEY_LEN], value[VALUE_PAD + KEY_LEN];
+    const char *found;
+    int failed;
+
+    make_key(key, i);
+    make_value(value, i);
+    switch (op) {
+    case 0:
+        failed = SymTableDisk_put(oSymTable, key, value) != !flags[i];
+        flags[i] = 1;
+        break;
+    case 1:
+        failed = SymTableDisk_remove(oSymTable, key) != flags[i];
+        flags[i] = 0;
+        break;
+    case 2:
+        found = SymTableDisk_get(oSymTable, key);
+        failed = flags[i] ? !found || strcmp(found, value) : found != NULL;
+        break;
+    default:
+        failed = SymTableDisk_contains(oSymTable, key) != flags[i];
+    }
+
+    return failed;
+}
+
+
+/* check_disk
+
+Runs CHECK_OPS random operations per key on a new table in path with a
+buffer pool of CHECK_PAGES pages, and compares their results with the
+flags. Ranges between random bounds are checked every RANGE_EVERY
+operations, and the table is closed, reopened and checked CHECK_REOPENS
+times. The file is removed at the end.
+
+Parameters:
+path: path of the table file.
+
+Returns: 0 if all checks passed, 1 otherwise */
+int check_disk(const char *path) {
+    SymTableDisk_T oSymTable;
+    char low[KEY_LEN], high[KEY_LEN];
+    int op, num_ops, ops, ranges, reopens, failed;
+
+    flags = calloc(num_keys, 1);
+    assert(flags);
+    remove(path);
+    oSymTable = SymTableDisk_open(path, CHECK_PAGES);
+    if (!oSymTable) {
+        printf("Could not create %s\n", path);
+        free(flags);
+        return 1;
+    }
+    srand(1);
+
+    ops = ranges = reopens = 0;
+    num_ops = CHECK_OPS * num_keys;
+    for (op = 1; op <= num_ops; op++) {
+        ops |= check_op(oSymTable, rand() % 4, rand() % num_keys);
+        if (op % RANGE_EVERY == 0) {
+            make_key(low, rand() % num_keys);
+            make_key(high, rand() % num_keys);
+            ranges |= check_range(oSymTable, low, high);
+            ranges |= check_range(oSymTable, NULL, high);
+            ranges |= check_range(oSymTable, low, NULL);
+            ranges |= check_range(oSymTable, low, low);
+        }
+        if (op % (num_ops / CHECK_REOPENS) == 0) {
+            reopens |= !SymTableDisk_close(oSymTable);
+            oSymTable = SymTableDisk_open(path, CHECK_PAGES);
+            if (!oSymTable) {
+                printf("Could not reopen %s\n", path);
+                free(flags);
+                return 1;
+            }
+            reopens |= check_all(oSymTable);
+        }
+    }
+
+    failed = check_result("operations", ops);
+    failed += check_result("ranges", ranges);
+    failed += check_result("reopens", reopens);
+    failed += check_result("close", !SymTableDisk_close(oSymTable));
+    remove(path);
+    free(flags);
+    printf("++> %d checks failed\n", failed);
+
+    return failed != 0;
+}
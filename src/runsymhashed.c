@@ -0,0 +1,66 @@
+/* Check of the hashed key Symbol table library (symtablehashed): runs
+random operations on a table and compares every result with an array of
+flags. The keys share long prefixes and suffixes, so keys that differ in
+a single character must still be told apart by their hashes. */
+
+#include <stdio.h>
+#include "symtablehashed.h"
+#include "runsymcheck.h"
+
+void make_key(char *key, int i);
+
+/* Operations of a hashed key table */
+const struct checkops hashed_ops = {
+    SymTableHashed_put, SymTableHashed_remove, SymTableHashed_get,
+    SymTableHashed_contains, SymTableHashed_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    SymTableHashed_T oSymTable;
+    int failed, count;
+
+    if (!check_start(argc, argv, make_key)) {
+        return 1;
+    }
+
+    oSymTable = SymTableHashed_new();
+    failed = report("operations", check_ops(&hashed_ops, oSymTable));
+    count = 0;
+    SymTableHashed_map(oSymTable, check_count_value, &count);
+    failed += check_mapped("map", count);
+    SymTableHashed_free(oSymTable);
+
+    return check_finish(failed);
+}
+
+
+/* make_key
+
+Writes key number i to key. Half of the keys are the number between a
+long common prefix and suffix, the other half the number alone, so many
+keys differ in one character.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void make_key(char *key, int i) {
+    if (i % 2) {
+        sprintf(key, "%d", i / 2);
+    }
+    else {
+        sprintf(key, "a/long/common/prefix/%d/and/a/common/suffix", i / 2);
+    }
+    return;
+}
@@ -0,0 +1,139 @@
+/* Check of the write-optimized Symbol table library (symtablelsm): runs
+random operations on a table and compares every result with an array of
+flags. There are enough distinct keys to fill many memtables, so the
+operations run while the background thread merges runs of several
+levels. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symtablelsm.h"
+#include "runsymcheck.h"
+
+#define NUM_MAPS 4      /* maps checked during the operations */
+
+/* Struct given to check_order by SymTableLsm_map */
+struct order {
+    char last[KEY_LEN]; /* last visited key */
+    int wrong;
+    int count;          /* counter of check_count_bind */
+};
+
+int lsm_put(void *pvTable, const char *pcKey, const void *pvValue);
+int lsm_remove(void *pvTable, const char *pcKey);
+void check_order(const char *pcKey, void *pvValue, void *pvExtra);
+int check_map(SymTableLsm_T oSymTable);
+
+/* Operations of a write-optimized table, which has no length */
+const struct checkops lsm_ops = {
+    lsm_put, lsm_remove, SymTableLsm_get, SymTableLsm_contains, NULL
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    SymTableLsm_T oSymTable;
+    int op, num_ops, failed, wrong;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    oSymTable = SymTableLsm_new();
+    wrong = 0;
+    failed = 0;
+    num_ops = NUM_OPS * num_keys;
+    for (op = 1; op <= num_ops; op++) {
+        wrong |= check_op(&lsm_ops, oSymTable, rand() % 4, rand() % num_keys);
+        if (op % (num_ops / NUM_MAPS) == 0) {
+            failed += check_map(oSymTable);
+        }
+    }
+    failed += report("operations", wrong);
+    SymTableLsm_free(oSymTable);
+
+    return check_finish(failed);
+}
+
+
+/* lsm_put
+
+Puts pcKey in pvTable, like SymTable_put.
+
+Returns: 1 if pcKey was not in pvTable, 0 otherwise */
+int lsm_put(void *pvTable, const char *pcKey, const void *pvValue) {
+    int found;
+
+    found = SymTableLsm_contains(pvTable, pcKey);
+    SymTableLsm_put(pvTable, pcKey, pvValue);
+    return !found;
+}
+
+
+/* lsm_remove
+
+Removes pcKey from pvTable, like SymTable_remove.
+
+Returns: 1 if pcKey was in pvTable, 0 otherwise */
+int lsm_remove(void *pvTable, const char *pcKey) {
+    int found;
+
+    found = SymTableLsm_contains(pvTable, pcKey);
+    SymTableLsm_remove(pvTable, pcKey);
+    return found;
+}
+
+
+/* check_order
+
+Function used by SymTableLsm_map() to check that the keys are visited in
+order and to count the bindings with check_count_bind.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value.
+pvExtra: pointer to a struct order.
+
+Returns: void */
+void check_order(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct order *order;
+
+    order = pvExtra;
+    order->wrong |= order->last[0] && strcmp(order->last, pcKey) >= 0;
+    strcpy(order->last, pcKey);
+    check_count_bind(pcKey, pvValue, &order->count);
+    return;
+}
+
+
+/* check_map
+
+Checks that a map of oSymTable visits exactly the keys whose flags are
+set, in order, and returns their number.
+
+Parameters:
+oSymTable: a SymTableLsm_T type.
+
+Returns: 1 if the check failed, 0 otherwise */
+int check_map(SymTableLsm_T oSymTable) {
+    struct order order;
+    unsigned int mapped;
+
+    order.last[0] = '\0';
+    order.wrong = 0;
+    order.count = 0;
+    mapped = SymTableLsm_map(oSymTable, check_order, &order);
+    if (order.wrong || (int) mapped != order.count) {
+        order.count = -1;
+    }
+
+    return check_mapped("map", order.count);
+}
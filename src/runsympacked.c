@@ -0,0 +1,81 @@
+/* Check of the packed key Symbol table library (symtablepacked): runs
+random operations on a table with packed, long and unpackable keys and
+compares every result with an array of flags */
+
+#include <stdio.h>
+#include <assert.h>
+#include "symtablepacked.h"
+#include "runsymcheck.h"
+
+#define ALPHABET "0123456789abcdef"
+
+int packed_len;         /* maximum length of a packed key */
+
+void make_key(char *key, int i);
+
+/* Operations of a packed key table */
+const struct checkops packed_ops = {
+    SymTablePacked_put, SymTablePacked_remove, SymTablePacked_get,
+    SymTablePacked_contains, SymTablePacked_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    SymTablePacked_T oSymTable;
+    int failed, count;
+
+    if (!check_start(argc, argv, make_key)) {
+        return 1;
+    }
+
+    oSymTable = SymTablePacked_new(ALPHABET);
+    packed_len = SymTablePacked_getPackedLength(oSymTable);
+    printf("++> keys of up to %d characters are packed\n", packed_len);
+    assert(packed_len + 3 < KEY_LEN);
+    failed = report("operations", check_ops(&packed_ops, oSymTable));
+    count = 0;
+    SymTablePacked_map(oSymTable, check_count_bind, &count);
+    failed += check_mapped("map", count);
+    SymTablePacked_free(oSymTable);
+
+    return check_finish(failed);
+}
+
+
+/* make_key
+
+Writes key number i to key. A quarter of the keys are short keys of the
+alphabet, a quarter have exactly packed_len characters of the alphabet, a
+quarter are longer than that and a quarter have a character that is not
+in the alphabet. Only the first two kinds are packed.
+
+Parameters:
+key: array of at least KEY_LEN characters.
+i: number of the key.
+
+Returns: void */
+void make_key(char *key, int i) {
+    switch (i % 4) {
+    case 0:
+        sprintf(key, "%x", i / 4);
+        break;
+    case 1:
+        sprintf(key, "%0*x", packed_len, i / 4);
+        break;
+    case 2:
+        sprintf(key, "%0*x", packed_len + 1 + i / 4 % 3, i / 4);
+        break;
+    default:
+        sprintf(key, "%xg", i / 4);
+    }
+    return;
+}
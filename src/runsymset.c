@@ -0,0 +1,99 @@
+/* Check of the Symbol set library (symset): runs random operations on a
+set and compares every result with an array of flags, then checks the
+xor filter made from the set */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "symset.h"
+#include "runsymcheck.h"
+
+#define MAX_FALSE 0.01  /* largest accepted false positive rate */
+
+int put_key(void *pvTable, const char *pcKey, const void *pvValue);
+int check_filter(SymSet_T oSymSet);
+
+/* Operations of a set, which has no values */
+const struct checkops set_ops = {
+    put_key, SymSet_remove, NULL, SymSet_contains, SymSet_getLength
+};
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    SymSet_T oSymSet;
+    int failed, count;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    oSymSet = SymSet_new();
+    failed = report("operations", check_ops(&set_ops, oSymSet));
+    count = 0;
+    SymSet_map(oSymSet, check_count_key, &count);
+    failed += check_mapped("map", count);
+    failed += check_filter(oSymSet);
+    SymSet_free(oSymSet);
+
+    return check_finish(failed);
+}
+
+
+/* put_key
+
+SymSet_put() with the arguments of checkops, which ignores pvValue.
+
+Returns: the result of SymSet_put() */
+int put_key(void *pvTable, const char *pcKey, const void *pvValue) {
+    return SymSet_put(pvTable, pcKey);
+}
+
+
+/* check_filter
+
+Freezes oSymSet and checks that the filter finds every key of the set and
+few of the other keys.
+
+Parameters:
+oSymSet: a SymSet_T type.
+
+Returns: the number of failed checks */
+int check_filter(SymSet_T oSymSet) {
+    SymSetFilter_T oFilter;
+    char key[KEY_LEN];
+    int i, missed, false_hits, others, failed;
+
+    oFilter = SymSet_freeze(oSymSet);
+    missed = false_hits = others = 0;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        if (flags[i]) {
+            missed += !SymSetFilter_contains(oFilter, key);
+        }
+        else {
+            others++;
+            false_hits += SymSetFilter_contains(oFilter, key);
+        }
+    }
+    for (i = num_keys; i < 2 * num_keys; i++) {
+        check_key(key, i);
+        others++;
+        false_hits += SymSetFilter_contains(oFilter, key);
+    }
+    printf("++> filter: %lu bytes, %d of %d other keys found\n",
+           (unsigned long) SymSetFilter_getBytes(oFilter), false_hits, others);
+    SymSetFilter_free(oFilter);
+
+    failed = report("filter members", missed != 0);
+    failed += report("filter others", false_hits > MAX_FALSE * others + 10);
+
+    return failed;
+}
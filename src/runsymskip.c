@@ -0,0 +1,202 @@
+/* Scaling benchmark for the lock-free Symbol table library (symtableskip)
+and the striped Symbol table library (symtableconc) */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include "symtableskip.h"
+#include "symtableconc.h"
+
+#define KEY_LEN 16
+
+/* Struct that holds the arguments of a benchmark thread */
+struct worker {
+    void *table;
+    int skip;           /* 1 for SymTableSkip_T, 0 for SymTableConc_T */
+    unsigned int seed;
+};
+
+char **keys;            /* shared keys "k0", "k1", ... */
+int num_keys;
+int num_ops;            /* operations per thread */
+int read_percent;       /* percentage of gets, the rest are puts/removes */
+
+double now(void);
+void *run_worker(void *arg);
+double run(int skip, int num_threads);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 5.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: maximum number of threads
+    3rd argument: number of distinct keys
+    4th argument: number of operations per thread
+    5th argument: percentage of gets */
+int main(int argc, char **argv) {
+    int i, max_threads, num_threads;
+    double skip_ops, conc_ops;
+
+    if (argc != 5) {
+        printf("Usage: %s {MAX_THREADS} {NUM_KEYS} {NUM_OPS} {READ_PERCENT}\n", argv[0]);
+        return 1;
+    }
+    max_threads = atoi(argv[1]);
+    num_keys = atoi(argv[2]);
+    num_ops = atoi(argv[3]);
+    read_percent = atoi(argv[4]);
+    if (max_threads <= 0 || num_keys <= 0 || num_ops <= 0 ||
+        read_percent < 0 || read_percent > 100) {
+        printf("MAX_THREADS, NUM_KEYS and NUM_OPS must be > 0, READ_PERCENT 0-100\n");
+        return 1;
+    }
+
+    keys = malloc(num_keys * sizeof(char *));
+    assert(keys);
+    for (i = 0; i < num_keys; i++) {
+        keys[i] = malloc(KEY_LEN);
+        assert(keys[i]);
+        sprintf(keys[i], "k%d", i);
+    }
+
+    printf("threads,skip_mops,conc_mops\n");
+    for (num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        skip_ops = run(1, num_threads);
+        conc_ops = run(0, num_threads);
+        printf("%d,%.2f,%.2f\n", num_threads, skip_ops / 1e6, conc_ops / 1e6);
+        fflush(stdout);
+    }
+
+    for (i = 0; i < num_keys; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+
+    return 0;
+}
+
+
+/* now
+
+Returns: the time in seconds from a monotonic clock. */
+double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* run_worker
+
+Performs num_ops random operations on the table of a worker: gets with
+probability read_percent, otherwise puts and removes with equal
+probability.
+
+Parameters:
+arg: a pointer to a worker struct.
+
+Returns: NULL */
+void *run_worker(void *arg) {
+    struct worker *worker;
+    unsigned int x;
+    char *key;
+    int i;
+
+    worker = arg;
+    x = worker->seed;
+    for (i = 0; i < num_ops; i++) {
+        x = x * 1103515245U + 12345U;
+        key = keys[(x >> 8) % num_keys];
+        if ((int) ((x >> 4) % 100) < read_percent) {
+            if (worker->skip) {
+                SymTableSkip_get(worker->table, key);
+            }
+            else {
+                SymTableConc_get(worker->table, key);
+            }
+        }
+        else if (x & 0x10000) {
+            if (worker->skip) {
+                SymTableSkip_put(worker->table, key, key);
+            }
+            else {
+                SymTableConc_put(worker->table, key, key);
+            }
+        }
+        else {
+            if (worker->skip) {
+                SymTableSkip_remove(worker->table, key);
+            }
+            else {
+                SymTableConc_remove(worker->table, key);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/* run
+
+Creates a table with half of the keys and runs num_threads workers on it.
+
+Parameters:
+skip: 1 for a SymTableSkip_T table, 0 for a SymTableConc_T table.
+num_threads: number of threads.
+
+Returns: the number of operations per second of all threads. */
+double run(int skip, int num_threads) {
+    pthread_t *threads;
+    struct worker *workers;
+    void *table;
+    double start, end;
+    int i, error;
+
+    table = skip ? SymTableSkip_new() : SymTableConc_new();
+    for (i = 0; i < num_keys; i += 2) {
+        if (skip) {
+            SymTableSkip_put(table, keys[i], keys[i]);
+        }
+        else {
+            SymTableConc_put(table, keys[i], keys[i]);
+        }
+    }
+
+    threads = malloc(num_threads * sizeof(pthread_t));
+    workers = malloc(num_threads * sizeof(struct worker));
+    assert(threads && workers);
+    start = now();
+    for (i = 0; i < num_threads; i++) {
+        workers[i].table = table;
+        workers[i].skip = skip;
+        workers[i].seed = 2 * i + 1;
+        error = pthread_create(&threads[i], NULL, run_worker, &workers[i]);
+        assert(!error);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    end = now();
+
+    if (skip) {
+        SymTableSkip_free(table);
+    }
+    else {
+        SymTableConc_free(table);
+    }
+    free(threads);
+    free(workers);
+
+    return (double) num_threads * num_ops / (end - start);
+}
@@ -0,0 +1,378 @@
+/* Check of the lock-free ordered Symbol table library (symtableskip): runs
+the same random operations on a skip list and on a SymTable and compares
+their results, including ranges with random bounds, first from one thread
+and then from several threads that each own a part of the keys */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "symtableskip.h"
+#include "runsymcheck.h"
+
+#define NUM_THREADS 4   /* threads that use the skip list at once */
+#define NUM_ROUNDS 3    /* rounds of new threads on the same skip list */
+#define RANGE_EVERY 1000    /* operations between two range checks */
+
+/* Struct given to a thread. Thread t owns the keys whose number is t
+modulo NUM_THREADS, and ref holds its keys only; owner is -1 for the
+only thread, which owns all keys. */
+struct worker {
+    SymTableSkip_T oSkip;
+    SymTable_T ref;
+    int owner;
+    unsigned int seed;
+    char *expected;     /* expected[i] is 1 if a range must visit key i */
+    int failed;
+};
+
+/* Struct given to the functions applied by a range check */
+struct range {
+    struct worker *w;
+    const char *low, *high;
+    char last[KEY_LEN]; /* last visited key */
+    int count;          /* expected bindings not visited yet */
+    int visited;
+    int wrong;
+};
+
+int key_number(const void *pvValue);
+int owns(struct worker *w, int i);
+int in_range(struct range *range, const char *pcKey);
+const char *random_bound(struct worker *w, char *key);
+void expect(const char *pcKey, void *pvValue, void *pvExtra);
+void visit(const char *pcKey, void *pvValue, void *pvExtra);
+int check_range(struct worker *w, const char *low, const char *high,
+                int map);
+void *run_ops(void *pvArg);
+int check_single(void);
+int check_threads(void);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: number of distinct keys
+
+Returns: 0 if all checks passed, 1 otherwise */
+int main(int argc, char **argv) {
+    int failed;
+
+    if (!check_start(argc, argv, NULL)) {
+        return 1;
+    }
+
+    failed = check_single();
+    failed += check_threads();
+
+    return check_finish(failed);
+}
+
+
+/* key_number
+
+Returns: the number of the key whose value is pvValue. The value of key
+i is the address of flags[i], which are not used otherwise. */
+int key_number(const void *pvValue) {
+    return (int) ((const char *) pvValue - flags);
+}
+
+
+/* owns
+
+Returns: 1 if the thread of w owns key number i, 0 otherwise */
+int owns(struct worker *w, int i) {
+    return w->owner < 0 || i % NUM_THREADS == w->owner;
+}
+
+
+/* in_range
+
+Returns: 1 if pcKey is >= the low bound and < the high bound of range,
+0 otherwise */
+int in_range(struct range *range, const char *pcKey) {
+    return (!range->low || strcmp(pcKey, range->low) >= 0)
+           && (!range->high || strcmp(pcKey, range->high) < 0);
+}
+
+
+/* random_bound
+
+Writes a random key, which may or may not be in the tables, to key.
+
+Parameters:
+w: the thread, whose seed is used.
+key: array of at least KEY_LEN characters.
+
+Returns: key, or NULL for no bound one time in 8 */
+const char *random_bound(struct worker *w, char *key) {
+    if (rand_r(&w->seed) % 8 == 0) {
+        return NULL;
+    }
+    check_key(key, rand_r(&w->seed) % num_keys);
+    return key;
+}
+
+
+/* expect
+
+Function used by SymTable_map() to mark the keys of the reference table
+that the range must visit.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value.
+pvExtra: pointer to a struct range.
+
+Returns: void */
+void expect(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct range *range;
+
+    range = pvExtra;
+    if (in_range(range, pcKey)) {
+        range->w->expected[key_number(pvValue)] = 1;
+        range->count++;
+    }
+    return;
+}
+
+
+/* visit
+
+Function used by SymTableSkip_range() to check a visited binding: it must
+be within the bounds and after the previous key, and a key of the thread
+must be expected and not visited before.
+
+Parameters:
+pcKey: pointer to a character array (key).
+pvValue: pointer to the value.
+pvExtra: pointer to a struct range.
+
+Returns: void */
+void visit(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct range *range;
+    int i;
+
+    range = pvExtra;
+    i = key_number(pvValue);
+    range->visited++;
+    range->wrong |= !in_range(range, pcKey);
+    range->wrong |= range->last[0] && strcmp(range->last, pcKey) >= 0;
+    strcpy(range->last, pcKey);
+    if (owns(range->w, i)) {
+        range->wrong |= !range->w->expected[i];
+        range->w->expected[i] = 0;
+        range->count--;
+    }
+    return;
+}
+
+
+/* check_range
+
+Visits the bindings of the skip list between low and high and compares
+the visited keys of the thread with the keys of its reference table
+within the same bounds.
+
+Parameters:
+w: the thread.
+low: a key or NULL for no lower bound.
+high: a key or NULL for no upper bound.
+map: 1 to visit all bindings with SymTableSkip_map, low and high being
+NULL, 0 to use SymTableSkip_range.
+
+Returns: 1 if the range is wrong, 0 otherwise */
+int check_range(struct worker *w, const char *low, const char *high,
+                int map) {
+    struct range range;
+    unsigned int visited;
+
+    range.w = w;
+    range.low = low;
+    range.high = high;
+    range.last[0] = '\0';
+    range.count = 0;
+    range.visited = 0;
+    range.wrong = 0;
+    SymTable_map(w->ref, expect, &range);
+    if (map) {
+        SymTableSkip_map(w->oSkip, visit, &range);
+    }
+    else {
+        visited = SymTableSkip_range(w->oSkip, low, high, visit, &range);
+        range.wrong |= (int) visited != range.visited;
+    }
+    if (range.count) {
+        memset(w->expected, 0, num_keys);
+    }
+
+    return range.wrong || range.count != 0;
+}
+
+
+/* run_ops
+
+Thread function that runs NUM_OPS random operations per key of the
+thread on the skip list and on the reference table, and compares their
+results. A range is checked every RANGE_EVERY operations, and the lengths
+after every operation when the thread owns all keys.
+
+Parameters:
+pvArg: pointer to a struct worker.
+
+Returns: NULL */
+void *run_ops(void *pvArg) {
+    struct worker *w;
+    char key[KEY_LEN], low[KEY_LEN], high[KEY_LEN];
+    const char *pcLow;
+    int op, i, num_ops;
+    void *value;
+
+    w = pvArg;
+    num_ops = w->owner < 0 ? NUM_OPS * num_keys
+                           : NUM_OPS * num_keys / NUM_THREADS;
+    for (op = 0; op < num_ops; op++) {
+        i = rand_r(&w->seed) % num_keys;
+        if (!owns(w, i)) {
+            i = i - i % NUM_THREADS + w->owner;
+            if (i >= num_keys) {
+                continue;
+            }
+        }
+        check_key(key, i);
+        value = &flags[i];
+        switch (rand_r(&w->seed) % 4) {
+        case 0:
+            w->failed |= SymTableSkip_put(w->oSkip, key, value)
+                         != SymTable_put(w->ref, key, value);
+            break;
+        case 1:
+            w->failed |= SymTableSkip_remove(w->oSkip, key)
+                         != SymTable_remove(w->ref, key);
+            break;
+        case 2:
+            w->failed |= SymTableSkip_get(w->oSkip, key)
+                         != SymTable_get(w->ref, key);
+            break;
+        default:
+            w->failed |= SymTableSkip_contains(w->oSkip, key)
+                         != SymTable_contains(w->ref, key);
+        }
+        if (w->owner < 0) {
+            w->failed |= SymTableSkip_getLength(w->oSkip)
+                         != SymTable_getLength(w->ref);
+        }
+        if (op % RANGE_EVERY == 0) {
+
+            /* the bounds are sometimes equal, so the range is empty */
+            pcLow = random_bound(w, low);
+            w->failed |= check_range(w, pcLow, rand_r(&w->seed) % 16 ?
+                                     random_bound(w, high) : pcLow, 0);
+        }
+    }
+    return NULL;
+}
+
+
+/* check_single
+
+Runs random operations and ranges from one thread.
+
+Returns: the number of failed checks */
+int check_single(void) {
+    struct worker w;
+
+    w.oSkip = SymTableSkip_new();
+    w.ref = SymTable_new();
+    w.owner = -1;
+    w.seed = 1;
+    w.expected = calloc(num_keys, 1);
+    w.failed = 0;
+    if (!w.expected) {
+        printf("Could not allocate the expected keys\n");
+        exit(1);
+    }
+
+    run_ops(&w);
+    w.failed = report("operations", w.failed);
+    w.failed += report("map", check_range(&w, NULL, NULL, 1));
+
+    SymTableSkip_free(w.oSkip);
+    SymTable_free(w.ref);
+    free(w.expected);
+
+    return w.failed;
+}
+
+
+/* check_threads
+
+Runs NUM_ROUNDS rounds of NUM_THREADS threads on the same skip list,
+each with the reference table of its keys, then compares the skip list
+with the reference tables.
+
+Returns: the number of failed checks */
+int check_threads(void) {
+    SymTableSkip_T oSkip;
+    pthread_t threads[NUM_THREADS];
+    struct worker workers[NUM_THREADS];
+    char key[KEY_LEN];
+    int i, t, round, failed, wrong;
+    unsigned int length;
+
+    printf("++> ----------Threads----------\n");
+    oSkip = SymTableSkip_new();
+    for (t = 0; t < NUM_THREADS; t++) {
+        workers[t].oSkip = oSkip;
+        workers[t].ref = SymTable_new();
+        workers[t].owner = t;
+        workers[t].seed = 2 * t + 1;
+        workers[t].expected = calloc(num_keys, 1);
+        workers[t].failed = 0;
+        if (!workers[t].expected) {
+            printf("Could not allocate the expected keys\n");
+            exit(1);
+        }
+    }
+
+    for (round = 0; round < NUM_ROUNDS; round++) {
+        for (t = 0; t < NUM_THREADS; t++) {
+            if (pthread_create(&threads[t], NULL, run_ops, &workers[t])) {
+                printf("Could not create thread %d\n", t);
+                exit(1);
+            }
+        }
+        for (t = 0; t < NUM_THREADS; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    failed = 0;
+    for (t = 0; t < NUM_THREADS; t++) {
+        failed |= workers[t].failed;
+    }
+    failed = report("operations", failed);
+
+    wrong = 0;
+    length = 0;
+    for (i = 0; i < num_keys; i++) {
+        check_key(key, i);
+        wrong |= SymTableSkip_get(oSkip, key)
+                 != SymTable_get(workers[i % NUM_THREADS].ref, key);
+    }
+    for (t = 0; t < NUM_THREADS; t++) {
+        length += SymTable_getLength(workers[t].ref);
+        SymTable_free(workers[t].ref);
+        free(workers[t].expected);
+    }
+    wrong |= SymTableSkip_getLength(oSkip) != length;
+    failed += report("contents", wrong);
+    SymTableSkip_free(oSkip);
+
+    return failed;
+}
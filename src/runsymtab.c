@@ -1,33 +1,89 @@
 /* Test file for the Symbol table library */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <unistd.h>
 #include <time.h>
+
+#ifdef SYMTABLE_SINGLE_HEADER
+#define SYMTABLE_IMPLEMENTATION
+#include "symtablelist.h"
+#else
 #include "symtable.h"
+#endif
+#include "symhll.h"
 
 #define NTABLES 1   /* number of tables to create */
 #define DEBUG 0     /* 1 or 0: print intermediate results or not */
+#define SORTED 0    /* 1 or 0: create sorted tables or not */
+
+#define SWEEP_OPS 10000         /* timed operations per sweep point */
+#define SWEEP_TIME_LIMIT 10.0   /* seconds: larger sizes are skipped */
+
+#define COLD_OPS 500            /* timed operations per cold-cache test */
+#define COLD_BUFFER (64 << 20)  /* bytes touched to evict the caches */
+
+#define MISS_MIN_SIZE 200       /* smallest table with a checked miss average */
 
 void print_bind(const char *pcKey, void *pvValue, void *pvExtra);
 void update_bind(const char *pcKey, void *pvValue, void *pvExtra);
+void update_binds(const char **ppcKeys, void **ppvValues, unsigned int uiCount,
+                  void *pvExtra);
 char** random_keys(char *alphabet, int num_keys, int max_key_len);
 void random_actions(SymTable_T oSymTable, char **keys, int num_keys, int* values);
+SymTable_T new_table(void);
+void free_keys(char **keys, int num_keys);
+double ns_per_op(clock_t start, clock_t end, long ops);
+int sweep_point(int size, int max_key_len, char *alphabet);
+void sweep(int max_size, char *alphabet);
+double now_ns(void);
+int compare_double(const void *a, const void *b);
+int evict_caches(char *buffer);
+double time_op(SymTable_T oSymTable, int op, char *key, int *value);
+void cold(int num_keys, int max_key_len, char *alphabet);
+#ifdef SYMTABLE_STATS
+void ignore_bind(const char *pcKey, void *pvValue, void *pvExtra);
+void ignore_binds(const char **ppcKeys, void **ppvValues, unsigned int uiCount,
+                  void *pvExtra);
+unsigned long take_max(struct SymTableStats *max);
+int check_stats(const char *name, int sorted, struct SymTableStats *max,
+                unsigned long visits, unsigned long compares,
+                unsigned long allocs);
+int check_table(int size, int sorted);
+#endif
 
 
 /*  main
 
 Parameters:
-argc: number of command line arguments. Can be 1 (will run default actions)
-or 4 (to create random tables).
+argc: number of command line arguments. Can be 1 (will run default actions),
+5 (to create random tables) or 4 (to run a sweep) or 5 (cold-cache test)
+or 3 (operation count check).
 argv: command line arguments. 
     1st argument: executable file name
     2nd argument: number of the keys in the array
     3rd argument: maximum key length
     4th argument: characters to be used for creating the keys
-    5th argument: number of iterations of actions on each table */
+    5th argument: number of iterations of actions on each table
+
+    For a sweep:
+    2nd argument: -sweep
+    3rd argument: maximum table size
+    4th argument: characters to be used for creating the keys
+
+    For a cold-cache test:
+    2nd argument: -cold
+    3rd argument: number of the keys in the table
+    4th argument: maximum key length
+    5th argument: characters to be used for creating the keys
+
+    For an operation count check (instrumented builds only):
+    2nd argument: -check
+    3rd argument: number of the keys in the table */
 int main(int argc, char** argv) {
     SymTable_T oSymTable;
     int i, j;
@@ -37,13 +93,46 @@ int main(int argc, char** argv) {
     char **keys;        /* array of character keys */
     int *values;        /* array of integer values */
     char *alphabet;     /* array of the available characters for a key */
+    SymHll_T oHll;
+    unsigned long distinct; /* estimated number of distinct keys */
     clock_t start, end;
     double cpu_time_used;
 
+    /* sweep over table sizes and key lengths */
+    if (argc == 4 && !strcmp(argv[1], "-sweep")) {
+        srand(getpid());
+        sweep(atoi(argv[2]), argv[3]);
+    }
+
+    /* compare operations with cold and warm caches */
+    else if (argc == 5 && !strcmp(argv[1], "-cold")) {
+        srand(getpid());
+        cold(atoi(argv[2]), atoi(argv[3]), argv[4]);
+    }
+
+#ifdef SYMTABLE_STATS
+    /* check the operation counts against their bounds */
+    else if (argc == 3 && !strcmp(argv[1], "-check")) {
+        num_keys = atoi(argv[2]);
+        if (num_keys <= 0) {
+            printf("NUM_KEYS must be > 0\n");
+            return 1;
+        }
+        i = check_table(num_keys, 0) + check_table(num_keys, 1);
+        printf("++> %d checks failed\n", i);
+        return i != 0;
+    }
+#endif
+
     /* extra command line arguments: random table is created */
-    if (argc != 1) {
+    else if (argc != 1) {
         if (argc != 5) {
             printf("Usage: %s {NUM_KEYS} {MAX_KEY_LEN} {ALPHABET} {NUM_ITER}\n", argv[0]);
+            printf("       %s -sweep {MAX_SIZE} {ALPHABET}\n", argv[0]);
+            printf("       %s -cold {NUM_KEYS} {MAX_KEY_LEN} {ALPHABET}\n", argv[0]);
+#ifdef SYMTABLE_STATS
+            printf("       %s -check {NUM_KEYS}\n", argv[0]);
+#endif
             return 1;
         }
         srand(getpid());
@@ -63,9 +152,20 @@ int main(int argc, char** argv) {
         /* generate an array of random keys */
         keys = random_keys(alphabet, num_keys, max_key_len);
 
+        /* estimate the distinct keys so that each table allocates its
+        bindings once */
+        oHll = SymHll_new(12);
+        for (i = 0; i < num_keys; i++) {
+            SymHll_add(oHll, keys[i]);
+        }
+        distinct = SymHll_estimate(oHll);
+        SymHll_free(oHll);
+        printf("++> About %lu distinct keys\n", distinct);
+
         for (i = 0; i < NTABLES; i++) {
             printf("++> ----------Creating table #%d----------\n", i+1);
-            oSymTable = SymTable_new();
+            oSymTable = new_table();
+            SymTable_reserve(oSymTable, distinct);
 
             for (j = 0; j < iter; j++) {
                 printf("++> ----------Iteration %d----------\n", j+1);
@@ -81,10 +181,7 @@ int main(int argc, char** argv) {
             SymTable_free(oSymTable);
             printf("DONE\n");
         }
-        for (i = 0; i < num_keys; i++) {
-            free(keys[i]);
-        }
-        free(keys);
+        free_keys(keys, num_keys);
         free(values);
     }
 
@@ -93,12 +190,195 @@ int main(int argc, char** argv) {
         printf("No tables specified\n");
         printf("To run random tests use:\n");
         printf("%s {NUM_KEYS} {MAX_KEY_LEN} {ALPHABET} {NUM_ITER}\n", argv[0]);
+        printf("To sweep table sizes use:\n");
+        printf("%s -sweep {MAX_SIZE} {ALPHABET}\n", argv[0]);
+        printf("To compare cold and warm caches use:\n");
+        printf("%s -cold {NUM_KEYS} {MAX_KEY_LEN} {ALPHABET}\n", argv[0]);
     }
 
     return 0;
 }
 
 
+/* new_table
+
+Creates a sorted or unsorted table depending on the SORTED constant.
+
+Returns: a SymTable_T type. */
+SymTable_T new_table(void) {
+    #if SORTED
+        return SymTable_newSorted();
+    #else
+        return SymTable_new();
+    #endif
+}
+
+
+/* free_keys
+
+Frees an array of keys created by random_keys.
+
+Parameters:
+keys: array of character keys.
+num_keys: number of keys in the array.
+
+Returns: void */
+void free_keys(char **keys, int num_keys) {
+    int i;
+
+    for (i = 0; i < num_keys; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    return;
+}
+
+
+/* ns_per_op
+
+Returns: the CPU time in nanoseconds between start and end divided by ops. */
+double ns_per_op(clock_t start, clock_t end, long ops) {
+    return ((double) (end - start)) / CLOCKS_PER_SEC * 1e9 / ops;
+}
+
+
+/* sweep_point
+
+Runs the operations of random_actions on tables of size bindings with keys
+of at most max_key_len characters, and prints one CSV line with the CPU
+time per operation:
+
+size, max_key_len, put, get (half hits, half misses), map, map in
+batches, remove + put
+
+Small tables are built several times so that at least SWEEP_OPS puts are
+timed. Gets and removes are timed over SWEEP_OPS operations; every removed
+key is put back so that the size stays the same.
+
+Parameters:
+size: number of keys in the table.
+max_key_len: maximum key length.
+alphabet: characters to be used for creating the keys.
+
+Returns: 1 if the point took less than SWEEP_TIME_LIMIT seconds, 0 otherwise */
+int sweep_point(int size, int max_key_len, char *alphabet) {
+    SymTable_T oSymTable, *tables;
+    char **keys;
+    int i, j, reps, value, pvValue = 2;
+    long num_puts;
+    clock_t point_start, start, end;
+    double put_ns, get_ns, map_ns, map_batch_ns, remove_ns;
+
+    point_start = clock();
+
+    /* keys[0..size) are inserted, keys[size..2*size) are mostly misses */
+    keys = random_keys(alphabet, 2 * size, max_key_len);
+    reps = size < SWEEP_OPS ? SWEEP_OPS / size : 1;
+    value = 1;
+
+    /* the tables of all repetitions are freed after the timed loop, so
+    that freeing is not counted as part of the puts */
+    tables = malloc(reps * sizeof(SymTable_T));
+    assert(tables);
+    num_puts = 0;
+    start = clock();
+    for (i = 0; i < reps; i++) {
+        tables[i] = new_table();
+        for (j = 0; j < size; j++) {
+            SymTable_put(tables[i], keys[j], &value);
+        }
+        num_puts += size;
+    }
+    end = clock();
+    put_ns = ns_per_op(start, end, num_puts);
+    oSymTable = tables[reps - 1];
+    for (i = 0; i < reps - 1; i++) {
+        SymTable_free(tables[i]);
+    }
+    free(tables);
+
+    start = clock();
+    for (i = 0; i < SWEEP_OPS; i++) {
+        SymTable_get(oSymTable, keys[rand() % (2 * size)]);
+    }
+    end = clock();
+    get_ns = ns_per_op(start, end, SWEEP_OPS);
+
+    start = clock();
+    for (i = 0; i < reps; i++) {
+        SymTable_map(oSymTable, update_bind, &pvValue);
+    }
+    end = clock();
+    map_ns = ns_per_op(start, end, (long) reps * size);
+
+    start = clock();
+    for (i = 0; i < reps; i++) {
+        SymTable_mapBatch(oSymTable, update_binds, &pvValue);
+    }
+    end = clock();
+    map_batch_ns = ns_per_op(start, end, (long) reps * size);
+
+    start = clock();
+    for (i = 0; i < SWEEP_OPS; i++) {
+        j = rand() % size;
+        if (SymTable_remove(oSymTable, keys[j])) {
+            SymTable_put(oSymTable, keys[j], &value);
+        }
+    }
+    end = clock();
+    remove_ns = ns_per_op(start, end, SWEEP_OPS);
+
+    printf("%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f\n", size, max_key_len,
+           put_ns, get_ns, map_ns, map_batch_ns, remove_ns);
+    fflush(stdout);
+
+    SymTable_free(oSymTable);
+    free_keys(keys, 2 * size);
+
+    return ((double) (clock() - point_start)) / CLOCKS_PER_SEC < SWEEP_TIME_LIMIT;
+}
+
+
+/* sweep
+
+Runs sweep_point for table sizes 1, 2, 5, 10, 20, 50, ... up to max_size
+and maximum key lengths 4, 16 and 64. The output is CSV, suitable for
+plotting the cost of each operation as a function of the table size. For
+each key length, the sweep stops at the first size that takes longer than
+SWEEP_TIME_LIMIT seconds.
+
+Parameters:
+max_size: maximum number of keys in a table.
+alphabet: characters to be used for creating the keys.
+
+Returns: void */
+void sweep(int max_size, char *alphabet) {
+    int key_lens[] = {4, 16, 64};
+    int steps[] = {1, 2, 5};
+    int i, size, scale, step;
+
+    printf("size,max_key_len,put_ns,get_ns,map_ns,map_batch_ns,remove_put_ns\n");
+    for (i = 0; i < 3; i++) {
+        for (scale = 1, step = 0; (size = steps[step] * scale) <= max_size;) {
+            if (!sweep_point(size, key_lens[i], alphabet)) {
+                printf("# max_key_len %d: sizes above %d skipped (time limit)\n",
+                       key_lens[i], size);
+                break;
+            }
+            step++;
+            if (step == 3) {
+                step = 0;
+                if (scale > max_size / 10) {
+                    break;
+                }
+                scale *= 10;
+            }
+        }
+    }
+    return;
+}
+
+
 /* random_actions
 
 Performs random operations on table oSymTable like:
@@ -144,7 +424,7 @@ void random_actions(SymTable_T oSymTable, char **keys, int num_keys, int *values
     #endif
 
     printf("++> Transforming the values of bindings...");
-    SymTable_map(oSymTable, update_bind, &pvValue);
+    SymTable_mapBatch(oSymTable, update_binds, &pvValue);
     printf("DONE\n");
 
     #if DEBUG
@@ -242,6 +522,34 @@ void update_bind(const char *pcKey, void *pvValue, void *pvExtra) {
 }
 
 
+/* update_binds
+
+Function used by SymTable_mapBatch() for changing the values of uiCount
+bindings. Same as update_bind for every binding.
+
+Checks: if ppvValues and pvExtra are not NULL at runtime.
+
+Parameters:
+ppcKeys: array of keys. Ignored in this function.
+ppvValues: array of pointers to void values (treated as integers).
+uiCount: number of bindings.
+pvExtra: pointer to a void value (treated as integer).
+
+Returns: void*/
+void update_binds(const char **ppcKeys, void **ppvValues, unsigned int uiCount,
+                  void *pvExtra) {
+    unsigned int i;
+    int val_extra;
+    assert(ppvValues);
+    assert(pvExtra);
+    val_extra = *(int *) pvExtra;
+    for (i = 0; i < uiCount; i++) {
+        *(int *) ppvValues[i] += val_extra;
+    }
+    return;
+}
+
+
 /* random_keys
 
 Creates an array of character arrays (keys). Each key has
@@ -286,4 +594,412 @@ char** random_keys(char *alphabet, int num_keys, int max_key_len) {
         keys[i][j] = '\0';
     }
     return keys;
-}
\ No newline at end of file
+}
+
+/* now_ns
+
+Returns: the time in nanoseconds from a monotonic clock. */
+double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/* compare_double
+
+Function used by qsort() to sort times. */
+int compare_double(const void *a, const void *b) {
+    double x, y;
+
+    x = *(const double *) a;
+    y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+
+/* evict_caches
+
+Reads one byte in every cache line of a buffer larger than the caches,
+so that the next table operation finds none of its data cached.
+
+Parameters:
+buffer: array of COLD_BUFFER characters.
+
+Returns: the sum of the bytes read, so that the reads are not optimized
+away. */
+int evict_caches(char *buffer) {
+    int i, sum;
+
+    for (i = 0, sum = 0; i < COLD_BUFFER; i += 64) {
+        sum += buffer[i];
+    }
+    return sum;
+}
+
+
+/* time_op
+
+Parameters:
+oSymTable: a SymTable_T type.
+op: 0 for get, 1 for put, 2 for remove.
+key: key of the operation.
+value: value of a put.
+
+Returns: the time of the operation in nanoseconds. */
+double time_op(SymTable_T oSymTable, int op, char *key, int *value) {
+    double start;
+
+    start = now_ns();
+    switch (op) {
+        case 0:
+            SymTable_get(oSymTable, key);
+            break;
+        case 1:
+            SymTable_put(oSymTable, key, value);
+            break;
+        default:
+            SymTable_remove(oSymTable, key);
+            break;
+    }
+
+    return now_ns() - start;
+}
+
+
+/* cold
+
+Creates a table of num_keys bindings and times COLD_OPS gets (hits and
+misses), puts of new keys and removes of those keys, first with warm caches
+(operations back to back) and then with cold caches (evict_caches before
+every operation). Prints the median and 90th percentile of each operation.
+
+Parameters:
+num_keys: number of keys in the table.
+max_key_len: maximum key length.
+alphabet: characters to be used for creating the keys.
+
+Returns: void */
+void cold(int num_keys, int max_key_len, char *alphabet) {
+    char *names[] = {"get hit", "get miss", "put", "remove"};
+    int ops[] = {0, 0, 1, 2};
+    SymTable_T oSymTable;
+    char **keys, *buffer, *key;
+    double times[2][COLD_OPS];
+    int i, j, mode, value = 1, sum = 0;
+
+    if (num_keys <= 0) {
+        printf("NUM_KEYS must be > 0\n");
+        return;
+    }
+
+    /* keys[0..num_keys) are inserted, the next COLD_OPS are new keys */
+    keys = random_keys(alphabet, num_keys + COLD_OPS, max_key_len);
+    /* memset, unlike calloc, backs every page of the buffer with memory */
+    buffer = malloc(COLD_BUFFER);
+    assert(buffer);
+    memset(buffer, 0, COLD_BUFFER);
+    oSymTable = new_table();
+    for (i = 0; i < num_keys; i++) {
+        SymTable_put(oSymTable, keys[i], &value);
+    }
+
+    printf("++> %d keys, %d operations, median / p90 in ns\n", num_keys, COLD_OPS);
+    for (j = 0; j < 4; j++) {
+        for (mode = 0; mode < 2; mode++) {
+
+            /* new keys must be absent before puts and present before removes */
+            for (i = 0; i < COLD_OPS && ops[j]; i++) {
+                if (ops[j] == 1) {
+                    SymTable_remove(oSymTable, keys[num_keys + i]);
+                }
+                else {
+                    SymTable_put(oSymTable, keys[num_keys + i], &value);
+                }
+            }
+
+            for (i = 0; i < COLD_OPS; i++) {
+                key = j == 0 ? keys[rand() % num_keys] : keys[num_keys + i];
+                if (mode) {
+                    sum += evict_caches(buffer);
+                }
+                times[mode][i] = time_op(oSymTable, ops[j], key, &value);
+            }
+            qsort(times[mode], COLD_OPS, sizeof(double), compare_double);
+        }
+        printf("%-9s warm %8.0f / %8.0f   cold %8.0f / %8.0f   (x%.1f)\n", names[j],
+               times[0][COLD_OPS / 2], times[0][COLD_OPS * 9 / 10],
+               times[1][COLD_OPS / 2], times[1][COLD_OPS * 9 / 10],
+               times[1][COLD_OPS / 2] / times[0][COLD_OPS / 2]);
+    }
+
+    assert(sum == 0);
+    SymTable_free(oSymTable);
+    free(buffer);
+    free_keys(keys, num_keys + COLD_OPS);
+    return;
+}
+
+
+#ifdef SYMTABLE_STATS
+/* ignore_bind
+
+Function used by SymTable_map() that does nothing.
+
+Returns: void */
+void ignore_bind(const char *pcKey, void *pvValue, void *pvExtra) {
+    return;
+}
+
+
+/* ignore_binds
+
+Function used by SymTable_mapBatch() that does nothing.
+
+Returns: void */
+void ignore_binds(const char **ppcKeys, void **ppvValues, unsigned int uiCount,
+                  void *pvExtra) {
+    return;
+}
+
+
+/* take_max
+
+Takes the operation counts of the last operation and keeps the largest
+counts seen in max.
+
+Parameters:
+max: the largest counts so far. Updated.
+
+Returns: the visited bindings of the last operation */
+unsigned long take_max(struct SymTableStats *max) {
+    struct SymTableStats stats;
+
+    SymTable_takeStats(&stats);
+    if (stats.ulVisits > max->ulVisits) {
+        max->ulVisits = stats.ulVisits;
+    }
+    if (stats.ulCompares > max->ulCompares) {
+        max->ulCompares = stats.ulCompares;
+    }
+    if (stats.ulAllocs > max->ulAllocs) {
+        max->ulAllocs = stats.ulAllocs;
+    }
+    return stats.ulVisits;
+}
+
+
+/* check_stats
+
+Prints the largest operation counts of an operation next to their upper
+bounds and resets them.
+
+Parameters:
+name: name of the operation.
+sorted: 1 if the table is sorted, 0 otherwise.
+max: the largest counts of the operation. Reset to 0.
+visits: upper bound of visited bindings.
+compares: upper bound of key comparisons.
+allocs: upper bound of allocations.
+
+Returns: 1 if a count is above its bound, 0 otherwise */
+int check_stats(const char *name, int sorted, struct SymTableStats *max,
+                unsigned long visits, unsigned long compares,
+                unsigned long allocs) {
+    int failed;
+
+    failed = max->ulVisits > visits || max->ulCompares > compares ||
+             max->ulAllocs > allocs;
+    printf("++> %-8s %-12s visits %lu/%lu, compares %lu/%lu, allocs %lu/%lu: %s\n",
+           sorted ? "sorted" : "unsorted", name, max->ulVisits, visits,
+           max->ulCompares, compares, max->ulAllocs, allocs,
+           failed ? "FAILED" : "ok");
+    max->ulVisits = max->ulCompares = max->ulAllocs = 0;
+
+    return failed;
+}
+
+
+/* check_table
+
+Runs every operation on a table of size keys and checks that its
+operation counts stay within the bounds of its algorithm. The counts do
+not depend on the machine, so a check fails only if an operation does more
+work than it should. Keys of the same hash are rare, so a lookup is allowed
+2 key comparisons. In SYMTABLE_RANDOM mode the array of bindings grows by
+doubling, which adds one allocation to a put. A miss of a random
+key stops at the first greater binding of a sorted table, which is half way
+on average, so sorted tables must average at most 3/4 of the bindings per
+miss. The short keys of smaller tables than MISS_MIN_SIZE have small hashes
+that order before most random keys, so they are only held to the bound of
+unsorted tables.
+
+Parameters:
+size: number of keys in the table.
+sorted: 1 for a sorted table, 0 otherwise.
+
+Returns: the number of failed checks */
+int check_table(int size, int sorted) {
+    SymTable_T oSymTable, oClone, oOther;
+    struct SymTableStats max, avg;
+    unsigned long visits, state;
+    char key[32];
+    int i, j, failed;
+
+    oSymTable = sorted ? SymTable_newSorted() : SymTable_new();
+    oOther = sorted ? SymTable_newSorted() : SymTable_new();
+    for (i = 0; i < size; i++) {
+        sprintf(key, "m%d", i);
+        SymTable_put(oOther, key, NULL);
+    }
+    SymTable_takeStats(&max);
+    max.ulVisits = max.ulCompares = max.ulAllocs = 0;
+    failed = 0;
+
+    /* single bindings: one traversal of at most size bindings */
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_put(oSymTable, key, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("put new", sorted, &max, size, 2, 2);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_put(oSymTable, key, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("put existing", sorted, &max, size, 2, 0);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_get(oSymTable, key);
+        take_max(&max);
+    }
+    failed += check_stats("get hit", sorted, &max, size, 2, 0);
+    visits = 0;
+    for (i = 0; i < size; i++) {
+        for (j = 0; j < 8; j++) {
+            key[j] = 'a' + rand() % 26;
+        }
+        key[j] = '\0';
+        SymTable_get(oSymTable, key);
+        visits += take_max(&max);
+    }
+    failed += check_stats("get miss", sorted, &max, size, 2, 0);
+    avg.ulVisits = visits / size;
+    avg.ulCompares = avg.ulAllocs = 0;
+    failed += check_stats("miss average", sorted, &avg,
+                          sorted && size >= MISS_MIN_SIZE ?
+                          size * 3 / 4 : size, 0, 0);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_contains(oSymTable, key);
+        take_max(&max);
+    }
+    failed += check_stats("contains", sorted, &max, size, 2, 0);
+    for (i = 0; i < size; i += 2) {
+        sprintf(key, "k%d", i);
+        SymTable_remove(oSymTable, key);
+        take_max(&max);
+    }
+    failed += check_stats("remove", sorted, &max, size, 2, 0);
+    for (i = 0; i < size; i += 2) {
+        sprintf(key, "k%d", i);
+        SymTable_put(oSymTable, key, NULL);
+    }
+    SymTable_takeStats(&max);
+    max.ulVisits = max.ulCompares = max.ulAllocs = 0;
+
+    /* whole table: one pass over the bindings */
+    SymTable_map(oSymTable, ignore_bind, NULL);
+    take_max(&max);
+    failed += check_stats("map", sorted, &max, size, 0, 0);
+    SymTable_mapBatch(oSymTable, ignore_binds, NULL);
+    take_max(&max);
+    failed += check_stats("mapBatch", sorted, &max, size, 0, 0);
+    oClone = SymTable_clone(oSymTable);
+    take_max(&max);
+    failed += check_stats("clone", sorted, &max, size, 0, 2);
+
+    /* merge of size new bindings: linear for sorted tables, one lookup per
+    binding otherwise */
+    SymTable_merge(oClone, oOther, NULL, NULL);
+    take_max(&max);
+    if (sorted) {
+        failed += check_stats("merge", sorted, &max, 3 * size, 2 * size,
+                              2 * size);
+    }
+    else {
+        failed += check_stats("merge", sorted, &max,
+                              (unsigned long) size * 2 * size + size,
+                              2 * size, 2 * size);
+    }
+
+    /* reset: one pass that frees the bindings, unless the table is
+    reusable */
+    SymTable_reset(oClone);
+    take_max(&max);
+    failed += check_stats("reset free", sorted, &max, 2 * size, 0, 0);
+
+    /* reset of a reusable table: constant time, misses of an unsorted
+    table skip the stale bindings, and keys put again revive their
+    bindings */
+    SymTable_setMode(oSymTable, SYMTABLE_REUSABLE);
+    SymTable_reset(oSymTable);
+    take_max(&max);
+    failed += check_stats("reset", sorted, &max, 0, 0, 0);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "m%d", i);
+        SymTable_get(oSymTable, key);
+        take_max(&max);
+    }
+    failed += check_stats("stale miss", sorted, &max, sorted ? size : 0, 2, 0);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_put(oSymTable, key, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("put revived", sorted, &max, size, 2, 0);
+
+    /* random bindings: the array is built in one pass, then a binding is
+    picked without visiting the list */
+    SymTable_setMode(oSymTable, SYMTABLE_REUSABLE | SYMTABLE_RANDOM);
+    take_max(&max);
+    failed += check_stats("set random", sorted, &max, size, 0, 1);
+    state = 1;
+    for (i = 0; i < size; i++) {
+        SymTable_randomBinding(oSymTable, &state, NULL, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("random", sorted, &max, 0, 0, 0);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "n%d", i);
+        SymTable_put(oSymTable, key, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("put random", sorted, &max, 2 * size, 2, 3);
+
+    /* reserved bindings: a put only allocates its key */
+    SymTable_free(oClone);
+    oClone = sorted ? SymTable_newSorted() : SymTable_new();
+    SymTable_takeStats(&max);
+    max.ulVisits = max.ulCompares = max.ulAllocs = 0;
+    SymTable_reserve(oClone, size);
+    take_max(&max);
+    failed += check_stats("reserve", sorted, &max, 0, 0, 1);
+    for (i = 0; i < size; i++) {
+        sprintf(key, "k%d", i);
+        SymTable_put(oClone, key, NULL);
+        take_max(&max);
+    }
+    failed += check_stats("put reserved", sorted, &max, size, 2, 1);
+
+    SymTable_free(oClone);
+    SymTable_free(oOther);
+    SymTable_free(oSymTable);
+
+    return failed;
+}
+#endif
@@ -0,0 +1,316 @@
+/* Library for sharing a memory budget between Symbol tables.
+
+Per-thread accounting: each thread keeps its own counter and publishes it
+to the shared counter in chunks of SYMBUDGET_SLACK bytes. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symbudget.h"
+
+#define SYMBUDGET_SLACK 16384   /* bytes a thread may account locally */
+
+
+/* Struct that represents the usage of a single thread. lDelta is the
+number of bytes not yet published to the shared counter and is only
+written by the owner thread. */
+struct alocal {
+    long lDelta;
+    int iShrinking;
+    struct alocal *next;
+};
+
+
+/* Struct that represents a registered shrink callback */
+struct ashrink {
+    int (*pfShrink)(size_t uiNeeded, void *pvExtra);
+    void *pvExtra;
+    struct ashrink *next;
+};
+
+
+/* Struct that represents a budget. lUsed is the published usage of all
+threads. The list of per-thread counters is protected by lock. Callbacks
+are appended under lock and their links are read atomically. */
+struct SymBudget {
+    size_t uiLimit;
+    long lUsed;
+    pthread_key_t key;
+    pthread_mutex_t lock;
+    struct alocal *locals;
+    struct ashrink *shrinks;
+};
+
+
+/* Returns the counter of the calling thread, creating it on first use */
+static struct alocal *SymBudget_local(struct SymBudget *budget) {
+    struct alocal *local;
+
+    local = pthread_getspecific(budget->key);
+    if (local) {
+        return local;
+    }
+    local = malloc(sizeof(struct alocal));
+    assert(local);
+    local->lDelta = 0;
+    local->iShrinking = 0;
+    pthread_mutex_lock(&budget->lock);
+    local->next = budget->locals;
+    budget->locals = local;
+    pthread_mutex_unlock(&budget->lock);
+    pthread_setspecific(budget->key, local);
+
+    return local;
+}
+
+
+/* Adds lBytes to the counter of the calling thread and publishes the
+counter when it gets larger than SYMBUDGET_SLACK bytes */
+static void SymBudget_account(struct SymBudget *budget, struct alocal *local,
+    long lBytes) {
+    long lDelta;
+
+    lDelta = local->lDelta + lBytes;
+    if (lDelta >= SYMBUDGET_SLACK || lDelta <= -SYMBUDGET_SLACK) {
+        __atomic_add_fetch(&budget->lUsed, lDelta, __ATOMIC_RELAXED);
+        lDelta = 0;
+    }
+    __atomic_store_n(&local->lDelta, lDelta, __ATOMIC_RELAXED);
+}
+
+
+/* Returns 1 if the usage seen by the calling thread exceeds the limit */
+static int SymBudget_over(struct SymBudget *budget, struct alocal *local) {
+    long lUsed;
+
+    lUsed = __atomic_load_n(&budget->lUsed, __ATOMIC_RELAXED);
+    if (local->lDelta > 0) {
+        lUsed += local->lDelta;
+    }
+
+    return lUsed > (long) budget->uiLimit;
+}
+
+
+/* Creates a SymBudget struct that allows at most uiLimit bytes to be used
+by all the tables attached to it.
+
+Each thread accounts its own usage locally and publishes it to the shared
+counter only after it has changed by more than SYMBUDGET_SLACK bytes. The
+limit may therefore be exceeded by at most SYMBUDGET_SLACK bytes per thread.
+
+Asserts: if memory was allocated succesfully for oBudget at runtime. */
+SymBudget_T SymBudget_new(size_t uiLimit) {
+    struct SymBudget *budget;
+    int error;
+
+    budget = malloc(sizeof(struct SymBudget));
+    assert(budget);
+    budget->uiLimit = uiLimit;
+    budget->lUsed = 0;
+    budget->locals = NULL;
+    budget->shrinks = NULL;
+    error = pthread_key_create(&budget->key, NULL);
+    assert(!error);
+    pthread_mutex_init(&budget->lock, NULL);
+
+    return (SymBudget_T) budget;
+}
+
+
+/* Frees all memory used by oBudget. All tables attached to oBudget must
+have been freed before.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+void SymBudget_free(SymBudget_T oBudget) {
+    struct SymBudget *budget;
+    struct alocal *local, *local_next;
+    struct ashrink *shrink, *shrink_next;
+
+    budget = oBudget;
+    if (!budget) {
+        return;
+    }
+    local = budget->locals;
+    while(local) {
+        local_next = local->next;
+        free(local);
+        local = local_next;
+    }
+    shrink = budget->shrinks;
+    while(shrink) {
+        shrink_next = shrink->next;
+        free(shrink);
+        shrink = shrink_next;
+    }
+    pthread_key_delete(budget->key);
+    pthread_mutex_destroy(&budget->lock);
+    free(budget);
+
+    return;
+}
+
+
+/* Registers function pfShrink that is called when a charge would exceed
+the limit of oBudget. pfShrink should release memory (for example by
+removing bindings from a table) and return 1 if it released anything, 0
+otherwise. Callbacks are called in the order they were registered.
+
+Asserts:
+1) if oBudget and pfShrink are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* pfShrink: function to call when the limit is exceeded
+* pvExtra: a pointer to any value. Used by pfShrink. */
+void SymBudget_addShrink(SymBudget_T oBudget,
+    int (*pfShrink)(size_t uiNeeded, void *pvExtra), const void *pvExtra) {
+    struct SymBudget *budget;
+    struct ashrink *new_shrink, **pptr;
+
+    budget = oBudget;
+    assert(budget);
+    assert(pfShrink);
+
+    new_shrink = malloc(sizeof(struct ashrink));
+    assert(new_shrink);
+    new_shrink->pfShrink = pfShrink;
+    new_shrink->pvExtra = (void *) pvExtra;
+    new_shrink->next = NULL;
+
+    /* callbacks are appended so that they run in registration order. The
+    link is stored atomically as SymBudget_charge reads it without the
+    lock. */
+    pthread_mutex_lock(&budget->lock);
+    pptr = &budget->shrinks;
+    while(*pptr) {
+        pptr = &(*pptr)->next;
+    }
+    __atomic_store_n(pptr, new_shrink, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&budget->lock);
+
+    return;
+}
+
+
+/* Charges uiBytes to oBudget. If the limit would be exceeded, the shrink
+callbacks are called until enough memory is released or none of them
+releases anything.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* uiBytes: number of bytes to charge
+
+Returns: 1 if the bytes were charged, 0 if the charge was rejected. */
+int SymBudget_charge(SymBudget_T oBudget, size_t uiBytes) {
+    struct SymBudget *budget;
+    struct alocal *local;
+    struct ashrink *shrink;
+    int released;
+
+    budget = oBudget;
+    assert(budget);
+
+    local = SymBudget_local(budget);
+    SymBudget_account(budget, local, (long) uiBytes);
+    if (!SymBudget_over(budget, local)) {
+        return 1;
+    }
+
+    /* a shrink callback that inserts into a table must not shrink again */
+    if (local->iShrinking) {
+        SymBudget_account(budget, local, -(long) uiBytes);
+        return 0;
+    }
+
+    /* The callbacks run without holding the lock, as they are expected to
+    call SymBudget_release. Callbacks are only ever appended to the list,
+    and its links are read atomically, so it can be traversed while
+    SymBudget_addShrink appends to it. */
+    local->iShrinking = 1;
+    do {
+        released = 0;
+        shrink = __atomic_load_n(&budget->shrinks, __ATOMIC_ACQUIRE);
+        while(shrink && SymBudget_over(budget, local)) {
+            released |= shrink->pfShrink(uiBytes, shrink->pvExtra);
+            shrink = __atomic_load_n(&shrink->next, __ATOMIC_ACQUIRE);
+        }
+    } while(released && SymBudget_over(budget, local));
+    local->iShrinking = 0;
+
+    if (SymBudget_over(budget, local)) {
+        SymBudget_account(budget, local, -(long) uiBytes);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/* Returns uiBytes to oBudget.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* uiBytes: number of bytes to release */
+void SymBudget_release(SymBudget_T oBudget, size_t uiBytes) {
+    struct SymBudget *budget;
+
+    budget = oBudget;
+    assert(budget);
+
+    SymBudget_account(budget, SymBudget_local(budget), -(long) uiBytes);
+
+    return;
+}
+
+
+/* Returns the number of bytes currently charged to oBudget by all threads.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+size_t SymBudget_getUsed(SymBudget_T oBudget) {
+    struct SymBudget *budget;
+    struct alocal *local;
+    long lUsed;
+
+    budget = oBudget;
+    assert(budget);
+
+    pthread_mutex_lock(&budget->lock);
+    lUsed = __atomic_load_n(&budget->lUsed, __ATOMIC_RELAXED);
+    local = budget->locals;
+    while(local) {
+        lUsed += __atomic_load_n(&local->lDelta, __ATOMIC_RELAXED);
+        local = local->next;
+    }
+    pthread_mutex_unlock(&budget->lock);
+
+    return lUsed > 0 ? (size_t) lUsed : 0;
+}
+
+
+/* Returns the limit of oBudget.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+size_t SymBudget_getLimit(SymBudget_T oBudget) {
+    struct SymBudget *budget;
+
+    budget = oBudget;
+    assert(budget);
+
+    return budget->uiLimit;
+}
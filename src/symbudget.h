@@ -0,0 +1,98 @@
+/* Library for sharing a memory budget between Symbol tables */
+
+#ifndef SYMBUDGET_INCLUDE
+#define SYMBUDGET_INCLUDE
+
+#include <stddef.h>
+
+typedef void* SymBudget_T;
+
+
+/* Creates a SymBudget struct that allows at most uiLimit bytes to be used
+by all the tables attached to it.
+
+Each thread accounts its own usage locally and publishes it to the shared
+counter only after it has changed by more than SYMBUDGET_SLACK bytes. The
+limit may therefore be exceeded by at most SYMBUDGET_SLACK bytes per thread.
+
+Asserts: if memory was allocated succesfully for oBudget at runtime. */
+SymBudget_T SymBudget_new(size_t uiLimit);
+
+
+/* Frees all memory used by oBudget. All tables attached to oBudget must
+have been freed before.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+void SymBudget_free(SymBudget_T oBudget);
+
+
+/* Registers function pfShrink that is called when a charge would exceed
+the limit of oBudget. pfShrink should release memory (for example by
+removing bindings from a table) and return 1 if it released anything, 0
+otherwise. Callbacks are called in the order they were registered.
+
+pfShrink may be called from inside SymTable_put, SymTable_rekey,
+SymTable_merge and SymTable_clone on a table attached to oBudget, and may
+then call any SymTable function on that same table, including
+SymTable_remove and SymTable_reset: the interrupted call notices the
+change and starts over. It must not call SymTable_free or
+SymTable_setBudget on it, nor remove bindings from the source table of
+the SymTable_merge being charged.
+
+Asserts:
+1) if oBudget and pfShrink are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* pfShrink: function to call when the limit is exceeded
+* pvExtra: a pointer to any value. Used by pfShrink. */
+void SymBudget_addShrink(SymBudget_T oBudget,
+        int (*pfShrink)(size_t uiNeeded, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Charges uiBytes to oBudget. If the limit would be exceeded, the shrink
+callbacks are called until enough memory is released or none of them
+releases anything.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* uiBytes: number of bytes to charge
+
+Returns: 1 if the bytes were charged, 0 if the charge was rejected. */
+int SymBudget_charge(SymBudget_T oBudget, size_t uiBytes);
+
+
+/* Returns uiBytes to oBudget.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type
+* uiBytes: number of bytes to release */
+void SymBudget_release(SymBudget_T oBudget, size_t uiBytes);
+
+
+/* Returns the number of bytes currently charged to oBudget by all threads.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+size_t SymBudget_getUsed(SymBudget_T oBudget);
+
+
+/* Returns the limit of oBudget.
+
+Asserts: if oBudget is not NULL at runtime.
+
+Parameters:
+* oBudget: a SymBudget_T type */
+size_t SymBudget_getLimit(SymBudget_T oBudget);
+
+
+#endif
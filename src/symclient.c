@@ -0,0 +1,346 @@
+/* Client library for the Symbol table server (symtabd) */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "symclient.h"
+
+#define BUFSIZE 65536
+
+
+/* Struct that represents a connection. Queued requests are kept in out,
+received bytes that were not returned yet are kept in in. */
+struct SymClient {
+    int fd;
+    char *out;
+    size_t out_len, out_cap;
+    char *in;
+    size_t in_start, in_len, in_cap;
+};
+
+
+/* Appends iLen bytes of pcData to the queued requests of client */
+static void SymClient_append(struct SymClient *client, const char *pcData,
+    size_t iLen) {
+    while(client->out_len + iLen > client->out_cap) {
+        client->out_cap *= 2;
+        client->out = realloc(client->out, client->out_cap);
+        assert(client->out);
+    }
+    memcpy(client->out + client->out_len, pcData, iLen);
+    client->out_len += iLen;
+}
+
+
+/* Connects to the server listening on the Unix domain socket pcPath.
+
+Asserts:
+1) if pcPath is not NULL at runtime.
+2) if memory was allocated succesfully for oClient at runtime.
+
+Parameters:
+* pcPath: path of the socket. Must be null terminated.
+
+Returns: a SymClient_T type or NULL if the connection failed. */
+SymClient_T SymClient_connect(const char *pcPath) {
+    struct SymClient *client;
+    struct sockaddr_un addr;
+    int fd;
+
+    assert(pcPath);
+    if (strlen(pcPath) >= sizeof(addr.sun_path)) {
+        return NULL;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, pcPath);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    client = malloc(sizeof(struct SymClient));
+    assert(client);
+    client->fd = fd;
+    client->out_len = 0;
+    client->out_cap = BUFSIZE;
+    client->out = malloc(client->out_cap);
+    client->in_start = 0;
+    client->in_len = 0;
+    client->in_cap = BUFSIZE;
+    client->in = malloc(client->in_cap);
+    assert(client->out && client->in);
+
+    return (SymClient_T) client;
+}
+
+
+/* Closes the connection and frees all memory used by oClient.
+
+Parameters:
+* oClient: a SymClient_T type */
+void SymClient_close(SymClient_T oClient) {
+    struct SymClient *client;
+
+    client = oClient;
+    if (!client) {
+        return;
+    }
+    close(client->fd);
+    free(client->out);
+    free(client->in);
+    free(client);
+
+    return;
+}
+
+
+/* Queues a request without sending it. Requests are sent by
+SymClient_flush, so that many requests can be sent with one write and the
+server can answer them with one write (pipelining).
+
+Requests and their responses (one line each unless noted):
+* "GET", key: "VAL value" or "NIL"
+* "PUT", key, value: "OK" if created, "NO" if key exists
+* "DEL", key: "OK" if removed, "NO" if not found
+* "HAS", key: "OK" if found, "NO" if not found
+* "PRE", prefix: one "KEY key value" line per binding whose key starts
+with prefix, followed by "END"
+
+Keys must not contain spaces or newlines, values must not contain
+newlines.
+
+Asserts:
+1) if oClient, pcCommand and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+* pcCommand: one of "GET", "PUT", "DEL", "HAS", "PRE"
+* pcKey: a character array (key or prefix). Must be null terminated.
+* pcValue: a character array (value) for "PUT", NULL otherwise. */
+void SymClient_send(SymClient_T oClient, const char *pcCommand,
+    const char *pcKey, const char *pcValue) {
+    struct SymClient *client;
+
+    client = oClient;
+    assert(client);
+    assert(pcCommand);
+    assert(pcKey);
+
+    SymClient_append(client, pcCommand, strlen(pcCommand));
+    SymClient_append(client, " ", 1);
+    SymClient_append(client, pcKey, strlen(pcKey));
+    if (pcValue) {
+        SymClient_append(client, " ", 1);
+        SymClient_append(client, pcValue, strlen(pcValue));
+    }
+    SymClient_append(client, "\n", 1);
+}
+
+
+/* Sends all queued requests.
+
+Asserts: if oClient is not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+
+Returns: 1 on success, 0 if the connection failed. */
+int SymClient_flush(SymClient_T oClient) {
+    struct SymClient *client;
+    size_t sent;
+    ssize_t n;
+
+    client = oClient;
+    assert(client);
+
+    sent = 0;
+    while(sent < client->out_len) {
+        n = write(client->fd, client->out + sent, client->out_len - sent);
+        if (n <= 0) {
+            return 0;
+        }
+        sent += n;
+    }
+    client->out_len = 0;
+
+    return 1;
+}
+
+
+/* Receives the next response line, in the order the requests were sent.
+
+Asserts: if oClient is not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+
+Returns: the response without the newline, or NULL if the connection
+failed. The response is valid until the next call on oClient. */
+const char *SymClient_recv(SymClient_T oClient) {
+    struct SymClient *client;
+    char *line, *newline;
+    ssize_t n;
+
+    client = oClient;
+    assert(client);
+
+    while(1) {
+        line = client->in + client->in_start;
+        newline = memchr(line, '\n', client->in_len);
+        if (newline) {
+            *newline = '\0';
+            client->in_len -= newline + 1 - line;
+            client->in_start += newline + 1 - line;
+            return line;
+        }
+
+        /* move the partial line to the start and read more */
+        memmove(client->in, line, client->in_len);
+        client->in_start = 0;
+        if (client->in_len == client->in_cap) {
+            client->in_cap *= 2;
+            client->in = realloc(client->in, client->in_cap);
+            assert(client->in);
+        }
+        n = read(client->fd, client->in + client->in_len,
+                 client->in_cap - client->in_len);
+        if (n <= 0) {
+            return NULL;
+        }
+        client->in_len += n;
+    }
+}
+
+
+/* Sends one request and returns its response line, or NULL on connection
+failure */
+static const char *SymClient_call(struct SymClient *client,
+    const char *pcCommand, const char *pcKey, const char *pcValue) {
+    SymClient_send(client, pcCommand, pcKey, pcValue);
+    if (!SymClient_flush(client)) {
+        return NULL;
+    }
+
+    return SymClient_recv(client);
+}
+
+
+/* Returns 1 for an "OK" response, 0 for "NO" and -1 otherwise */
+static int SymClient_status(const char *pcResponse) {
+    if (!pcResponse) {
+        return -1;
+    }
+    if (!strcmp(pcResponse, "OK")) {
+        return 1;
+    }
+
+    return strcmp(pcResponse, "NO") ? -1 : 0;
+}
+
+
+/* Creates a binding on the server. Sends the request and waits for the
+response.
+
+Asserts: if oClient, pcKey and pcValue are not NULL at runtime.
+
+Returns: 1 if binding was created, 0 if key exists, -1 on connection
+failure. */
+int SymClient_put(SymClient_T oClient, const char *pcKey, const char *pcValue) {
+    assert(pcValue);
+
+    return SymClient_status(SymClient_call(oClient, "PUT", pcKey, pcValue));
+}
+
+
+/* Removes a binding on the server. Sends the request and waits for the
+response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: 1 if removal was successful, 0 if not found, -1 on connection
+failure. */
+int SymClient_remove(SymClient_T oClient, const char *pcKey) {
+    return SymClient_status(SymClient_call(oClient, "DEL", pcKey, NULL));
+}
+
+
+/* Checks whether a binding exists on the server. Sends the request and
+waits for the response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: 1 if found, 0 if not found, -1 on connection failure. */
+int SymClient_contains(SymClient_T oClient, const char *pcKey) {
+    return SymClient_status(SymClient_call(oClient, "HAS", pcKey, NULL));
+}
+
+
+/* Finds the value of a binding on the server. Sends the request and waits
+for the response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: the value, which is valid until the next call on oClient, or NULL
+if not found or on connection failure. */
+const char *SymClient_get(SymClient_T oClient, const char *pcKey) {
+    const char *response;
+
+    response = SymClient_call(oClient, "GET", pcKey, NULL);
+    if (!response || strncmp(response, "VAL ", 4)) {
+        return NULL;
+    }
+
+    return response + 4;
+}
+
+
+/* Applies function pfApply to every binding on the server whose key starts
+with pcPrefix. Sends the request and waits for all responses.
+
+Asserts: if oClient, pcPrefix and pfApply are not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+* pcPrefix: a character array. Must be null terminated.
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of bindings, or -1 on connection failure. */
+int SymClient_prefix(SymClient_T oClient, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+    const void *pvExtra) {
+    const char *response;
+    char *key, *value;
+    int count;
+
+    assert(pfApply);
+
+    count = 0;
+    response = SymClient_call(oClient, "PRE", pcPrefix, NULL);
+    while(response && !strncmp(response, "KEY ", 4)) {
+
+        /* split "KEY key value" in place */
+        key = (char *) response + 4;
+        value = strchr(key, ' ');
+        if (value) {
+            *value++ = '\0';
+        }
+        pfApply(key, value ? value : "", (void *) pvExtra);
+        count++;
+        response = SymClient_recv(oClient);
+    }
+
+    return response && !strcmp(response, "END") ? count : -1;
+}
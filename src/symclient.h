@@ -0,0 +1,138 @@
+/* Client library for the Symbol table server (symtabd) */
+
+#ifndef SYMCLIENT_INCLUDE
+#define SYMCLIENT_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymClient_T;
+
+
+/* Connects to the server listening on the Unix domain socket pcPath.
+
+Asserts:
+1) if pcPath is not NULL at runtime.
+2) if memory was allocated succesfully for oClient at runtime.
+
+Parameters:
+* pcPath: path of the socket. Must be null terminated.
+
+Returns: a SymClient_T type or NULL if the connection failed. */
+SymClient_T SymClient_connect(const char *pcPath);
+
+
+/* Closes the connection and frees all memory used by oClient.
+
+Parameters:
+* oClient: a SymClient_T type */
+void SymClient_close(SymClient_T oClient);
+
+
+/* Queues a request without sending it. Requests are sent by
+SymClient_flush, so that many requests can be sent with one write and the
+server can answer them with one write (pipelining).
+
+Requests and their responses (one line each unless noted):
+* "GET", key: "VAL value" or "NIL"
+* "PUT", key, value: "OK" if created, "NO" if key exists
+* "DEL", key: "OK" if removed, "NO" if not found
+* "HAS", key: "OK" if found, "NO" if not found
+* "PRE", prefix: one "KEY key value" line per binding whose key starts
+with prefix, followed by "END"
+
+Keys must not contain spaces or newlines, values must not contain
+newlines.
+
+Asserts:
+1) if oClient, pcCommand and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+* pcCommand: one of "GET", "PUT", "DEL", "HAS", "PRE"
+* pcKey: a character array (key or prefix). Must be null terminated.
+* pcValue: a character array (value) for "PUT", NULL otherwise. */
+void SymClient_send(SymClient_T oClient, const char *pcCommand,
+        const char *pcKey, const char *pcValue);
+
+
+/* Sends all queued requests.
+
+Asserts: if oClient is not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+
+Returns: 1 on success, 0 if the connection failed. */
+int SymClient_flush(SymClient_T oClient);
+
+
+/* Receives the next response line, in the order the requests were sent.
+
+Asserts: if oClient is not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+
+Returns: the response without the newline, or NULL if the connection
+failed. The response is valid until the next call on oClient. */
+const char *SymClient_recv(SymClient_T oClient);
+
+
+/* Creates a binding on the server. Sends the request and waits for the
+response.
+
+Asserts: if oClient, pcKey and pcValue are not NULL at runtime.
+
+Returns: 1 if binding was created, 0 if key exists, -1 on connection
+failure. */
+int SymClient_put(SymClient_T oClient, const char *pcKey, const char *pcValue);
+
+
+/* Removes a binding on the server. Sends the request and waits for the
+response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: 1 if removal was successful, 0 if not found, -1 on connection
+failure. */
+int SymClient_remove(SymClient_T oClient, const char *pcKey);
+
+
+/* Checks whether a binding exists on the server. Sends the request and
+waits for the response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: 1 if found, 0 if not found, -1 on connection failure. */
+int SymClient_contains(SymClient_T oClient, const char *pcKey);
+
+
+/* Finds the value of a binding on the server. Sends the request and waits
+for the response.
+
+Asserts: if oClient and pcKey are not NULL at runtime.
+
+Returns: the value, which is valid until the next call on oClient, or NULL
+if not found or on connection failure. */
+const char *SymClient_get(SymClient_T oClient, const char *pcKey);
+
+
+/* Applies function pfApply to every binding on the server whose key starts
+with pcPrefix. Sends the request and waits for all responses.
+
+Asserts: if oClient, pcPrefix and pfApply are not NULL at runtime.
+
+Parameters:
+* oClient: a SymClient_T type
+* pcPrefix: a character array. Must be null terminated.
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of bindings, or -1 on connection failure. */
+int SymClient_prefix(SymClient_T oClient, const char *pcPrefix,
+        void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
@@ -0,0 +1,296 @@
+/* Library for collecting symbols from many threads into Symbol tables.
+
+Every thread has one sorted table per partition. A key always goes to the
+same partition, so the tables of a partition can be merged without looking
+at the other partitions. The tables of a partition are merged pairwise, as
+a tree, and each merge is a single pass over two sorted tables. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "symcollect.h"
+
+#define HASH_MULTIPLIER 65599
+
+
+/* Struct that represents a collector. The table of thread t for partition
+p is tables[t * uiParts + p]. After the merge, the merged table of
+partition p is tables[p]. uiNext is the next partition to be merged by a
+worker and is updated atomically. */
+struct SymCollect {
+    unsigned int uiThreads;
+    unsigned int uiParts;
+    int iMerged;
+    SymTable_T *tables;
+    unsigned int uiNext;
+    void *(*pfResolve)(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra);
+    const void *pvExtra;
+};
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymCollect_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Returns the partition of pcKey */
+static unsigned int SymCollect_part(struct SymCollect *collect,
+    const char *pcKey) {
+    unsigned int hash;
+
+    hash = SymCollect_hash(pcKey);
+
+    return (hash ^ (hash >> 16)) % collect->uiParts;
+}
+
+
+/* Merges the tables of all threads for partition part into the table of
+thread 0 and frees the others. Tables are merged in pairs (0 and 1, 2 and
+3, ...), then the results in pairs, until one table is left. */
+static void SymCollect_mergePart(struct SymCollect *collect, unsigned int part) {
+    SymTable_T *dest, *src;
+    unsigned int step, t;
+
+    for (step = 1; step < collect->uiThreads; step *= 2) {
+        for (t = 0; t + step < collect->uiThreads; t += 2 * step) {
+            dest = &collect->tables[t * collect->uiParts + part];
+            src = &collect->tables[(t + step) * collect->uiParts + part];
+            SymTable_merge(*dest, *src, collect->pfResolve, collect->pvExtra);
+            SymTable_free(*src);
+            *src = NULL;
+        }
+    }
+}
+
+
+/* Function run by the merge workers: merges partitions until there are no
+more left */
+static void *SymCollect_worker(void *pvCollect) {
+    struct SymCollect *collect;
+    unsigned int part;
+
+    collect = pvCollect;
+    while(1) {
+        part = __atomic_fetch_add(&collect->uiNext, 1, __ATOMIC_RELAXED);
+        if (part >= collect->uiParts) {
+            break;
+        }
+        SymCollect_mergePart(collect, part);
+    }
+
+    return NULL;
+}
+
+
+/* Creates a SymCollect struct with no bindings for uiThreads threads and
+uiParts partitions.
+
+Asserts:
+1) if uiThreads and uiParts are > 0 at runtime.
+2) if memory was allocated succesfully for oCollect at runtime.
+
+Parameters:
+* uiThreads: number of threads that insert bindings
+* uiParts: number of partitions */
+SymCollect_T SymCollect_new(unsigned int uiThreads, unsigned int uiParts) {
+    struct SymCollect *collect;
+    unsigned int i;
+
+    assert(uiThreads > 0);
+    assert(uiParts > 0);
+
+    collect = malloc(sizeof(struct SymCollect));
+    assert(collect);
+    collect->uiThreads = uiThreads;
+    collect->uiParts = uiParts;
+    collect->iMerged = 0;
+    collect->tables = malloc(uiThreads * uiParts * sizeof(SymTable_T));
+    assert(collect->tables);
+    for (i = 0; i < uiThreads * uiParts; i++) {
+        collect->tables[i] = SymTable_newSorted();
+    }
+
+    return (SymCollect_T) collect;
+}
+
+
+/* Frees all memory used by oCollect.
+
+Parameters:
+* oCollect: a SymCollect_T type */
+void SymCollect_free(SymCollect_T oCollect) {
+    struct SymCollect *collect;
+    unsigned int i;
+
+    collect = oCollect;
+    if (!collect) {
+        return;
+    }
+    for (i = 0; i < collect->uiThreads * collect->uiParts; i++) {
+        SymTable_free(collect->tables[i]);
+    }
+    free(collect->tables);
+    free(collect);
+
+    return;
+}
+
+
+/* Creates a new binding from a given pcKey and pvValue in the tables of
+thread uiThread. Each thread must use its own uiThread, then calls from
+different threads need no synchronization. Must not be called after
+SymCollect_merge.
+
+Asserts:
+1) if oCollect and pcKey are not NULL and uiThread is valid at runtime.
+2) if oCollect has not been merged at runtime.
+3) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* uiThread: index of the calling thread, from 0 to uiThreads - 1
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if thread uiThread
+already has a binding with key equal to pcKey. */
+int SymCollect_put(SymCollect_T oCollect, unsigned int uiThread,
+    const char *pcKey, const void *pvValue) {
+    struct SymCollect *collect;
+
+    collect = oCollect;
+    assert(collect);
+    assert(pcKey);
+    assert(uiThread < collect->uiThreads);
+    assert(!collect->iMerged);
+
+    return SymTable_put(collect->tables[uiThread * collect->uiParts +
+                                        SymCollect_part(collect, pcKey)],
+                        pcKey, pvValue);
+}
+
+
+/* Merges the bindings of all threads using uiWorkers threads, each one
+merging whole partitions. When more than one thread has a binding with the
+same key, the value of the merged binding is the result of pfResolve
+called with the value of the lower numbered thread as pvOld and the value
+of the higher numbered thread as pvNew. If pfResolve is NULL the value of
+the lowest numbered thread is kept.
+
+Asserts:
+1) if oCollect is not NULL and uiWorkers is > 0 at runtime.
+2) if oCollect has not been merged at runtime.
+3) if the worker threads were created succesfully at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* uiWorkers: number of threads that merge partitions
+* pfResolve: function that resolves a conflict, or NULL
+* pvExtra: a pointer to any value. Used by pfResolve.
+
+Returns: the number of merged bindings. */
+unsigned int SymCollect_merge(SymCollect_T oCollect, unsigned int uiWorkers,
+    void *(*pfResolve)(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra),
+    const void *pvExtra) {
+    struct SymCollect *collect;
+    pthread_t *threads;
+    unsigned int i, length;
+    int error;
+
+    collect = oCollect;
+    assert(collect);
+    assert(uiWorkers > 0);
+    assert(!collect->iMerged);
+
+    collect->pfResolve = pfResolve;
+    collect->pvExtra = pvExtra;
+    collect->uiNext = 0;
+    if (uiWorkers > collect->uiParts) {
+        uiWorkers = collect->uiParts;
+    }
+
+    /* the calling thread is one of the workers */
+    threads = malloc(uiWorkers * sizeof(pthread_t));
+    assert(threads);
+    for (i = 1; i < uiWorkers; i++) {
+        error = pthread_create(&threads[i], NULL, SymCollect_worker, collect);
+        assert(!error);
+    }
+    SymCollect_worker(collect);
+    for (i = 1; i < uiWorkers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    collect->iMerged = 1;
+
+    length = 0;
+    for (i = 0; i < collect->uiParts; i++) {
+        length += SymTable_getLength(collect->tables[i]);
+    }
+
+    return length;
+}
+
+
+/* Finds a merged binding with key equal to pcKey.
+
+Asserts:
+1) if oCollect and pcKey are not NULL at runtime.
+2) if oCollect has been merged at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void *SymCollect_get(SymCollect_T oCollect, const char *pcKey) {
+    struct SymCollect *collect;
+
+    collect = oCollect;
+    assert(collect);
+    assert(pcKey);
+    assert(collect->iMerged);
+
+    return SymTable_get(collect->tables[SymCollect_part(collect, pcKey)], pcKey);
+}
+
+
+/* Applies function pfApply to every merged binding, one partition after
+the other.
+
+Asserts:
+1) if oCollect and pfApply are not NULL at runtime.
+2) if oCollect has been merged at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymCollect_map(SymCollect_T oCollect,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymCollect *collect;
+    unsigned int i;
+
+    collect = oCollect;
+    assert(collect);
+    assert(pfApply);
+    assert(collect->iMerged);
+
+    for (i = 0; i < collect->uiParts; i++) {
+        SymTable_map(collect->tables[i], pfApply, pvExtra);
+    }
+}
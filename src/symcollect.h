@@ -0,0 +1,111 @@
+/* Library for collecting symbols from many threads into Symbol tables.
+
+Every thread inserts into its own tables, one per partition of the hash
+space, without locks. SymCollect_merge then combines the tables of each
+partition across threads, with the partitions merged in parallel. */
+
+#ifndef SYMCOLLECT_INCLUDE
+#define SYMCOLLECT_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymCollect_T;
+
+
+/* Creates a SymCollect struct with no bindings for uiThreads threads and
+uiParts partitions.
+
+Asserts:
+1) if uiThreads and uiParts are > 0 at runtime.
+2) if memory was allocated succesfully for oCollect at runtime.
+
+Parameters:
+* uiThreads: number of threads that insert bindings
+* uiParts: number of partitions */
+SymCollect_T SymCollect_new(unsigned int uiThreads, unsigned int uiParts);
+
+
+/* Frees all memory used by oCollect.
+
+Parameters:
+* oCollect: a SymCollect_T type */
+void SymCollect_free(SymCollect_T oCollect);
+
+
+/* Creates a new binding from a given pcKey and pvValue in the tables of
+thread uiThread. Each thread must use its own uiThread, then calls from
+different threads need no synchronization. Must not be called after
+SymCollect_merge.
+
+Asserts:
+1) if oCollect and pcKey are not NULL and uiThread is valid at runtime.
+2) if oCollect has not been merged at runtime.
+3) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* uiThread: index of the calling thread, from 0 to uiThreads - 1
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if thread uiThread
+already has a binding with key equal to pcKey. */
+int SymCollect_put(SymCollect_T oCollect, unsigned int uiThread,
+        const char *pcKey, const void *pvValue);
+
+
+/* Merges the bindings of all threads using uiWorkers threads, each one
+merging whole partitions. When more than one thread has a binding with the
+same key, the value of the merged binding is the result of pfResolve
+called with the value of the lower numbered thread as pvOld and the value
+of the higher numbered thread as pvNew. If pfResolve is NULL the value of
+the lowest numbered thread is kept.
+
+Asserts:
+1) if oCollect is not NULL and uiWorkers is > 0 at runtime.
+2) if oCollect has not been merged at runtime.
+3) if the worker threads were created succesfully at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* uiWorkers: number of threads that merge partitions
+* pfResolve: function that resolves a conflict, or NULL
+* pvExtra: a pointer to any value. Used by pfResolve.
+
+Returns: the number of merged bindings. */
+unsigned int SymCollect_merge(SymCollect_T oCollect, unsigned int uiWorkers,
+        void *(*pfResolve)(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Finds a merged binding with key equal to pcKey.
+
+Asserts:
+1) if oCollect and pcKey are not NULL at runtime.
+2) if oCollect has been merged at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void *SymCollect_get(SymCollect_T oCollect, const char *pcKey);
+
+
+/* Applies function pfApply to every merged binding, one partition after
+the other.
+
+Asserts:
+1) if oCollect and pfApply are not NULL at runtime.
+2) if oCollect has been merged at runtime.
+
+Parameters:
+* oCollect: a SymCollect_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymCollect_map(SymCollect_T oCollect,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
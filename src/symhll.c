@@ -0,0 +1,201 @@
+/* Library for estimating the number of distinct keys in a stream of keys
+(HyperLogLog).
+
+The hash of a key selects one of the 2^uiBits registers with its first
+uiBits bits. The register keeps the largest rank seen, where the rank is
+the position of the first 1 bit in the rest of the hash. The estimate is
+the harmonic mean of 2^rank over the registers, scaled. Small estimates,
+when many registers are still 0, are replaced by linear counting. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "symhll.h"
+
+#define HASH_MULTIPLIER 65599
+#define HASH_BITS 32
+
+
+/* Struct that represents an estimator: 2^uiBits registers of one byte */
+struct SymHll {
+    unsigned int uiBits;
+    unsigned int uiCount;
+    unsigned char *registers;
+};
+
+
+/* Returns a hash code for pcKey. The multiplicative hash of the tables
+is mixed so that all of its bits depend on every character. */
+static unsigned int SymHll_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+
+    return hash & 0xffffffffU;
+}
+
+
+/* Creates a SymHll struct with 2^uiBits registers and no keys. The
+standard error of the estimate is about 1.04 / sqrt(2^uiBits): 1.6% for
+12 bits, which use 4 KB.
+
+Asserts:
+1) if uiBits is between 4 and 16 at runtime.
+2) if memory was allocated succesfully for oHll at runtime.
+
+Parameters:
+* uiBits: number of bits of the register index */
+SymHll_T SymHll_new(unsigned int uiBits) {
+    struct SymHll *hll;
+
+    assert(uiBits >= 4 && uiBits <= 16);
+
+    hll = malloc(sizeof(struct SymHll));
+    assert(hll);
+    hll->uiBits = uiBits;
+    hll->uiCount = 1U << uiBits;
+    hll->registers = calloc(hll->uiCount, 1);
+    assert(hll->registers);
+
+    return (SymHll_T) hll;
+}
+
+
+/* Frees all memory used by oHll.
+
+Parameters:
+* oHll: a SymHll_T type */
+void SymHll_free(SymHll_T oHll) {
+    struct SymHll *hll;
+
+    hll = oHll;
+    if (!hll) {
+        return;
+    }
+    free(hll->registers);
+    free(hll);
+    return;
+}
+
+
+/* Adds pcKey to oHll. Adding a key more than once does not change the
+estimate.
+
+Asserts: if oHll and pcKey are not NULL at runtime.
+
+Parameters:
+* oHll: a SymHll_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymHll_add(SymHll_T oHll, const char *pcKey) {
+    struct SymHll *hll;
+    unsigned int hash, index, rank;
+
+    hll = oHll;
+    assert(hll);
+    assert(pcKey);
+
+    hash = SymHll_hash(pcKey);
+    index = hash >> (HASH_BITS - hll->uiBits);
+
+    /* rank of the remaining bits, HASH_BITS - uiBits + 1 if all are 0 */
+    hash = (hash << hll->uiBits) & 0xffffffffU;
+    rank = 1;
+    while(rank <= HASH_BITS - hll->uiBits && !(hash & 0x80000000U)) {
+        hash <<= 1;
+        rank++;
+    }
+    if (rank > hll->registers[index]) {
+        hll->registers[index] = (unsigned char) rank;
+    }
+    return;
+}
+
+
+/* Adds the keys of oSrc to oDest, as if every key added to oSrc had been
+added to oDest.
+
+Asserts: if oDest and oSrc are not NULL and have the same number of
+registers at runtime.
+
+Parameters:
+* oDest: a SymHll_T type
+* oSrc: a SymHll_T type */
+void SymHll_merge(SymHll_T oDest, SymHll_T oSrc) {
+    struct SymHll *dest, *src;
+    unsigned int i;
+
+    dest = oDest;
+    src = oSrc;
+    assert(dest && src);
+    assert(dest->uiBits == src->uiBits);
+
+    for (i = 0; i < dest->uiCount; i++) {
+        if (src->registers[i] > dest->registers[i]) {
+            dest->registers[i] = src->registers[i];
+        }
+    }
+    return;
+}
+
+
+/* Returns the estimated number of distinct keys added to oHll.
+
+Asserts: if oHll is not NULL at runtime.
+
+Parameters:
+* oHll: a SymHll_T type */
+unsigned long SymHll_estimate(SymHll_T oHll) {
+    struct SymHll *hll;
+    double sum, m, alpha, estimate;
+    unsigned int i, zeros;
+
+    hll = oHll;
+    assert(hll);
+
+    sum = 0.0;
+    zeros = 0;
+    for (i = 0; i < hll->uiCount; i++) {
+        sum += ldexp(1.0, -hll->registers[i]);
+        if (!hll->registers[i]) {
+            zeros++;
+        }
+    }
+
+    m = hll->uiCount;
+    if (hll->uiCount == 16) {
+        alpha = 0.673;
+    }
+    else if (hll->uiCount == 32) {
+        alpha = 0.697;
+    }
+    else if (hll->uiCount == 64) {
+        alpha = 0.709;
+    }
+    else {
+        alpha = 0.7213 / (1.0 + 1.079 / m);
+    }
+    estimate = alpha * m * m / sum;
+
+    /* linear counting while many registers are empty */
+    if (estimate <= 2.5 * m && zeros) {
+        estimate = m * log(m / zeros);
+    }
+
+    /* correction for hash collisions near 2^32 keys */
+    else if (estimate > 4294967296.0 / 30.0 && estimate < 4294967296.0) {
+        estimate = -4294967296.0 * log(1.0 - estimate / 4294967296.0);
+    }
+
+    return (unsigned long) (estimate + 0.5);
+}
@@ -0,0 +1,64 @@
+/* Library for estimating the number of distinct keys in a stream of keys
+(HyperLogLog) */
+
+#ifndef SYMHLL_INCLUDE
+#define SYMHLL_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymHll_T;
+
+
+/* Creates a SymHll struct with 2^uiBits registers and no keys. The
+standard error of the estimate is about 1.04 / sqrt(2^uiBits): 1.6% for
+12 bits, which use 4 KB.
+
+Asserts:
+1) if uiBits is between 4 and 16 at runtime.
+2) if memory was allocated succesfully for oHll at runtime.
+
+Parameters:
+* uiBits: number of bits of the register index */
+SymHll_T SymHll_new(unsigned int uiBits);
+
+
+/* Frees all memory used by oHll.
+
+Parameters:
+* oHll: a SymHll_T type */
+void SymHll_free(SymHll_T oHll);
+
+
+/* Adds pcKey to oHll. Adding a key more than once does not change the
+estimate.
+
+Asserts: if oHll and pcKey are not NULL at runtime.
+
+Parameters:
+* oHll: a SymHll_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymHll_add(SymHll_T oHll, const char *pcKey);
+
+
+/* Adds the keys of oSrc to oDest, as if every key added to oSrc had been
+added to oDest.
+
+Asserts: if oDest and oSrc are not NULL and have the same number of
+registers at runtime.
+
+Parameters:
+* oDest: a SymHll_T type
+* oSrc: a SymHll_T type */
+void SymHll_merge(SymHll_T oDest, SymHll_T oSrc);
+
+
+/* Returns the estimated number of distinct keys added to oHll.
+
+Asserts: if oHll is not NULL at runtime.
+
+Parameters:
+* oHll: a SymHll_T type */
+unsigned long SymHll_estimate(SymHll_T oHll);
+
+
+#endif
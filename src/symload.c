@@ -0,0 +1,169 @@
+/* Load generator for the Symbol table server (symtabd) */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <time.h>
+#include "symclient.h"
+
+#define GET_PERCENT 80  /* percentage of GET requests, the rest are PUT/DEL */
+#define KEY_LEN 16
+
+double now(void);
+int compare_double(const void *a, const void *b);
+int run_batch(SymClient_T oClient, int depth, int num_keys);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 5.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: path of the Unix domain socket of the server
+    3rd argument: number of requests to send
+    4th argument: number of distinct keys
+    5th argument: number of requests sent per batch (pipeline depth) */
+int main(int argc, char **argv) {
+    SymClient_T oClient;
+    int i, num_requests, num_keys, depth, num_batches, sent, ok;
+    char key[KEY_LEN];
+    double start, end, batch_start, *latencies;
+
+    if (argc != 5) {
+        printf("Usage: %s {SOCKET_PATH} {NUM_REQUESTS} {NUM_KEYS} {DEPTH}\n", argv[0]);
+        return 1;
+    }
+    num_requests = atoi(argv[2]);
+    num_keys = atoi(argv[3]);
+    depth = atoi(argv[4]);
+    if (num_requests <= 0 || num_keys <= 0 || depth <= 0) {
+        printf("NUM_REQUESTS, NUM_KEYS and DEPTH must be > 0\n");
+        return 1;
+    }
+    srand(getpid());
+
+    oClient = SymClient_connect(argv[1]);
+    if (!oClient) {
+        perror("symload");
+        return 1;
+    }
+
+    /* insert all keys so that most GET requests find a binding */
+    printf("++> Inserting %d keys...", num_keys);
+    for (i = 0; i < num_keys; i++) {
+        sprintf(key, "k%d", i);
+        SymClient_send(oClient, "PUT", key, "1");
+    }
+    ok = SymClient_flush(oClient);
+    for (i = 0; ok && i < num_keys; i++) {
+        ok = SymClient_recv(oClient) != NULL;
+    }
+    if (!ok) {
+        printf("FAILED\n");
+        return 1;
+    }
+    printf("DONE\n");
+
+    num_batches = (num_requests + depth - 1) / depth;
+    latencies = malloc(num_batches * sizeof(double));
+    assert(latencies);
+
+    printf("++> Sending %d requests in batches of %d...", num_requests, depth);
+    start = now();
+    for (i = 0, sent = 0; sent < num_requests; i++) {
+        batch_start = now();
+        if (!run_batch(oClient, num_requests - sent < depth ? num_requests - sent : depth,
+                       num_keys)) {
+            printf("FAILED\n");
+            return 1;
+        }
+        latencies[i] = now() - batch_start;
+        sent += depth;
+    }
+    end = now();
+    printf("DONE\n");
+
+    /* every request of a batch waits until the whole batch is answered */
+    qsort(latencies, num_batches, sizeof(double), compare_double);
+    printf("++> Throughput: %.0f requests/s\n", num_requests / (end - start));
+    printf("++> Batch latency (us): p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+           latencies[num_batches / 2] * 1e6,
+           latencies[num_batches * 9 / 10] * 1e6,
+           latencies[num_batches * 99 / 100] * 1e6,
+           latencies[num_batches - 1] * 1e6);
+
+    free(latencies);
+    SymClient_close(oClient);
+
+    return 0;
+}
+
+
+/* now
+
+Returns: the time in seconds from a monotonic clock. */
+double now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* compare_double
+
+Function used by qsort() to sort latencies. */
+int compare_double(const void *a, const void *b) {
+    double x, y;
+
+    x = *(const double *) a;
+    y = *(const double *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+
+/* run_batch
+
+Sends depth random requests with one write and waits for all responses.
+
+Parameters:
+oClient: a SymClient_T type.
+depth: number of requests.
+num_keys: number of distinct keys.
+
+Returns: 1 on success, 0 if the connection failed. */
+int run_batch(SymClient_T oClient, int depth, int num_keys) {
+    char key[KEY_LEN];
+    int j, action;
+
+    for (j = 0; j < depth; j++) {
+        sprintf(key, "k%d", rand() % num_keys);
+        action = rand() % 100;
+        if (action < GET_PERCENT) {
+            SymClient_send(oClient, "GET", key, NULL);
+        }
+        else if (action % 2) {
+            SymClient_send(oClient, "PUT", key, "1");
+        }
+        else {
+            SymClient_send(oClient, "DEL", key, NULL);
+        }
+    }
+    if (!SymClient_flush(oClient)) {
+        return 0;
+    }
+    for (j = 0; j < depth; j++) {
+        if (!SymClient_recv(oClient)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
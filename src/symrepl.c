@@ -0,0 +1,419 @@
+/* Library for shipping the changes of a Symbol table to other processes.
+
+A frame is a SYMREPL_HEADER byte header followed by the compressed
+changes. The header has five 4 byte big-endian numbers: sequence number,
+creation time, number of changes, raw length and compressed length.
+
+Every change is a byte ('P' for put, 'D' for remove) followed by the null
+terminated key and, for a put, the null terminated value. The changes are
+compressed with a small LZ77 coder: a control byte c < 128 is followed by
+c + 1 literal bytes, a control byte c >= 128 is followed by a 2 byte offset
+and copies (c - 128) + MIN_MATCH bytes from that offset back. Keys in a
+log usually share long prefixes, which this coder removes cheaply. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include "symrepl.h"
+
+#define MIN_MATCH 4
+#define MAX_MATCH (127 + MIN_MATCH)
+#define MAX_LITERALS 128
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+
+
+/* Struct that represents a log as a buffer of encoded changes. The frame
+buffer holds the last frame returned by SymRepl_frame. */
+struct SymRepl {
+    unsigned int uiSize;
+    unsigned char *data;
+    size_t len, cap;
+    unsigned char *frame;
+    size_t frame_cap;
+};
+
+
+/* Appends len bytes of bytes to the changes of log */
+static void SymRepl_append(struct SymRepl *log, const void *bytes, size_t len) {
+    while(log->len + len > log->cap) {
+        log->cap *= 2;
+        log->data = realloc(log->data, log->cap);
+        assert(log->data);
+    }
+    memcpy(log->data + log->len, bytes, len);
+    log->len += len;
+}
+
+
+/* Stores the lowest 32 bits of value at dst, most significant byte first */
+static void SymRepl_put32(unsigned char *dst, unsigned long value) {
+    dst[0] = (value >> 24) & 0xff;
+    dst[1] = (value >> 16) & 0xff;
+    dst[2] = (value >> 8) & 0xff;
+    dst[3] = value & 0xff;
+}
+
+
+/* Returns the 32 bit number stored at src by SymRepl_put32 */
+static unsigned long SymRepl_get32(const unsigned char *src) {
+    return ((unsigned long) src[0] << 24) | ((unsigned long) src[1] << 16)
+           | ((unsigned long) src[2] << 8) | (unsigned long) src[3];
+}
+
+
+/* Copies the literal bytes src[0..count) to dst in runs of at most
+MAX_LITERALS bytes.
+
+Returns: the number of bytes written */
+static size_t SymRepl_literals(const unsigned char *src, size_t count,
+    unsigned char *dst) {
+    size_t written, run;
+
+    written = 0;
+    while(count) {
+        run = count < MAX_LITERALS ? count : MAX_LITERALS;
+        dst[written++] = (unsigned char) (run - 1);
+        memcpy(dst + written, src, run);
+        written += run;
+        src += run;
+        count -= run;
+    }
+
+    return written;
+}
+
+
+/* Compresses the len bytes of src into dst. dst must have room for
+len + len / MAX_LITERALS + 1 bytes.
+
+Returns: the number of bytes written */
+static size_t SymRepl_compress(const unsigned char *src, size_t len,
+    unsigned char *dst) {
+    long table[1 << HASH_BITS];
+    size_t i, start, written, match;
+    unsigned long h;
+    long cand;
+
+    for (i = 0; i < (1 << HASH_BITS); i++) {
+        table[i] = -1;
+    }
+
+    i = 0;
+    start = 0;
+    written = 0;
+    while(i + MIN_MATCH <= len) {
+
+        /* find the last position with the same 4 bytes */
+        h = SymRepl_get32(src + i) * 2654435761UL;
+        h = (h & 0xffffffffUL) >> (32 - HASH_BITS);
+        cand = table[h];
+        table[h] = (long) i;
+        if (cand < 0 || i - cand > MAX_OFFSET
+            || memcmp(src + cand, src + i, MIN_MATCH)) {
+            i++;
+            continue;
+        }
+
+        match = MIN_MATCH;
+        while(i + match < len && match < MAX_MATCH
+              && src[cand + match] == src[i + match]) {
+            match++;
+        }
+        written += SymRepl_literals(src + start, i - start, dst + written);
+        dst[written++] = (unsigned char) (128 + match - MIN_MATCH);
+        dst[written++] = ((i - cand) >> 8) & 0xff;
+        dst[written++] = (i - cand) & 0xff;
+        i += match;
+        start = i;
+    }
+    written += SymRepl_literals(src + start, len - start, dst + written);
+
+    return written;
+}
+
+
+/* Decompresses the len bytes of src into the raw_len bytes of dst.
+
+Returns: 1 on success, 0 if src is corrupt */
+static int SymRepl_decompress(const unsigned char *src, size_t len,
+    unsigned char *dst, size_t raw_len) {
+    size_t i, written, count, offset;
+
+    i = 0;
+    written = 0;
+    while(i < len) {
+        if (src[i] < 128) {
+            count = src[i] + 1;
+            if (i + 1 + count > len || written + count > raw_len) {
+                return 0;
+            }
+            memcpy(dst + written, src + i + 1, count);
+            i += 1 + count;
+        }
+        else {
+            count = src[i] - 128 + MIN_MATCH;
+            if (i + 3 > len) {
+                return 0;
+            }
+            offset = ((size_t) src[i + 1] << 8) | src[i + 2];
+            if (!offset || offset > written || written + count > raw_len) {
+                return 0;
+            }
+
+            /* byte by byte: the match may overlap the bytes it produces */
+            for (; count; count--, written++) {
+                dst[written] = dst[written - offset];
+            }
+            i += 3;
+        }
+        written += count;
+    }
+
+    return written == raw_len;
+}
+
+
+/* Creates a SymRepl struct with an empty log.
+
+Asserts: if memory was allocated succesfully for oLog at runtime. */
+SymRepl_T SymRepl_new(void) {
+    struct SymRepl *log;
+
+    log = malloc(sizeof(struct SymRepl));
+    assert(log);
+    log->uiSize = 0U;
+    log->len = 0;
+    log->cap = 4096;
+    log->data = malloc(log->cap);
+    assert(log->data);
+    log->frame = NULL;
+    log->frame_cap = 0;
+
+    return (SymRepl_T) log;
+}
+
+
+/* Frees all memory used by oLog.
+
+Parameters:
+* oLog: a SymRepl_T type */
+void SymRepl_free(SymRepl_T oLog) {
+    struct SymRepl *log;
+
+    log = oLog;
+    if (!log) {
+        return;
+    }
+    free(log->data);
+    free(log->frame);
+    free(log);
+
+    return;
+}
+
+
+/* Returns the number of changes in oLog.
+
+Asserts: if oLog is not NULL at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type */
+unsigned int SymRepl_getLength(SymRepl_T oLog) {
+    struct SymRepl *log;
+
+    log = oLog;
+    assert(log);
+
+    return log->uiSize;
+}
+
+
+/* Appends a put of (pcKey, pcValue) to oLog.
+
+Asserts:
+1) if oLog, pcKey and pcValue are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* pcKey: a character array (key). Must be null terminated.
+* pcValue: a character array (value). Must be null terminated. */
+void SymRepl_put(SymRepl_T oLog, const char *pcKey, const char *pcValue) {
+    struct SymRepl *log;
+
+    log = oLog;
+    assert(log);
+    assert(pcKey);
+    assert(pcValue);
+
+    SymRepl_append(log, "P", 1);
+    SymRepl_append(log, pcKey, strlen(pcKey) + 1);
+    SymRepl_append(log, pcValue, strlen(pcValue) + 1);
+    log->uiSize += 1;
+}
+
+
+/* Appends a removal of pcKey to oLog.
+
+Asserts:
+1) if oLog and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymRepl_remove(SymRepl_T oLog, const char *pcKey) {
+    struct SymRepl *log;
+
+    log = oLog;
+    assert(log);
+    assert(pcKey);
+
+    SymRepl_append(log, "D", 1);
+    SymRepl_append(log, pcKey, strlen(pcKey) + 1);
+    log->uiSize += 1;
+}
+
+
+/* Encodes all changes of oLog as one compressed frame and empties oLog.
+
+Asserts:
+1) if oLog and puiLen are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* ulSeq: sequence number of the last change in oLog
+* puiLen: set to the length of the frame
+
+Returns: the frame. It is valid until the next call on oLog. */
+const char *SymRepl_frame(SymRepl_T oLog, unsigned long ulSeq, size_t *puiLen) {
+    struct SymRepl *log;
+    size_t needed, comp_len;
+
+    log = oLog;
+    assert(log);
+    assert(puiLen);
+
+    needed = SYMREPL_HEADER + log->len + log->len / MAX_LITERALS + 1;
+    if (needed > log->frame_cap) {
+        log->frame_cap = needed;
+        log->frame = realloc(log->frame, log->frame_cap);
+        assert(log->frame);
+    }
+    comp_len = SymRepl_compress(log->data, log->len, log->frame + SYMREPL_HEADER);
+
+    SymRepl_put32(log->frame, ulSeq);
+    SymRepl_put32(log->frame + 4, SymRepl_clock());
+    SymRepl_put32(log->frame + 8, log->uiSize);
+    SymRepl_put32(log->frame + 12, log->len);
+    SymRepl_put32(log->frame + 16, comp_len);
+
+    log->uiSize = 0U;
+    log->len = 0;
+    *puiLen = SYMREPL_HEADER + comp_len;
+
+    return (const char *) log->frame;
+}
+
+
+/* Decodes the frame at the start of pcData and calls pfPut or pfRemove for
+every change in it, in order.
+
+Asserts: if pcData, pfPut, pfRemove, pulSeq and pulTime are not NULL at
+runtime.
+
+Parameters:
+* pcData: received bytes
+* uiLen: number of received bytes
+* pfPut: function called for every put
+* pfRemove: function called for every removal
+* pvExtra: a pointer to any value. Used by pfPut and pfRemove.
+* pulSeq: set to the sequence number of the frame
+* pulTime: set to the creation time of the frame (see SymRepl_clock)
+
+Returns: the length of the frame, 0 if pcData does not contain a whole
+frame yet, or -1 if the frame is corrupt. */
+long SymRepl_apply(const char *pcData, size_t uiLen,
+    void (*pfPut)(const char *pcKey, const char *pcValue, void *pvExtra),
+    void (*pfRemove)(const char *pcKey, void *pvExtra),
+    const void *pvExtra, unsigned long *pulSeq, unsigned long *pulTime) {
+    const unsigned char *header;
+    unsigned char *raw;
+    char *ptr, *end, *key;
+    unsigned long count, raw_len, comp_len;
+
+    assert(pcData);
+    assert(pfPut);
+    assert(pfRemove);
+    assert(pulSeq);
+    assert(pulTime);
+
+    if (uiLen < SYMREPL_HEADER) {
+        return 0;
+    }
+    header = (const unsigned char *) pcData;
+    count = SymRepl_get32(header + 8);
+    raw_len = SymRepl_get32(header + 12);
+    comp_len = SymRepl_get32(header + 16);
+    if (uiLen < SYMREPL_HEADER + comp_len) {
+        return 0;
+    }
+
+    raw = malloc(raw_len + 1);
+    assert(raw);
+    if (!SymRepl_decompress(header + SYMREPL_HEADER, comp_len, raw, raw_len)) {
+        free(raw);
+        return -1;
+    }
+
+    /* the last change must be null terminated: a terminator after the raw
+    bytes guarantees that the string functions stop inside the buffer */
+    raw[raw_len] = '\0';
+    ptr = (char *) raw;
+    end = ptr + raw_len;
+    for (; count && ptr < end; count--) {
+        key = ptr + 1;
+        if (*ptr == 'P') {
+            ptr = key + strlen(key) + 1;
+            if (ptr >= end) {
+                break;
+            }
+            pfPut(key, ptr, (void *) pvExtra);
+            ptr += strlen(ptr) + 1;
+        }
+        else if (*ptr == 'D') {
+            pfRemove(key, (void *) pvExtra);
+            ptr = key + strlen(key) + 1;
+        }
+        else {
+            break;
+        }
+    }
+    free(raw);
+    if (count) {
+        return -1;
+    }
+
+    *pulSeq = SymRepl_get32(header);
+    *pulTime = SymRepl_get32(header + 4);
+
+    return (long) (SYMREPL_HEADER + comp_len);
+}
+
+
+/* Returns the current time in microseconds, modulo 2^32. The difference of
+two times is correct if they are less than 71 minutes apart. */
+unsigned long SymRepl_clock(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return ((unsigned long) ts.tv_sec * 1000000UL
+            + (unsigned long) ts.tv_nsec / 1000UL) & 0xffffffffUL;
+}
@@ -0,0 +1,108 @@
+/* Library for shipping the changes of a Symbol table to other processes.
+
+The changes (puts and removes) are collected in a log and encoded as
+compressed frames. Every frame carries the sequence number of its last
+change and the time it was created, so that the receiver can report how far
+behind it is. */
+
+#ifndef SYMREPL_INCLUDE
+#define SYMREPL_INCLUDE
+
+#include <stdio.h>
+
+#define SYMREPL_HEADER 20   /* bytes in the header of a frame */
+
+typedef void* SymRepl_T;
+
+
+/* Creates a SymRepl struct with an empty log.
+
+Asserts: if memory was allocated succesfully for oLog at runtime. */
+SymRepl_T SymRepl_new(void);
+
+
+/* Frees all memory used by oLog.
+
+Parameters:
+* oLog: a SymRepl_T type */
+void SymRepl_free(SymRepl_T oLog);
+
+
+/* Returns the number of changes in oLog.
+
+Asserts: if oLog is not NULL at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type */
+unsigned int SymRepl_getLength(SymRepl_T oLog);
+
+
+/* Appends a put of (pcKey, pcValue) to oLog.
+
+Asserts:
+1) if oLog, pcKey and pcValue are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* pcKey: a character array (key). Must be null terminated.
+* pcValue: a character array (value). Must be null terminated. */
+void SymRepl_put(SymRepl_T oLog, const char *pcKey, const char *pcValue);
+
+
+/* Appends a removal of pcKey to oLog.
+
+Asserts:
+1) if oLog and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymRepl_remove(SymRepl_T oLog, const char *pcKey);
+
+
+/* Encodes all changes of oLog as one compressed frame and empties oLog.
+
+Asserts:
+1) if oLog and puiLen are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oLog: a SymRepl_T type
+* ulSeq: sequence number of the last change in oLog
+* puiLen: set to the length of the frame
+
+Returns: the frame. It is valid until the next call on oLog. */
+const char *SymRepl_frame(SymRepl_T oLog, unsigned long ulSeq, size_t *puiLen);
+
+
+/* Decodes the frame at the start of pcData and calls pfPut or pfRemove for
+every change in it, in order.
+
+Asserts: if pcData, pfPut, pfRemove, pulSeq and pulTime are not NULL at
+runtime.
+
+Parameters:
+* pcData: received bytes
+* uiLen: number of received bytes
+* pfPut: function called for every put
+* pfRemove: function called for every removal
+* pvExtra: a pointer to any value. Used by pfPut and pfRemove.
+* pulSeq: set to the sequence number of the frame
+* pulTime: set to the creation time of the frame (see SymRepl_clock)
+
+Returns: the length of the frame, 0 if pcData does not contain a whole
+frame yet, or -1 if the frame is corrupt. */
+long SymRepl_apply(const char *pcData, size_t uiLen,
+        void (*pfPut)(const char *pcKey, const char *pcValue, void *pvExtra),
+        void (*pfRemove)(const char *pcKey, void *pvExtra),
+        const void *pvExtra, unsigned long *pulSeq, unsigned long *pulTime);
+
+
+/* Returns the current time in microseconds, modulo 2^32. The difference of
+two times is correct if they are less than 71 minutes apart. */
+unsigned long SymRepl_clock(void);
+
+
+#endif
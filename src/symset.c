@@ -0,0 +1,488 @@
+/* Library for creating and using Symbol sets (symbol tables without
+values).
+
+List based implementation. Frozen sets are stored as xor filters. */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include "symset.h"
+
+#define HASH_MULTIPLIER 65599
+#define FILTER_MAX_TRIES 64     /* seeds to try before giving up */
+
+
+/* Struct that represents a key in the symbol set. Each member has the
+hash of its key, a pointer to the next member and the key itself, which
+is stored in the same allocation as the member.
+
+Note: A member owns its key. */
+struct amember {
+    unsigned int hash;
+    struct amember *next;
+    char key[1];
+};
+
+
+/* Struct that represents a symbol set as a list of members */
+struct SymSet {
+    unsigned int uiSize;
+    struct amember *first;
+};
+
+
+/* Struct that represents an xor filter. The filter has 3 blocks of
+uiBlockLength fingerprints. A key is mapped to one fingerprint in each
+block and it is reported as present when the xor of the three equals the
+fingerprint of the key. */
+struct SymSetFilter {
+    unsigned int uiSeed;
+    unsigned int uiBlockLength;
+    unsigned char *fingerprints;
+};
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymSet_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Creates a SymSet struct with no keys.
+
+Asserts: if memory was allocated succesfully for oSymSet at runtime. */
+SymSet_T SymSet_new(void) {
+    struct SymSet *symset;
+
+    symset = malloc(sizeof(struct SymSet));
+    assert(symset);
+    symset->uiSize = 0U;
+    symset->first = NULL;
+
+    return (SymSet_T) symset;
+}
+
+
+/* Frees all memory used by oSymSet.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+void SymSet_free(SymSet_T oSymSet) {
+    struct amember *ptr, *ptr_next;
+    struct SymSet *symset;
+
+    symset = oSymSet;
+    if (!symset) {
+        return;
+    }
+    ptr = symset->first;
+    while(ptr) {
+        ptr_next = ptr->next;
+        free(ptr);
+        ptr = ptr_next;
+    }
+    free(symset);
+
+    return;
+}
+
+
+/* Returns the number of keys in oSymSet.
+
+Asserts: if oSymSet is not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+unsigned int SymSet_getLength(SymSet_T oSymSet) {
+    struct SymSet *symset;
+
+    symset = oSymSet;
+    assert(symset);
+
+    return symset->uiSize;
+}
+
+
+/* Checks whether pcKey is present in oSymSet.
+
+Asserts: if oSymSet and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymSet_contains(SymSet_T oSymSet, const char *pcKey) {
+    struct amember *ptr;
+    struct SymSet *symset;
+    unsigned int hash;
+
+    symset = oSymSet;
+    assert(symset);
+    assert(pcKey);
+
+    hash = SymSet_hash(pcKey);
+    ptr = symset->first;
+    while(ptr) {
+        if (ptr->hash == hash && !strcmp(ptr->key, pcKey)) {
+            return 1;
+        }
+        ptr = ptr->next;
+    }
+
+    return 0;
+}
+
+
+/* Inserts pcKey in oSymSet.
+
+Asserts:
+1) if oSymSet and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey was inserted, 0 if it is already in oSymSet. */
+int SymSet_put(SymSet_T oSymSet, const char *pcKey) {
+    struct amember *new_member;
+    struct SymSet *symset;
+
+    symset = oSymSet;
+    assert(symset);
+    assert(pcKey);
+
+    if (SymSet_contains(symset, pcKey)) {
+        return 0;
+    }
+
+    /* member and key are allocated together */
+    new_member = malloc(offsetof(struct amember, key) + strlen(pcKey) + 1);
+    assert(new_member);
+    strcpy(new_member->key, pcKey);
+    new_member->hash = SymSet_hash(pcKey);
+
+    /* member is inserted first */
+    new_member->next = symset->first;
+    symset->first = new_member;
+
+    symset->uiSize += 1;
+
+    return 1;
+}
+
+
+/* Removes pcKey from oSymSet.
+
+Asserts: if oSymSet and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if pcKey was not found */
+int SymSet_remove(SymSet_T oSymSet, const char *pcKey) {
+    struct amember *ptr, **link;
+    struct SymSet *symset;
+    unsigned int hash;
+
+    symset = oSymSet;
+    assert(symset);
+    assert(pcKey);
+
+    hash = SymSet_hash(pcKey);
+    link = &symset->first;
+    while(*link) {
+        ptr = *link;
+        if (ptr->hash == hash && !strcmp(ptr->key, pcKey)) {
+            *link = ptr->next;
+            symset->uiSize -= 1;
+            free(ptr);
+            return 1;
+        }
+        link = &ptr->next;
+    }
+
+    return 0;
+}
+
+
+/* Applies function pfApply to every key in oSymSet.
+
+Asserts: if oSymSet and pfApply are not NULL at runtime
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymSet_map(SymSet_T oSymSet, void (*pfApply)(const char *pcKey, void *pvExtra),
+    const void *pvExtra) {
+    struct amember *ptr;
+    struct SymSet *symset;
+
+    symset = oSymSet;
+    assert(symset);
+    assert(pfApply);
+
+    ptr = symset->first;
+    while(ptr) {
+        pfApply(ptr->key, (void *) pvExtra);
+        ptr = ptr->next;
+    }
+}
+
+
+/* Mixes the bits of hash with seed. The result is a bijection of
+hash + seed, therefore different hashes give different results. */
+static unsigned int SymSetFilter_mix(unsigned int hash, unsigned int seed) {
+    hash += seed;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+
+    return hash & 0xffffffffU;
+}
+
+
+/* Returns the position in block i (0, 1 or 2) of the mixed hash h */
+static unsigned int SymSetFilter_position(const struct SymSetFilter *filter,
+    unsigned int h, int i) {
+    unsigned int rotated;
+
+    rotated = i ? ((h << (11 * i)) | (h >> (32 - 11 * i))) & 0xffffffffU : h;
+
+    return rotated % filter->uiBlockLength + i * filter->uiBlockLength;
+}
+
+
+/* Returns the 8 bit fingerprint of the mixed hash h */
+static unsigned char SymSetFilter_fingerprint(unsigned int h) {
+    return (unsigned char) ((h ^ (h >> 8) ^ (h >> 16) ^ (h >> 24)) & 0xff);
+}
+
+
+/* Function used by SymSet_map() to collect the hashes of all keys */
+static void SymSetFilter_collect(const char *pcKey, void *pvExtra) {
+    unsigned int **hashes;
+
+    hashes = pvExtra;
+    **hashes = SymSet_hash(pcKey);
+    (*hashes)++;
+}
+
+
+/* Function used by qsort() to sort hashes */
+static int SymSetFilter_cmp(const void *a, const void *b) {
+    unsigned int x, y;
+
+    x = *(const unsigned int *) a;
+    y = *(const unsigned int *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+
+/* Tries to build filter from uiSize distinct hashes using filter->uiSeed.
+
+Returns: 1 on success, 0 if the keys could not be peeled with this seed */
+static int SymSetFilter_build(struct SymSetFilter *filter,
+    const unsigned int *hashes, unsigned int uiSize) {
+    unsigned int cells, i, c, h, top, qlen, idx;
+    unsigned int *count, *xormask, *queue, *stack_h, *stack_c;
+    int k, ok;
+
+    cells = 3 * filter->uiBlockLength;
+    count = calloc(cells, sizeof(unsigned int));
+    xormask = calloc(cells, sizeof(unsigned int));
+    queue = malloc(cells * sizeof(unsigned int));
+    stack_h = malloc((uiSize + 1) * sizeof(unsigned int));
+    stack_c = malloc((uiSize + 1) * sizeof(unsigned int));
+    assert(count && xormask && queue && stack_h && stack_c);
+
+    /* every cell counts the keys mapped to it and xors their hashes */
+    for (i = 0; i < uiSize; i++) {
+        h = SymSetFilter_mix(hashes[i], filter->uiSeed);
+        for (k = 0; k < 3; k++) {
+            idx = SymSetFilter_position(filter, h, k);
+            count[idx]++;
+            xormask[idx] ^= h;
+        }
+    }
+
+    /* peel cells that have a single key until none is left */
+    qlen = 0;
+    for (c = 0; c < cells; c++) {
+        if (count[c] == 1) {
+            queue[qlen++] = c;
+        }
+    }
+    top = 0;
+    while(qlen) {
+        c = queue[--qlen];
+        if (count[c] != 1) {
+            continue;
+        }
+        h = xormask[c];
+        stack_h[top] = h;
+        stack_c[top] = c;
+        top++;
+        for (k = 0; k < 3; k++) {
+            idx = SymSetFilter_position(filter, h, k);
+            count[idx]--;
+            xormask[idx] ^= h;
+            if (count[idx] == 1) {
+                queue[qlen++] = idx;
+            }
+        }
+    }
+
+    /* assign the fingerprints in reverse peeling order, so that each key
+    is the last one to set one of its cells */
+    ok = (top == uiSize);
+    if (ok) {
+        memset(filter->fingerprints, 0, cells);
+        while(top) {
+            top--;
+            h = stack_h[top];
+            filter->fingerprints[stack_c[top]] = SymSetFilter_fingerprint(h)
+                ^ filter->fingerprints[SymSetFilter_position(filter, h, 0)]
+                ^ filter->fingerprints[SymSetFilter_position(filter, h, 1)]
+                ^ filter->fingerprints[SymSetFilter_position(filter, h, 2)];
+        }
+    }
+
+    free(count);
+    free(xormask);
+    free(queue);
+    free(stack_h);
+    free(stack_c);
+
+    return ok;
+}
+
+
+/* Creates a static xor filter from the keys of oSymSet. The filter uses
+about 10 bits per key and does not store the keys: SymSetFilter_contains
+returns 1 for every key of oSymSet and also for about 0.4% of the keys that
+are not in oSymSet. Later changes to oSymSet do not affect the filter.
+
+Asserts:
+1) if oSymSet is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+SymSetFilter_T SymSet_freeze(SymSet_T oSymSet) {
+    struct SymSet *symset;
+    struct SymSetFilter *filter;
+    unsigned int *hashes, *ptr, i, n, tries;
+
+    symset = oSymSet;
+    assert(symset);
+
+    /* keys with equal hashes map to the same cells and can never be
+    peeled, but they also have the same fingerprint: keep one of them */
+    hashes = malloc((symset->uiSize + 1) * sizeof(unsigned int));
+    assert(hashes);
+    ptr = hashes;
+    SymSet_map(symset, SymSetFilter_collect, &ptr);
+    qsort(hashes, symset->uiSize, sizeof(unsigned int), SymSetFilter_cmp);
+    n = 0;
+    for (i = 0; i < symset->uiSize; i++) {
+        if (!n || hashes[n - 1] != hashes[i]) {
+            hashes[n++] = hashes[i];
+        }
+    }
+
+    filter = malloc(sizeof(struct SymSetFilter));
+    assert(filter);
+    filter->uiBlockLength = (32 + n + n / 4) / 3 + 1;
+    filter->fingerprints = malloc(3 * filter->uiBlockLength);
+    assert(filter->fingerprints);
+
+    /* peeling fails with small probability: retry with another seed */
+    for (tries = 0; tries < FILTER_MAX_TRIES; tries++) {
+        filter->uiSeed = 0x9e3779b9U * (tries + 1);
+        if (SymSetFilter_build(filter, hashes, n)) {
+            break;
+        }
+    }
+    assert(tries < FILTER_MAX_TRIES);
+    free(hashes);
+
+    return (SymSetFilter_T) filter;
+}
+
+
+/* Frees all memory used by oFilter.
+
+Parameters:
+* oFilter: a SymSetFilter_T type */
+void SymSetFilter_free(SymSetFilter_T oFilter) {
+    struct SymSetFilter *filter;
+
+    filter = oFilter;
+    if (!filter) {
+        return;
+    }
+    free(filter->fingerprints);
+    free(filter);
+
+    return;
+}
+
+
+/* Checks whether pcKey may be present in oFilter.
+
+Asserts: if oFilter and pcKey are not NULL at runtime.
+
+Parameters:
+* oFilter: a SymSetFilter_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey was in the set the filter was created from (or is a
+false positive), 0 if it was definitely not in the set */
+int SymSetFilter_contains(SymSetFilter_T oFilter, const char *pcKey) {
+    struct SymSetFilter *filter;
+    unsigned int h;
+
+    filter = oFilter;
+    assert(filter);
+    assert(pcKey);
+
+    h = SymSetFilter_mix(SymSet_hash(pcKey), filter->uiSeed);
+
+    return SymSetFilter_fingerprint(h) ==
+           (filter->fingerprints[SymSetFilter_position(filter, h, 0)]
+            ^ filter->fingerprints[SymSetFilter_position(filter, h, 1)]
+            ^ filter->fingerprints[SymSetFilter_position(filter, h, 2)]);
+}
+
+
+/* Returns the number of bytes used by oFilter.
+
+Asserts: if oFilter is not NULL at runtime.
+
+Parameters:
+* oFilter: a SymSetFilter_T type */
+size_t SymSetFilter_getBytes(SymSetFilter_T oFilter) {
+    struct SymSetFilter *filter;
+
+    filter = oFilter;
+    assert(filter);
+
+    return sizeof(struct SymSetFilter) + 3 * filter->uiBlockLength;
+}
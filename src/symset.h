@@ -0,0 +1,129 @@
+/* Library for creating and using Symbol sets (symbol tables without
+values) */
+
+#ifndef SYMSET_INCLUDE
+#define SYMSET_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymSet_T;
+typedef void* SymSetFilter_T;
+
+
+/* Creates a SymSet struct with no keys.
+
+Asserts: if memory was allocated succesfully for oSymSet at runtime. */
+SymSet_T SymSet_new(void);
+
+
+/* Frees all memory used by oSymSet.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+void SymSet_free(SymSet_T oSymSet);
+
+
+/* Returns the number of keys in oSymSet.
+
+Asserts: if oSymSet is not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+unsigned int SymSet_getLength(SymSet_T oSymSet);
+
+
+/* Inserts pcKey in oSymSet.
+
+Asserts:
+1) if oSymSet and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey was inserted, 0 if it is already in oSymSet. */
+int SymSet_put(SymSet_T oSymSet, const char *pcKey);
+
+
+/* Removes pcKey from oSymSet.
+
+Asserts: if oSymSet and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if pcKey was not found */
+int SymSet_remove(SymSet_T oSymSet, const char *pcKey);
+
+
+/* Checks whether pcKey is present in oSymSet.
+
+Asserts: if oSymSet and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymSet_contains(SymSet_T oSymSet, const char *pcKey);
+
+
+/* Applies function pfApply to every key in oSymSet.
+
+Asserts: if oSymSet and pfApply are not NULL at runtime
+
+Parameters:
+* oSymSet: a SymSet_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymSet_map(SymSet_T oSymSet,
+        void (*pfApply)(const char *pcKey, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Creates a static xor filter from the keys of oSymSet. The filter uses
+about 10 bits per key and does not store the keys: SymSetFilter_contains
+returns 1 for every key of oSymSet and also for about 0.4% of the keys that
+are not in oSymSet. Later changes to oSymSet do not affect the filter.
+
+Asserts:
+1) if oSymSet is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymSet: a SymSet_T type */
+SymSetFilter_T SymSet_freeze(SymSet_T oSymSet);
+
+
+/* Frees all memory used by oFilter.
+
+Parameters:
+* oFilter: a SymSetFilter_T type */
+void SymSetFilter_free(SymSetFilter_T oFilter);
+
+
+/* Checks whether pcKey may be present in oFilter.
+
+Asserts: if oFilter and pcKey are not NULL at runtime.
+
+Parameters:
+* oFilter: a SymSetFilter_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if pcKey was in the set the filter was created from (or is a
+false positive), 0 if it was definitely not in the set */
+int SymSetFilter_contains(SymSetFilter_T oFilter, const char *pcKey);
+
+
+/* Returns the number of bytes used by oFilter.
+
+Asserts: if oFilter is not NULL at runtime.
+
+Parameters:
+* oFilter: a SymSetFilter_T type */
+size_t SymSetFilter_getBytes(SymSetFilter_T oFilter);
+
+
+#endif
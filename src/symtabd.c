@@ -0,0 +1,762 @@
+/* Symbol table server.
+
+Serves one symbol table over a Unix domain socket. Requests are lines of
+text (see symclient.h). All complete requests received by one read are
+executed in order and their responses are sent back with one write, so
+clients can pipeline many requests per round trip.
+
+Replication: a follower connects to a primary and sends "SYN". The primary
+answers with a frame that holds all its bindings, and then ships the puts
+and removes it executes, batched into one compressed frame per event loop
+iteration (see symrepl.h). The follower applies the frames to its own
+table and serves read requests. "LAG" returns the number of changes applied
+and the microseconds between the creation of the last frame by the primary
+and its application by the follower. "PRO" promotes a follower to primary. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "symtable.h"
+#include "symrepl.h"
+
+#define MAX_EVENTS 64
+#define BUFSIZE 65536
+#define HEARTBEAT_MS 1000   /* idle primaries ship an empty frame this often */
+
+
+/* Struct that represents a growable byte buffer */
+struct abuf {
+    char *data;
+    size_t len, cap;
+};
+
+
+/* Struct that represents a client connection. replica is 1 for the
+connections that carry frames: from a primary to a follower (next links
+the followers of a primary) or from a follower to its primary. A dropped
+connection is kept until the events of the current epoll_wait have been
+handled, because some of them may still point to it. */
+struct aconn {
+    int fd;
+    int writing;    /* 1 if waiting for the socket to become writable */
+    int replica;
+    int dropped;    /* 1 if the connection is closed at the end of the batch */
+    struct abuf in;
+    struct abuf out;
+    struct aconn *next;
+};
+
+
+/* Struct that represents the state of the server. While there are
+followers, the changes to the table are appended to log until they are
+shipped to them. A new follower starts from a copy of the table, so changes
+made without followers are not logged. */
+struct aserver {
+    SymTable_T table;
+    int follower;               /* 1 if the table is a read-only replica */
+    unsigned long seq;          /* number of changes applied to table */
+    unsigned long delay;        /* microseconds behind the primary */
+    SymRepl_T log;
+    struct aconn *followers;
+    struct aconn *primary;
+    struct aconn *dropped;      /* connections to close after the batch */
+    int efd;                    /* epoll instance of the connections */
+};
+
+
+/* Struct used by SymTable_map() to answer a prefix request */
+struct aprefix {
+    const char *prefix;
+    size_t len;
+    struct abuf *out;
+};
+
+
+static volatile sig_atomic_t stop = 0;
+
+void on_signal(int sig);
+void buf_init(struct abuf *buf);
+void buf_append(struct abuf *buf, const char *data, size_t len);
+void buf_puts(struct abuf *buf, const char *str);
+void free_value(const char *pcKey, void *pvValue, void *pvExtra);
+void append_prefix(const char *pcKey, void *pvValue, void *pvExtra);
+void log_binding(const char *pcKey, void *pvValue, void *pvExtra);
+void apply_put(const char *pcKey, const char *pcValue, void *pvExtra);
+void apply_remove(const char *pcKey, void *pvExtra);
+int table_put(struct aserver *server, const char *key, const char *value);
+int table_remove(struct aserver *server, const char *key);
+void execute(struct aserver *server, struct aconn *conn, char *line);
+int handle_read(struct aserver *server, struct aconn *conn);
+int handle_write(struct aconn *conn);
+void ship(struct aserver *server, int efd);
+void watch(int efd, struct aconn *conn);
+struct aconn *new_conn(int efd, int fd);
+void drop_conn(struct aserver *server, struct aconn *conn);
+void close_conn(struct aserver *server, int efd, struct aconn *conn);
+int listen_socket(const char *path);
+int connect_socket(const char *path);
+
+
+/*  main
+
+Parameters:
+argc: number of command line arguments. Must be 2 or 4.
+argv: command line arguments.
+    1st argument: executable file name
+    2nd argument: path of the Unix domain socket
+    3rd argument (optional): -f to run as a follower
+    4th argument (optional): path of the socket of the primary */
+int main(int argc, char **argv) {
+    struct aserver server;
+    struct epoll_event ev, events[MAX_EVENTS];
+    struct sigaction sa;
+    struct aconn *conn;
+    unsigned long last_ship;
+    int lfd, efd, fd, n, i, ok;
+
+    if (argc != 2 && (argc != 4 || strcmp(argv[2], "-f"))) {
+        printf("Usage: %s {SOCKET_PATH} [-f {PRIMARY_SOCKET_PATH}]\n", argv[0]);
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    lfd = listen_socket(argv[1]);
+    if (lfd < 0) {
+        perror("symtabd");
+        return 1;
+    }
+    efd = epoll_create1(0);
+    assert(efd >= 0);
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(efd, EPOLL_CTL_ADD, lfd, &ev);
+
+    server.table = SymTable_new();
+    server.follower = 0;
+    server.seq = 0;
+    server.delay = 0;
+    server.log = SymRepl_new();
+    server.followers = NULL;
+    server.primary = NULL;
+    server.dropped = NULL;
+    server.efd = efd;
+
+    /* a follower asks the primary for its bindings and changes */
+    if (argc == 4) {
+        fd = connect_socket(argv[3]);
+        if (fd < 0) {
+            perror("symtabd");
+            return 1;
+        }
+        server.follower = 1;
+        server.primary = new_conn(efd, fd);
+        server.primary->replica = 1;
+        buf_puts(&server.primary->out, "SYN \n");
+        handle_write(server.primary);
+        printf("++> Following %s\n", argv[3]);
+    }
+    printf("++> Listening on %s\n", argv[1]);
+
+    last_ship = SymRepl_clock();
+    while(!stop) {
+        n = epoll_wait(efd, events, MAX_EVENTS, HEARTBEAT_MS);
+        for (i = 0; i < n; i++) {
+
+            /* new connection: the listening socket has no conn */
+            if (!events[i].data.ptr) {
+                while((fd = accept(lfd, NULL, NULL)) >= 0) {
+                    new_conn(efd, fd);
+                }
+                continue;
+            }
+
+            /* a follower dropped by ship() earlier in this batch */
+            conn = events[i].data.ptr;
+            if (conn->dropped) {
+                continue;
+            }
+            ok = 1;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                ok = handle_read(&server, conn);
+            }
+            if (ok) {
+                ok = handle_write(conn);
+            }
+            if (!ok) {
+                close_conn(&server, efd, conn);
+                continue;
+            }
+            watch(efd, conn);
+        }
+
+        /* ship the changes of this iteration, or an empty frame when idle
+        so that the followers can measure their delay */
+        if (server.followers && (SymRepl_getLength(server.log)
+            || ((SymRepl_clock() - last_ship) & 0xffffffffUL)
+               >= HEARTBEAT_MS * 1000UL)) {
+            ship(&server, efd);
+            last_ship = SymRepl_clock();
+        }
+
+        /* no event of this batch is left to point to them */
+        while(server.dropped) {
+            conn = server.dropped;
+            server.dropped = conn->next;
+            close_conn(&server, efd, conn);
+        }
+    }
+
+    printf("++> Shutting down...");
+    while(server.followers) {
+        close_conn(&server, efd, server.followers);
+    }
+    if (server.primary) {
+        close_conn(&server, efd, server.primary);
+    }
+    close(efd);
+    close(lfd);
+    unlink(argv[1]);
+    SymTable_map(server.table, free_value, NULL);
+    SymTable_free(server.table);
+    SymRepl_free(server.log);
+    printf("DONE\n");
+
+    return 0;
+}
+
+
+/* on_signal
+
+Signal handler that stops the server.
+
+Parameters:
+sig: the signal number. Ignored in this function. */
+void on_signal(int sig) {
+    stop = 1;
+}
+
+
+/* buf_init
+
+Initializes an empty buffer.
+
+Checks: if memory was allocated succesfully at runtime. */
+void buf_init(struct abuf *buf) {
+    buf->len = 0;
+    buf->cap = BUFSIZE;
+    buf->data = malloc(buf->cap);
+    assert(buf->data);
+}
+
+
+/* buf_append
+
+Appends len bytes of data to buf.
+
+Checks: if memory was allocated succesfully at runtime. */
+void buf_append(struct abuf *buf, const char *data, size_t len) {
+    while(buf->len + len > buf->cap) {
+        buf->cap *= 2;
+        buf->data = realloc(buf->data, buf->cap);
+        assert(buf->data);
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+
+/* buf_puts
+
+Appends the null terminated str to buf. */
+void buf_puts(struct abuf *buf, const char *str) {
+    buf_append(buf, str, strlen(str));
+}
+
+
+/* free_value
+
+Function used by SymTable_map() to free the values owned by the server. */
+void free_value(const char *pcKey, void *pvValue, void *pvExtra) {
+    free(pvValue);
+}
+
+
+/* append_prefix
+
+Function used by SymTable_map() to append a "KEY key value" response for
+every binding whose key starts with the prefix in pvExtra. */
+void append_prefix(const char *pcKey, void *pvValue, void *pvExtra) {
+    struct aprefix *prefix;
+
+    prefix = pvExtra;
+    if (strncmp(pcKey, prefix->prefix, prefix->len)) {
+        return;
+    }
+    buf_puts(prefix->out, "KEY ");
+    buf_puts(prefix->out, pcKey);
+    buf_puts(prefix->out, " ");
+    buf_puts(prefix->out, pvValue);
+    buf_puts(prefix->out, "\n");
+}
+
+
+/* log_binding
+
+Function used by SymTable_map() to append a put of every binding to the
+log in pvExtra. */
+void log_binding(const char *pcKey, void *pvValue, void *pvExtra) {
+    SymRepl_put(pvExtra, pcKey, pvValue);
+}
+
+
+/* apply_put
+
+Function used by SymRepl_apply() to apply a put shipped by the primary. */
+void apply_put(const char *pcKey, const char *pcValue, void *pvExtra) {
+    table_put(pvExtra, pcKey, pcValue);
+}
+
+
+/* apply_remove
+
+Function used by SymRepl_apply() to apply a removal shipped by the
+primary. */
+void apply_remove(const char *pcKey, void *pvExtra) {
+    table_remove(pvExtra, pcKey);
+}
+
+
+/* table_put
+
+Creates a binding in the table of server with a copy of value and logs
+the change if server has followers.
+
+Returns: 1 if binding was created, 0 if key exists. */
+int table_put(struct aserver *server, const char *key, const char *value) {
+    char *copy;
+
+    copy = malloc(strlen(value) + 1);
+    assert(copy);
+    strcpy(copy, value);
+    if (!SymTable_put(server->table, key, copy)) {
+        free(copy);
+        return 0;
+    }
+    if (server->followers) {
+        SymRepl_put(server->log, key, value);
+    }
+    server->seq++;
+
+    return 1;
+}
+
+
+/* table_remove
+
+Removes a binding from the table of server and logs the change if server
+has followers.
+
+Returns: 1 if removal was successful, 0 if key was not found. */
+int table_remove(struct aserver *server, const char *key) {
+    void *value;
+
+    value = SymTable_get(server->table, key);
+    if (!SymTable_remove(server->table, key)) {
+        return 0;
+    }
+    free(value);
+    if (server->followers) {
+        SymRepl_remove(server->log, key);
+    }
+    server->seq++;
+
+    return 1;
+}
+
+
+/* execute
+
+Executes the request in line on the table of server and appends the
+response to the output of conn. Values are copied and owned by the server.
+
+Parameters:
+server: the state of the server.
+conn: the connection that sent the request.
+line: a request without the newline. Modified by this function. */
+void execute(struct aserver *server, struct aconn *conn, char *line) {
+    SymTable_T oSymTable;
+    struct aprefix prefix;
+    struct abuf *out;
+    SymRepl_T snapshot;
+    const char *frame;
+    size_t frame_len;
+    char *key, *value, number[32];
+
+    oSymTable = server->table;
+    out = &conn->out;
+    if (strlen(line) < 4 || line[3] != ' ') {
+        buf_puts(out, "ERR\n");
+        return;
+    }
+    key = line + 4;
+    value = strchr(key, ' ');
+    if (value) {
+        *value++ = '\0';
+    }
+
+    if (!strncmp(line, "GET", 3)) {
+        value = SymTable_get(oSymTable, key);
+        if (value) {
+            buf_puts(out, "VAL ");
+            buf_puts(out, value);
+            buf_puts(out, "\n");
+        }
+        else {
+            buf_puts(out, "NIL\n");
+        }
+    }
+    else if (!strncmp(line, "PUT", 3) && value && !server->follower) {
+        buf_puts(out, table_put(server, key, value) ? "OK\n" : "NO\n");
+    }
+    else if (!strncmp(line, "DEL", 3) && !server->follower) {
+        buf_puts(out, table_remove(server, key) ? "OK\n" : "NO\n");
+    }
+    else if (!strncmp(line, "HAS", 3)) {
+        buf_puts(out, SymTable_contains(oSymTable, key) ? "OK\n" : "NO\n");
+    }
+    else if (!strncmp(line, "PRE", 3)) {
+        prefix.prefix = key;
+        prefix.len = strlen(key);
+        prefix.out = out;
+        SymTable_map(oSymTable, append_prefix, &prefix);
+        buf_puts(out, "END\n");
+    }
+    else if (!strncmp(line, "LAG", 3)) {
+        sprintf(number, "VAL %lu %lu\n", server->seq, server->delay);
+        buf_puts(out, number);
+    }
+    else if (!strncmp(line, "PRO", 3)) {
+
+        /* the follower stops following and accepts writes */
+        server->follower = 0;
+        buf_puts(out, "OK\n");
+    }
+    else if (!strncmp(line, "SYN", 3) && !conn->replica) {
+
+        /* changes not shipped yet are already in the table: ship them to
+        the other followers before sending the bindings to the new one.
+        A second SYN in the same read would link conn twice. */
+        conn->replica = 1;
+        if (SymRepl_getLength(server->log)) {
+            ship(server, server->efd);
+        }
+        snapshot = SymRepl_new();
+        SymTable_map(oSymTable, log_binding, snapshot);
+        frame = SymRepl_frame(snapshot, server->seq, &frame_len);
+        buf_append(out, frame, frame_len);
+        SymRepl_free(snapshot);
+        conn->next = server->followers;
+        server->followers = conn;
+    }
+    else {
+        buf_puts(out, "ERR\n");
+    }
+}
+
+
+/* handle_read
+
+Reads all available bytes from conn and executes every complete request,
+or applies every complete frame if conn is the connection to the primary.
+An incomplete request or frame is kept for the next read.
+
+Returns: 0 if the connection was closed, 1 otherwise. */
+int handle_read(struct aserver *server, struct aconn *conn) {
+    char *line, *newline, *end;
+    unsigned long seq, created;
+    ssize_t n;
+    long frame_len;
+    int open;
+
+    open = 1;
+    while(1) {
+        if (conn->in.len == conn->in.cap) {
+            conn->in.cap *= 2;
+            conn->in.data = realloc(conn->in.data, conn->in.cap);
+            assert(conn->in.data);
+        }
+        n = read(conn->fd, conn->in.data + conn->in.len,
+                 conn->in.cap - conn->in.len);
+        if (n > 0) {
+            conn->in.len += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            open = 0;
+        }
+        break;
+    }
+
+    line = conn->in.data;
+    end = conn->in.data + conn->in.len;
+    if (conn == server->primary) {
+        if (!server->follower) {
+
+            /* promoted: changes of the old primary are no longer applied */
+            open = 0;
+            line = end;
+        }
+        while((frame_len = SymRepl_apply(line, end - line, apply_put,
+                                         apply_remove, server, &seq,
+                                         &created)) > 0) {
+            server->seq = seq;
+            server->delay = (SymRepl_clock() - created) & 0xffffffffUL;
+            line += frame_len;
+        }
+        if (frame_len < 0) {
+            open = 0;
+        }
+
+        /* the primary only sends frames: an incomplete frame is kept for
+        the next read and never parsed as requests */
+        conn->in.len = end - line;
+        memmove(conn->in.data, line, conn->in.len);
+        return open;
+    }
+    if (conn->replica) {
+
+        /* followers do not send requests after "SYN" */
+        line = end;
+    }
+    while((newline = memchr(line, '\n', end - line))) {
+        *newline = '\0';
+        execute(server, conn, line);
+        line = newline + 1;
+    }
+    conn->in.len = end - line;
+    memmove(conn->in.data, line, conn->in.len);
+
+    return open;
+}
+
+
+/* handle_write
+
+Writes as many pending responses of conn as possible.
+
+Returns: 0 if the connection failed, 1 otherwise. */
+int handle_write(struct aconn *conn) {
+    size_t sent;
+    ssize_t n;
+
+    sent = 0;
+    while(sent < conn->out.len) {
+        n = write(conn->fd, conn->out.data + sent, conn->out.len - sent);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return 0;
+            }
+            break;
+        }
+        sent += n;
+    }
+    conn->out.len -= sent;
+    memmove(conn->out.data, conn->out.data + sent, conn->out.len);
+
+    return 1;
+}
+
+
+/* ship
+
+Encodes the changes in the log of server as one frame and appends it to
+the output of every follower. A follower that cannot be written to is
+dropped, not closed, as ship may run while the events of other
+connections are being handled. */
+void ship(struct aserver *server, int efd) {
+    struct aconn *conn, *conn_next;
+    const char *frame;
+    size_t frame_len;
+
+    frame = SymRepl_frame(server->log, server->seq, &frame_len);
+    for (conn = server->followers; conn; conn = conn_next) {
+        conn_next = conn->next;
+        buf_append(&conn->out, frame, frame_len);
+        if (!handle_write(conn)) {
+            drop_conn(server, conn);
+            continue;
+        }
+        watch(efd, conn);
+    }
+}
+
+
+/* watch
+
+Registers conn with epoll for reading, and also for writing while it has
+pending output. */
+void watch(int efd, struct aconn *conn) {
+    struct epoll_event ev;
+
+    ev.data.ptr = conn;
+    if (conn->writing != (conn->out.len > 0)) {
+        conn->writing = conn->out.len > 0;
+        ev.events = conn->writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        epoll_ctl(efd, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
+}
+
+
+/* new_conn
+
+Creates a non-blocking connection for fd and registers it with epoll.
+
+Checks: if memory was allocated succesfully at runtime.
+
+Returns: the connection */
+struct aconn *new_conn(int efd, int fd) {
+    struct epoll_event ev;
+    struct aconn *conn;
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    conn = malloc(sizeof(struct aconn));
+    assert(conn);
+    conn->fd = fd;
+    conn->writing = 0;
+    conn->replica = 0;
+    conn->dropped = 0;
+    conn->next = NULL;
+    buf_init(&conn->in);
+    buf_init(&conn->out);
+    ev.events = EPOLLIN;
+    ev.data.ptr = conn;
+    epoll_ctl(efd, EPOLL_CTL_ADD, fd, &ev);
+
+    return conn;
+}
+
+
+/* drop_conn
+
+Removes conn from the followers of server and marks it to be closed at
+the end of the current batch of events. */
+void drop_conn(struct aserver *server, struct aconn *conn) {
+    struct aconn **link;
+
+    for (link = &server->followers; *link; link = &(*link)->next) {
+        if (*link == conn) {
+            *link = conn->next;
+            break;
+        }
+    }
+    conn->dropped = 1;
+    conn->next = server->dropped;
+    server->dropped = conn;
+}
+
+
+/* close_conn
+
+Closes conn, removes it from the followers or the primary of server and
+frees its memory. */
+void close_conn(struct aserver *server, int efd, struct aconn *conn) {
+    struct aconn **link;
+
+    for (link = &server->followers; *link; link = &(*link)->next) {
+        if (*link == conn) {
+            *link = conn->next;
+            break;
+        }
+    }
+    if (conn == server->primary) {
+        server->primary = NULL;
+    }
+    epoll_ctl(efd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn);
+}
+
+
+/* listen_socket
+
+Creates a non-blocking Unix domain socket listening on path. An existing
+file at path is removed.
+
+Returns: the socket or -1 on failure. */
+int listen_socket(const char *path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+        || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    return fd;
+}
+
+
+/* connect_socket
+
+Connects to the Unix domain socket at path.
+
+Returns: the socket or -1 on failure. */
+int connect_socket(const char *path) {
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
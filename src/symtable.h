@@ -4,9 +4,25 @@
 #define SYMTABLE_INCLUDE
 
 #include <stdio.h>
+#include "symbudget.h"
+
+#define SYMTABLE_BATCH 64   /* maximum bindings per SymTable_mapBatch call */
+#define SYMTABLE_RANDOM 1   /* mode: keep the bindings for SymTable_randomBinding */
+#define SYMTABLE_REUSABLE 2 /* mode: SymTable_reset keeps the bindings for reuse */
 
 typedef void* SymTable_T;
 
+#ifdef SYMTABLE_STATS
+/* Operation counts of an instrumented build of the library: key
+comparisons (strcmp calls), visited bindings and memory allocations. The
+counts are global to all tables and are not updated atomically. */
+struct SymTableStats {
+    unsigned long ulCompares;
+    unsigned long ulVisits;
+    unsigned long ulAllocs;
+};
+#endif
+
 
 /* Creates a SymTable struct with no bindings.
 
@@ -14,6 +30,15 @@ Checks: if memory was allocated succesfully for oSymTable at runtime. */
 SymTable_T SymTable_new(void);
 
 
+/* Creates a SymTable struct with no bindings that keeps its bindings
+ordered by (hash, key). A lookup for a missing key stops as soon as it
+passes the position of the key, and sorted tables can be merged in
+linear time. SymTable_map visits the bindings in (hash, key) order.
+
+Checks: if memory was allocated succesfully for oSymTable at runtime. */
+SymTable_T SymTable_newSorted(void);
+
+
 /* Frees all memory used by oSymTable.
 
 Parameters:
@@ -21,6 +46,62 @@ Parameters:
 void SymTable_free(SymTable_T oSymTable);
 
 
+/* Creates a copy of oSymTable with the same bindings in the same order.
+The copy has its own keys and shares the values of oSymTable. All bindings
+and keys are allocated in one block, so copying takes linear time and one
+allocation. The block is freed by SymTable_free; bindings removed from the
+copy are released from the budget but their memory is kept until then.
+
+The copy is sorted if oSymTable is sorted, and is attached to the budget
+of oSymTable.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+
+Returns: a SymTable_T type or NULL if the budget of oSymTable rejected the
+copy. */
+SymTable_T SymTable_clone(SymTable_T oSymTable);
+
+
+/* Allocates room for uiCount more bindings of oSymTable in one block, so
+that the next uiCount new bindings only allocate their keys, and, in
+SYMTABLE_RANDOM mode, makes room for them in the array of bindings. The
+block is charged to the budget of oSymTable at once and puts that use it
+only charge their keys. The block is freed by SymTable_free.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* uiCount: number of bindings
+
+Returns: 1 if the room was allocated, 0 if the budget rejected it */
+int SymTable_reserve(SymTable_T oSymTable, unsigned int uiCount);
+
+
+/* Removes all bindings from oSymTable. In SYMTABLE_REUSABLE mode this
+takes constant time: the bindings are kept as stale bindings of an older
+generation, which are treated as absent, and a later put of the same key
+revives its binding without allocating. Unsorted tables also reuse any
+stale binding for a new key, sorted tables only the stale binding at the
+position of the new key. Stale bindings keep their memory, which stays
+charged to the budget of oSymTable, until they are reused, the mode is
+turned off or the table is freed. Otherwise the bindings are freed in
+linear time.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type */
+void SymTable_reset(SymTable_T oSymTable);
+
+
 /* Returns the number of bindings in oSymTable.
 
 Asserts: if oSymTable is not NULL at runtime.
@@ -30,6 +111,40 @@ Parameters:
 unsigned int SymTable_getLength(SymTable_T oSymTable);
 
 
+/* Attaches oSymTable to oBudget. The memory already used by oSymTable is
+charged to oBudget and every subsequent binding is charged when created and
+released when removed. A NULL oBudget detaches the table.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* oBudget: a SymBudget_T type or NULL
+
+Returns: 1 if oSymTable was attached, 0 if oBudget could not accommodate
+the memory already used by oSymTable. */
+int SymTable_setBudget(SymTable_T oSymTable, SymBudget_T oBudget);
+
+
+/* Sets the modes of oSymTable to iMode, the | of any of these flags, or 0
+for none:
+* SYMTABLE_RANDOM: the table keeps an array of pointers to its bindings,
+one pointer per binding, which SymTable_randomBinding needs.
+* SYMTABLE_REUSABLE: SymTable_reset keeps the bindings for reuse.
+A new table has no mode. Turning SYMTABLE_RANDOM on takes linear time,
+and so does turning SYMTABLE_REUSABLE off, which frees the bindings kept
+by SymTable_reset.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* iMode: the modes of the table */
+void SymTable_setMode(SymTable_T oSymTable, int iMode);
+
+
 /* Creates a new binding for oSymTable from a given pcKey and pvValue.
 
 Asserts: 
@@ -42,10 +157,34 @@ Parameters:
 * pvValue: pointer to any value
 
 Returns: 1 if binding was created succesfully, 0 if there is already
-a binding with key equal to pcKey. */
+a binding with key equal to pcKey or if the budget of oSymTable rejected
+the binding. */
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue);
 
 
+/* Inserts into oDest a copy of every binding of oSrc. When a key exists in
+both tables, the value in oDest is replaced by the value returned by
+pfResolve, or kept unchanged if pfResolve is NULL. If both tables are
+sorted the merge runs in O(length(oDest) + length(oSrc)) time.
+
+Asserts:
+1) if oDest and oSrc are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oDest: a SymTable_T type
+* oSrc: a SymTable_T type. It is not modified.
+* pfResolve: function that returns the value for a key present in both
+tables, given the value in oDest and the value in oSrc. Can be NULL.
+* pvExtra: a pointer to any value. Used by pfResolve.
+
+Returns: the number of bindings inserted into oDest. Bindings rejected by
+the budget of oDest are skipped. */
+unsigned int SymTable_merge(SymTable_T oDest, SymTable_T oSrc,
+        void *(*pfResolve)(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra),
+        const void *pvExtra);
+
+
 /* Removes a binding with key equal to pcKey.
 
 Asserts: if oSymTable and pcKey are not NULL at runtime.
@@ -95,4 +234,55 @@ void  SymTable_map(SymTable_T oSymTable,
         const void *pvExtra);
 
 
+/* Applies function pfApply to the bindings of oSymTable in chunks of at
+most SYMTABLE_BATCH bindings. pfApply receives uiCount keys and the values
+of their bindings in two arrays, so that one call can process many
+bindings with a loop the compiler can unroll or vectorize. The arrays are
+valid only during the call. Bindings are visited in the order of
+SymTable_map.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTable_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void  SymTable_mapBatch(SymTable_T oSymTable,
+        void (*pfApply)(const char **ppcKeys, void **ppvValues,
+                        unsigned int uiCount, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Picks a binding of oSymTable uniformly at random in constant time.
+*pulRandom is the state of a xorshift generator owned by the caller: it
+can be seeded with any value and is advanced by every call.
+
+Asserts:
+1) if oSymTable and pulRandom are not NULL at runtime.
+2) if oSymTable is in SYMTABLE_RANDOM mode at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* pulRandom: state of the random number generator
+* ppcKey: set to the key of the binding, if not NULL. The key belongs to
+the binding.
+* ppvValue: set to the value of the binding, if not NULL
+
+Returns: 1 if a binding was picked, 0 if oSymTable is empty */
+int SymTable_randomBinding(SymTable_T oSymTable, unsigned long *pulRandom,
+        const char **ppcKey, void **ppvValue);
+
+
+#ifdef SYMTABLE_STATS
+/* Copies the operation counts of the library to pStats and resets them
+to 0. Only available when the library is built with SYMTABLE_STATS.
+
+Asserts: if pStats is not NULL at runtime.
+
+Parameters:
+* pStats: a SymTableStats struct */
+void SymTable_takeStats(struct SymTableStats *pStats);
+#endif
+
+
 #endif
@@ -0,0 +1,811 @@
+/* Library for creating and using Symbol tables that choose their own
+representation.
+
+A table is in one of four representations:
+* list: one unsorted list. Cheap to build and to change while small.
+* hash: lists selected by hash, doubled when they get long. Point lookups
+and changes take constant time.
+* ordered: an array sorted by key. Lookups take logarithmic time and
+ranges visit only their bindings, but changes move the array.
+* frozen: the ordered array plus an open addressing index by hash. Reads
+are as fast as in the hash table and ranges as in the ordered array, but
+the first change moves the bindings to a hash table.
+
+Every operation is counted. After ADAPT_WINDOW operations the cost of
+those operations is estimated for each representation at the current
+size, in visited bindings. The table moves to a cheaper representation
+only if it is ADAPT_GAIN times cheaper for ADAPT_VOTES windows in a row
+and the savings of ADAPT_PAYBACK such windows would pay for moving the
+bindings, so a table does not go back and forth when its workload changes
+briefly. A change to a frozen table forces a move to a hash table, so the
+windows with changes are also counted over the last ADAPT_PAYBACK windows
+and each of them costs the frozen representation a move: a table that is
+written every few windows is not frozen again after each write. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "symtableadapt.h"
+
+#define HASH_MULTIPLIER 65599
+#define ADAPT_WINDOW 256    /* operations between two cost estimates */
+#define ADAPT_GAIN 1.5      /* minimum cost ratio for a move */
+#define ADAPT_VOTES 2       /* windows in a row that must agree on a move */
+#define ADAPT_MOVE 4.0      /* estimated cost of moving one binding */
+#define ADAPT_PAYBACK 64    /* windows in which a move must pay for itself */
+#define ADAPT_KINDS 4
+#define ADAPT_MIN_SIZE 16   /* minimum number of buckets, slots or entries */
+
+/* counted operations */
+#define OP_GET 0
+#define OP_PUT 1
+#define OP_REMOVE 2
+#define OP_RANGE 3
+#define NOPS 4
+
+
+/* Struct that represents a binding in the symbol table: a key, a pointer
+to any value and the hash of the key.
+
+Note: A binding owns its key. A binding does not own its value. */
+struct aentry {
+    char *key;
+    void *value;
+    unsigned int hash;
+};
+
+
+/* Struct that represents a binding in a list */
+struct anode {
+    struct aentry entry;
+    struct anode *next;
+};
+
+
+/* Struct that represents a symbol table. List and hash tables use
+buckets (a single bucket for a list). Ordered and frozen tables use
+entries, sorted by key, and frozen tables also use slots, which hold the
+index + 1 of an entry or 0 if empty. ops counts the operations of the
+current window and ulRangeCount the bindings visited by its ranges.
+iChanged is 1 if a binding was added or removed in the current window and
+dChanged the number of past windows with changes, decayed so that it
+covers about the last ADAPT_PAYBACK windows. */
+struct SymTableAdapt {
+    int iKind;
+    unsigned int uiSize;
+    struct anode **buckets;
+    unsigned int uiBuckets;
+    struct aentry *entries;
+    unsigned int uiCap;
+    unsigned int *slots;
+    unsigned int uiSlots;
+    unsigned long ops[NOPS];
+    unsigned long ulRangeCount;
+    unsigned int uiOps;
+    int iCandidate;
+    int iVotes;
+    int iChanged;
+    double dChanged;
+};
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymTableAdapt_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Returns the smallest power of 2 that is >= uiCount and >=
+ADAPT_MIN_SIZE */
+static unsigned int SymTableAdapt_power(unsigned int uiCount) {
+    unsigned int size;
+
+    size = ADAPT_MIN_SIZE;
+    while(size < uiCount) {
+        size *= 2;
+    }
+
+    return size;
+}
+
+
+/* Compares the keys of two entries. Used by qsort. */
+static int SymTableAdapt_compare(const void *a, const void *b) {
+    return strcmp(((const struct aentry *) a)->key,
+                  ((const struct aentry *) b)->key);
+}
+
+
+/* Compares the keys of two pointers to entries. Used by qsort. */
+static int SymTableAdapt_comparePtr(const void *a, const void *b) {
+    return strcmp((*(struct aentry * const *) a)->key,
+                  (*(struct aentry * const *) b)->key);
+}
+
+
+/* Finds the link (the first pointer of a bucket or the next pointer of a
+node) that points to the node with key pcKey, or the link at the end of
+the bucket if there is no such node. symtable must be a list or a hash
+table. */
+static struct anode **SymTableAdapt_chain(struct SymTableAdapt *symtable,
+    const char *pcKey, unsigned int hash) {
+    struct anode **link;
+
+    link = &symtable->buckets[hash & (symtable->uiBuckets - 1)];
+    while(*link) {
+        if ((*link)->entry.hash == hash && !strcmp((*link)->entry.key, pcKey)) {
+            return link;
+        }
+        link = &(*link)->next;
+    }
+
+    return link;
+}
+
+
+/* Returns the index of the first entry with key >= pcKey and sets *found
+to 1 if its key is equal to pcKey. symtable must be ordered or frozen. */
+static unsigned int SymTableAdapt_search(struct SymTableAdapt *symtable,
+    const char *pcKey, int *found) {
+    unsigned int low, high, mid;
+    int cmp;
+
+    low = 0;
+    high = symtable->uiSize;
+    *found = 0;
+    while(low < high) {
+        mid = low + (high - low) / 2;
+        cmp = strcmp(symtable->entries[mid].key, pcKey);
+        if (!cmp) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+
+/* Returns the binding with key pcKey or NULL if there is none */
+static struct aentry *SymTableAdapt_find(struct SymTableAdapt *symtable,
+    const char *pcKey) {
+    struct anode **link;
+    unsigned int hash, slot, index;
+    int found;
+
+    switch (symtable->iKind) {
+    case SYMTABLEADAPT_LIST:
+    case SYMTABLEADAPT_HASH:
+        link = SymTableAdapt_chain(symtable, pcKey, SymTableAdapt_hash(pcKey));
+        return *link ? &(*link)->entry : NULL;
+    case SYMTABLEADAPT_ORDERED:
+        index = SymTableAdapt_search(symtable, pcKey, &found);
+        return found ? &symtable->entries[index] : NULL;
+    default:
+        hash = SymTableAdapt_hash(pcKey);
+        slot = hash & (symtable->uiSlots - 1);
+        while(symtable->slots[slot]) {
+            index = symtable->slots[slot] - 1;
+            if (symtable->entries[index].hash == hash &&
+                !strcmp(symtable->entries[index].key, pcKey)) {
+                return &symtable->entries[index];
+            }
+            slot = (slot + 1) & (symtable->uiSlots - 1);
+        }
+        return NULL;
+    }
+}
+
+
+/* Removes all bindings from the representation of symtable and returns
+them in an array of uiSize entries, which the caller must free. The keys
+are not copied. */
+static struct aentry *SymTableAdapt_take(struct SymTableAdapt *symtable) {
+    struct aentry *entries;
+    struct anode *ptr, *ptr_next;
+    unsigned int i, count;
+
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED ||
+        symtable->iKind == SYMTABLEADAPT_FROZEN) {
+        entries = symtable->entries;
+        free(symtable->slots);
+    }
+    else {
+        entries = malloc((symtable->uiSize ? symtable->uiSize : 1) *
+                         sizeof(struct aentry));
+        assert(entries);
+        count = 0;
+        for (i = 0; i < symtable->uiBuckets; i++) {
+            for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+                ptr_next = ptr->next;
+                entries[count++] = ptr->entry;
+                free(ptr);
+            }
+        }
+        free(symtable->buckets);
+    }
+    symtable->entries = NULL;
+    symtable->slots = NULL;
+    symtable->buckets = NULL;
+
+    return entries;
+}
+
+
+/* Builds representation iKind of symtable from the uiSize entries, which
+it takes over. The entries must be sorted by key if iSorted is 1.
+
+Asserts: if necessary memory was allocated succesfully at runtime. */
+static void SymTableAdapt_build(struct SymTableAdapt *symtable, int iKind,
+    struct aentry *entries, int iSorted) {
+    struct anode *node, **bucket;
+    unsigned int i, slot;
+
+    symtable->iKind = iKind;
+    if (iKind == SYMTABLEADAPT_LIST || iKind == SYMTABLEADAPT_HASH) {
+        symtable->uiBuckets = iKind == SYMTABLEADAPT_LIST ? 1 :
+                              SymTableAdapt_power(symtable->uiSize);
+        symtable->buckets = calloc(symtable->uiBuckets, sizeof(struct anode *));
+        assert(symtable->buckets);
+        for (i = 0; i < symtable->uiSize; i++) {
+            node = malloc(sizeof(struct anode));
+            assert(node);
+            node->entry = entries[i];
+            bucket = &symtable->buckets[entries[i].hash & (symtable->uiBuckets - 1)];
+            node->next = *bucket;
+            *bucket = node;
+        }
+        free(entries);
+        return;
+    }
+
+    if (!iSorted) {
+        qsort(entries, symtable->uiSize, sizeof(struct aentry),
+              SymTableAdapt_compare);
+    }
+    symtable->uiCap = SymTableAdapt_power(symtable->uiSize);
+    symtable->entries = realloc(entries, symtable->uiCap * sizeof(struct aentry));
+    assert(symtable->entries);
+    if (iKind == SYMTABLEADAPT_FROZEN) {
+        symtable->uiSlots = SymTableAdapt_power(2 * symtable->uiSize);
+        symtable->slots = calloc(symtable->uiSlots, sizeof(unsigned int));
+        assert(symtable->slots);
+        for (i = 0; i < symtable->uiSize; i++) {
+            slot = symtable->entries[i].hash & (symtable->uiSlots - 1);
+            while(symtable->slots[slot]) {
+                slot = (slot + 1) & (symtable->uiSlots - 1);
+            }
+            symtable->slots[slot] = i + 1;
+        }
+    }
+    return;
+}
+
+
+/* Moves the bindings of symtable to representation iKind */
+static void SymTableAdapt_move(struct SymTableAdapt *symtable, int iKind) {
+    int sorted;
+
+    sorted = symtable->iKind == SYMTABLEADAPT_ORDERED ||
+             symtable->iKind == SYMTABLEADAPT_FROZEN;
+    SymTableAdapt_build(symtable, iKind, SymTableAdapt_take(symtable), sorted);
+    symtable->iVotes = 0;
+    return;
+}
+
+
+/* Doubles the number of buckets of a hash table */
+static void SymTableAdapt_grow(struct SymTableAdapt *symtable) {
+    struct anode **buckets, *ptr, *ptr_next;
+    unsigned int i, size;
+
+    size = symtable->uiBuckets * 2;
+    buckets = calloc(size, sizeof(struct anode *));
+    assert(buckets);
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+            ptr_next = ptr->next;
+            ptr->next = buckets[ptr->entry.hash & (size - 1)];
+            buckets[ptr->entry.hash & (size - 1)] = ptr;
+        }
+    }
+    free(symtable->buckets);
+    symtable->buckets = buckets;
+    symtable->uiBuckets = size;
+    return;
+}
+
+
+/* Returns the estimated cost, in visited bindings, of the operations of
+the current window of symtable in representation iKind */
+static double SymTableAdapt_cost(struct SymTableAdapt *symtable, int iKind) {
+    double n, lg, k, get, put, remove, range;
+    unsigned int size;
+
+    n = symtable->uiSize + 1.0;
+    lg = 1.0;
+    for (size = symtable->uiSize; size > 1; size /= 2) {
+        lg += 1.0;
+    }
+    k = symtable->ops[OP_RANGE] ?
+        (double) symtable->ulRangeCount / symtable->ops[OP_RANGE] : 0.0;
+
+    switch (iKind) {
+    case SYMTABLEADAPT_LIST:
+        get = n / 2;
+        put = n;
+        remove = n / 2;
+        range = n + k * lg;
+        break;
+    case SYMTABLEADAPT_HASH:
+        get = 2.0;
+        put = 3.0;
+        remove = 2.0;
+        range = n + k * lg;
+        break;
+    case SYMTABLEADAPT_ORDERED:
+        /* moving an entry of the array is much cheaper than visiting a
+        binding */
+        get = lg;
+        put = lg + n / 16;
+        remove = lg + n / 16;
+        range = lg + k;
+        break;
+    default:
+        /* a change moves the table to a hash table */
+        get = 1.0;
+        put = ADAPT_MOVE * n;
+        remove = ADAPT_MOVE * n;
+        range = lg + k;
+        break;
+    }
+
+    return symtable->ops[OP_GET] * get + symtable->ops[OP_PUT] * put +
+           symtable->ops[OP_REMOVE] * remove + symtable->ops[OP_RANGE] * range;
+}
+
+
+/* Counts an operation of type iOp on symtable. At the end of a window,
+moves symtable to the cheapest representation if the move is worth it. */
+static void SymTableAdapt_count(struct SymTableAdapt *symtable, int iOp) {
+    double cost[ADAPT_KINDS];
+    int i, best;
+
+    symtable->ops[iOp]++;
+    if (++symtable->uiOps < ADAPT_WINDOW) {
+        return;
+    }
+
+    for (i = 0; i < ADAPT_KINDS; i++) {
+        cost[i] = SymTableAdapt_cost(symtable, i);
+    }
+
+    /* a frozen table moves once in every window with changes */
+    cost[SYMTABLEADAPT_FROZEN] += ADAPT_MOVE * symtable->uiSize *
+                                  symtable->dChanged / ADAPT_PAYBACK;
+    symtable->dChanged += symtable->iChanged -
+                          symtable->dChanged / ADAPT_PAYBACK;
+    symtable->iChanged = 0;
+    best = symtable->iKind;
+    for (i = 0; i < ADAPT_KINDS; i++) {
+        if (cost[i] < cost[best]) {
+            best = i;
+        }
+    }
+    if (best != symtable->iKind && cost[best] * ADAPT_GAIN < cost[symtable->iKind] &&
+        (cost[symtable->iKind] - cost[best]) * ADAPT_PAYBACK >
+        ADAPT_MOVE * symtable->uiSize) {
+        if (best != symtable->iCandidate) {
+            symtable->iCandidate = best;
+            symtable->iVotes = 0;
+        }
+        if (++symtable->iVotes >= ADAPT_VOTES) {
+            SymTableAdapt_move(symtable, best);
+        }
+    }
+    else {
+        symtable->iVotes = 0;
+    }
+
+    for (i = 0; i < NOPS; i++) {
+        symtable->ops[i] = 0;
+    }
+    symtable->ulRangeCount = 0;
+    symtable->uiOps = 0;
+    return;
+}
+
+
+/* Creates a SymTableAdapt struct with no bindings, represented as a list.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableAdapt_T SymTableAdapt_new(void) {
+    struct SymTableAdapt *symtable;
+    int i;
+
+    symtable = malloc(sizeof(struct SymTableAdapt));
+    assert(symtable);
+    symtable->uiSize = 0U;
+    symtable->entries = NULL;
+    symtable->slots = NULL;
+    SymTableAdapt_build(symtable, SYMTABLEADAPT_LIST, NULL, 0);
+    for (i = 0; i < NOPS; i++) {
+        symtable->ops[i] = 0;
+    }
+    symtable->ulRangeCount = 0;
+    symtable->uiOps = 0;
+    symtable->iCandidate = SYMTABLEADAPT_LIST;
+    symtable->iVotes = 0;
+    symtable->iChanged = 0;
+    symtable->dChanged = 0.0;
+
+    return (SymTableAdapt_T) symtable;
+}
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+void SymTableAdapt_free(SymTableAdapt_T oSymTable) {
+    struct SymTableAdapt *symtable;
+    struct aentry *entries;
+    unsigned int i;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return;
+    }
+    entries = SymTableAdapt_take(symtable);
+    for (i = 0; i < symtable->uiSize; i++) {
+        free(entries[i].key);
+    }
+    free(entries);
+    free(symtable);
+    return;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+unsigned int SymTableAdapt_getLength(SymTableAdapt_T oSymTable) {
+    struct SymTableAdapt *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->uiSize;
+}
+
+
+/* Returns the current representation of oSymTable: SYMTABLEADAPT_LIST,
+SYMTABLEADAPT_HASH, SYMTABLEADAPT_ORDERED or SYMTABLEADAPT_FROZEN.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+int SymTableAdapt_getKind(SymTableAdapt_T oSymTable) {
+    struct SymTableAdapt *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->iKind;
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableAdapt_put(SymTableAdapt_T oSymTable, const char *pcKey,
+        const void *pvValue) {
+    struct SymTableAdapt *symtable;
+    struct aentry entry;
+    struct anode **link;
+    unsigned int index;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    if (symtable->iKind == SYMTABLEADAPT_FROZEN) {
+        if (SymTableAdapt_find(symtable, pcKey)) {
+            SymTableAdapt_count(symtable, OP_PUT);
+            return 0;
+        }
+        SymTableAdapt_move(symtable, SYMTABLEADAPT_HASH);
+    }
+
+    entry.hash = SymTableAdapt_hash(pcKey);
+    index = 0;
+    link = NULL;
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED) {
+        index = SymTableAdapt_search(symtable, pcKey, &found);
+        if (found) {
+            SymTableAdapt_count(symtable, OP_PUT);
+            return 0;
+        }
+        if (symtable->uiSize == symtable->uiCap) {
+            symtable->uiCap *= 2;
+            symtable->entries = realloc(symtable->entries,
+                                        symtable->uiCap * sizeof(struct aentry));
+            assert(symtable->entries);
+        }
+        memmove(symtable->entries + index + 1, symtable->entries + index,
+                (symtable->uiSize - index) * sizeof(struct aentry));
+    }
+    else {
+        link = SymTableAdapt_chain(symtable, pcKey, entry.hash);
+        if (*link) {
+            SymTableAdapt_count(symtable, OP_PUT);
+            return 0;
+        }
+    }
+
+    entry.key = malloc((strlen(pcKey) + 1) * sizeof(char));
+    assert(entry.key);
+    strcpy(entry.key, pcKey);
+    entry.value = (void *) pvValue;
+
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED) {
+        symtable->entries[index] = entry;
+    }
+    else {
+        *link = malloc(sizeof(struct anode));
+        assert(*link);
+        (*link)->entry = entry;
+        (*link)->next = NULL;
+    }
+    symtable->uiSize++;
+    symtable->iChanged = 1;
+    if (symtable->iKind == SYMTABLEADAPT_HASH &&
+        symtable->uiSize > symtable->uiBuckets) {
+        SymTableAdapt_grow(symtable);
+    }
+    SymTableAdapt_count(symtable, OP_PUT);
+
+    return 1;
+}
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableAdapt_remove(SymTableAdapt_T oSymTable, const char *pcKey) {
+    struct SymTableAdapt *symtable;
+    struct anode **link, *ptr;
+    unsigned int index;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    if (symtable->iKind == SYMTABLEADAPT_FROZEN) {
+        if (!SymTableAdapt_find(symtable, pcKey)) {
+            SymTableAdapt_count(symtable, OP_REMOVE);
+            return 0;
+        }
+        SymTableAdapt_move(symtable, SYMTABLEADAPT_HASH);
+    }
+
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED) {
+        index = SymTableAdapt_search(symtable, pcKey, &found);
+        if (found) {
+            free(symtable->entries[index].key);
+            memmove(symtable->entries + index, symtable->entries + index + 1,
+                    (symtable->uiSize - index - 1) * sizeof(struct aentry));
+        }
+    }
+    else {
+        link = SymTableAdapt_chain(symtable, pcKey, SymTableAdapt_hash(pcKey));
+        ptr = *link;
+        found = ptr != NULL;
+        if (found) {
+            *link = ptr->next;
+            free(ptr->entry.key);
+            free(ptr);
+        }
+    }
+    if (found) {
+        symtable->uiSize--;
+        symtable->iChanged = 1;
+    }
+    SymTableAdapt_count(symtable, OP_REMOVE);
+
+    return found;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableAdapt_contains(SymTableAdapt_T oSymTable, const char *pcKey) {
+    struct SymTableAdapt *symtable;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    found = SymTableAdapt_find(symtable, pcKey) != NULL;
+    SymTableAdapt_count(symtable, OP_GET);
+
+    return found;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableAdapt_get(SymTableAdapt_T oSymTable, const char *pcKey) {
+    struct SymTableAdapt *symtable;
+    struct aentry *entry;
+    void *value;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    entry = SymTableAdapt_find(symtable, pcKey);
+    value = entry ? entry->value : NULL;
+    SymTableAdapt_count(symtable, OP_GET);
+
+    return value;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable. The order of
+the bindings depends on the representation: ordered and frozen tables are
+visited in key order. pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableAdapt_map(SymTableAdapt_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra) {
+    struct SymTableAdapt *symtable;
+    struct anode *ptr;
+    unsigned int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED ||
+        symtable->iKind == SYMTABLEADAPT_FROZEN) {
+        for (i = 0; i < symtable->uiSize; i++) {
+            pfApply(symtable->entries[i].key, symtable->entries[i].value,
+                    (void *) pvExtra);
+        }
+        return;
+    }
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr->next) {
+            pfApply(ptr->entry.key, ptr->entry.value, (void *) pvExtra);
+        }
+    }
+}
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. pfApply must not change oSymTable.
+
+Asserts:
+1) if oSymTable and pfApply are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableAdapt_range(SymTableAdapt_T oSymTable, const char *pcLow,
+        const char *pcHigh,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra) {
+    struct SymTableAdapt *symtable;
+    struct aentry **found;
+    struct anode *ptr;
+    unsigned int i, count;
+    int exact;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    count = 0;
+    if (symtable->iKind == SYMTABLEADAPT_ORDERED ||
+        symtable->iKind == SYMTABLEADAPT_FROZEN) {
+        i = pcLow ? SymTableAdapt_search(symtable, pcLow, &exact) : 0;
+        for (; i < symtable->uiSize; i++) {
+            if (pcHigh && strcmp(symtable->entries[i].key, pcHigh) >= 0) {
+                break;
+            }
+            pfApply(symtable->entries[i].key, symtable->entries[i].value,
+                    (void *) pvExtra);
+            count++;
+        }
+    }
+    else {
+        /* collect the bindings in the range and sort them */
+        found = malloc((symtable->uiSize ? symtable->uiSize : 1) *
+                       sizeof(struct aentry *));
+        assert(found);
+        for (i = 0; i < symtable->uiBuckets; i++) {
+            for (ptr = symtable->buckets[i]; ptr; ptr = ptr->next) {
+                if ((!pcLow || strcmp(ptr->entry.key, pcLow) >= 0) &&
+                    (!pcHigh || strcmp(ptr->entry.key, pcHigh) < 0)) {
+                    found[count++] = &ptr->entry;
+                }
+            }
+        }
+        qsort(found, count, sizeof(struct aentry *), SymTableAdapt_comparePtr);
+        for (i = 0; i < count; i++) {
+            pfApply(found[i]->key, found[i]->value, (void *) pvExtra);
+        }
+        free(found);
+    }
+    symtable->ulRangeCount += count;
+    SymTableAdapt_count(symtable, OP_RANGE);
+
+    return count;
+}
@@ -0,0 +1,146 @@
+/* Library for creating and using Symbol tables that choose their own
+representation.
+
+A table counts its operations and, from time to time, estimates the cost
+of the recent operations in each representation. When another
+representation would be clearly cheaper for a while, the bindings are
+moved to it. */
+
+#ifndef SYMTABLEADAPT_INCLUDE
+#define SYMTABLEADAPT_INCLUDE
+
+#include <stdio.h>
+
+/* representations, returned by SymTableAdapt_getKind */
+#define SYMTABLEADAPT_LIST 0    /* unsorted list */
+#define SYMTABLEADAPT_HASH 1    /* hash table of lists */
+#define SYMTABLEADAPT_ORDERED 2 /* array sorted by key */
+#define SYMTABLEADAPT_FROZEN 3  /* sorted array with a hash index, read only */
+
+typedef void* SymTableAdapt_T;
+
+
+/* Creates a SymTableAdapt struct with no bindings, represented as a list.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableAdapt_T SymTableAdapt_new(void);
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+void SymTableAdapt_free(SymTableAdapt_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+unsigned int SymTableAdapt_getLength(SymTableAdapt_T oSymTable);
+
+
+/* Returns the current representation of oSymTable: SYMTABLEADAPT_LIST,
+SYMTABLEADAPT_HASH, SYMTABLEADAPT_ORDERED or SYMTABLEADAPT_FROZEN.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type */
+int SymTableAdapt_getKind(SymTableAdapt_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableAdapt_put(SymTableAdapt_T oSymTable, const char *pcKey,
+        const void *pvValue);
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableAdapt_remove(SymTableAdapt_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableAdapt_contains(SymTableAdapt_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableAdapt_get(SymTableAdapt_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable. The order of
+the bindings depends on the representation: ordered and frozen tables are
+visited in key order. pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableAdapt_map(SymTableAdapt_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. pfApply must not change oSymTable.
+
+Asserts:
+1) if oSymTable and pfApply are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableAdapt_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableAdapt_range(SymTableAdapt_T oSymTable, const char *pcLow,
+        const char *pcHigh,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
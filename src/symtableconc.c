@@ -0,0 +1,996 @@
+/* Library for creating and using Symbol tables that can be shared by
+many threads.
+
+The bindings are distributed by hash in NSTRIPES lists. Each list is
+protected by its own read-write lock.
+
+Each thread can keep a cache of recent lookups. Writers increment the
+epoch of the table after every change, and a cached entry is used only if
+it was filled during the current epoch. The library has one thread key,
+whose value is the list of the caches of the thread, one per table.
+
+Snapshots are copy-on-write per stripe. Starting a snapshot increments the
+snapshot number of the table. The first writer that changes a stripe after
+that copies the stripe's bindings before changing them, so the copy holds
+the stripe as it was when the snapshot started. Stripes that are not
+changed are copied by the snapshot itself.
+
+A key that is being computed by SymTableConc_getOrCompute has a pending
+entry. Other threads that miss on the key wait for the entry instead of
+computing the value again. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symtableconc.h"
+
+#define HASH_MULTIPLIER 65599
+#define NSTRIPES 64
+#define CACHE_SIZE 256      /* entries in each thread cache */
+#define CACHE_KEY_MAX 32    /* longer keys are not cached */
+
+
+/* Struct that represents a binding in the symbol table. Each binding
+has a pointer to a character key, the hash of the key, a value and a
+pointer to the next binding. The value is either a pointer to any value or
+an integer counter used by SymTableConc_addInt.
+
+Note: A binding owns its key. A binding does not own its value. */
+struct cbind {
+    char *key;
+    union {
+        void *pvValue;
+        long lCount;
+    } value;
+    unsigned int hash;
+    struct cbind *next;
+};
+
+
+/* Struct that represents a list of bindings and the lock that protects
+it. saved is the copy of the list made for snapshot ulCopied, or NULL if
+the snapshot already took it. */
+struct cstripe {
+    pthread_rwlock_t lock;
+    struct cbind *first;
+    unsigned long ulCopied;
+    struct cbind *saved;
+};
+
+
+/* Struct that represents a value being computed by
+SymTableConc_getOrCompute. iRefs counts the computing thread and the
+waiting threads; the last one to leave frees the entry. */
+struct cpending {
+    char *key;
+    unsigned int hash;
+    int iDone;
+    int iRefs;
+    void *value;
+    struct cpending *next;
+};
+
+
+/* Struct that represents a cached lookup. The entry is valid only if
+ulEpoch is equal to the epoch of the table. */
+struct centry {
+    unsigned long ulEpoch;
+    unsigned int hash;
+    void *value;
+    char key[CACHE_KEY_MAX];
+};
+
+
+/* Struct that represents the lookup cache of a thread for symtable.
+Entries are selected by the hash of the key. prev and next link the caches
+of symtable, thread_next the caches of the thread. symtable is set to NULL
+when the table is freed, and the thread frees the cache later. */
+struct ccache {
+    struct SymTableConc *symtable;
+    struct ccache *prev, *next;
+    struct ccache *thread_next;
+    struct centry entries[CACHE_SIZE];
+};
+
+
+/* Struct that represents a symbol table as NSTRIPES lists of bindings.
+uiSize, ulEpoch and ulSnap are updated atomically. The caches of all
+threads are kept in a list protected by SymTableConc_cacheLock so that
+they can be released with the table. snap_lock lets one snapshot run at
+a time. The pending computations are kept in a list protected by
+pending_lock, and pending_done is signalled when one of them ends. */
+struct SymTableConc {
+    unsigned int uiSize;
+    unsigned long ulEpoch;
+    unsigned long ulSnap;
+    pthread_mutex_t snap_lock;
+    pthread_mutex_t pending_lock;
+    pthread_cond_t pending_done;
+    struct cpending *pending;
+    struct ccache *caches;
+    struct cstripe stripes[NSTRIPES];
+};
+
+
+/* The thread key of the caches, created once for all tables, and the lock
+of the lists of caches of all tables */
+static pthread_once_t SymTableConc_once = PTHREAD_ONCE_INIT;
+static pthread_key_t SymTableConc_cacheKey;
+static pthread_mutex_t SymTableConc_cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymTableConc_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Returns the stripe of symtable that contains the bindings with hash */
+static struct cstripe *SymTableConc_stripe(struct SymTableConc *symtable,
+    unsigned int hash) {
+    return &symtable->stripes[(hash ^ (hash >> 16)) % NSTRIPES];
+}
+
+
+/* Invalidates the thread caches of symtable. Must be called after every
+change to the bindings. */
+static void SymTableConc_bump(struct SymTableConc *symtable) {
+    __atomic_add_fetch(&symtable->ulEpoch, 1, __ATOMIC_RELEASE);
+}
+
+
+/* Returns a copy of the list of bindings starting at ptr
+
+Asserts: if necessary memory was allocated succesfully at runtime. */
+static struct cbind *SymTableConc_copy(struct cbind *ptr) {
+    struct cbind *first, **link;
+
+    link = &first;
+    while(ptr) {
+        *link = malloc(sizeof(struct cbind));
+        assert(*link);
+        **link = *ptr;
+        (*link)->key = malloc((strlen(ptr->key) + 1) * sizeof(char));
+        assert((*link)->key);
+        strcpy((*link)->key, ptr->key);
+        link = &(*link)->next;
+        ptr = ptr->next;
+    }
+    *link = NULL;
+
+    return first;
+}
+
+
+/* Frees the list of bindings starting at ptr */
+static void SymTableConc_freeList(struct cbind *ptr) {
+    struct cbind *ptr_next;
+
+    while(ptr) {
+        ptr_next = ptr->next;
+        free(ptr->key);
+        free(ptr);
+        ptr = ptr_next;
+    }
+}
+
+
+/* Returns 1 if stripe must be copied for the running snapshot before it
+is changed. The stripe must be locked by the caller. */
+static int SymTableConc_mustSave(struct SymTableConc *symtable,
+    struct cstripe *stripe) {
+    return stripe->ulCopied != __atomic_load_n(&symtable->ulSnap,
+                                               __ATOMIC_SEQ_CST);
+}
+
+
+/* Copies the bindings of stripe for the running snapshot, if it has not
+been copied yet. Must be called before every change to the bindings, with
+the stripe write-locked. */
+static void SymTableConc_save(struct SymTableConc *symtable,
+    struct cstripe *stripe) {
+    unsigned long snap;
+
+    snap = __atomic_load_n(&symtable->ulSnap, __ATOMIC_SEQ_CST);
+    if (stripe->ulCopied == snap) {
+        return;
+    }
+    stripe->saved = SymTableConc_copy(stripe->first);
+    stripe->ulCopied = snap;
+}
+
+
+/* Frees the caches of a thread that exits, removing them from the lists
+of their tables. Registered as the destructor of the cache key. */
+static void SymTableConc_cacheFree(void *pvCache) {
+    struct ccache *cache, *cache_next;
+    struct SymTableConc *symtable;
+
+    pthread_mutex_lock(&SymTableConc_cacheLock);
+    for (cache = pvCache; cache; cache = cache_next) {
+        cache_next = cache->thread_next;
+        symtable = __atomic_load_n(&cache->symtable, __ATOMIC_ACQUIRE);
+        if (symtable) {
+            if (cache->prev) {
+                cache->prev->next = cache->next;
+            }
+            else {
+                symtable->caches = cache->next;
+            }
+            if (cache->next) {
+                cache->next->prev = cache->prev;
+            }
+        }
+        free(cache);
+    }
+    pthread_mutex_unlock(&SymTableConc_cacheLock);
+}
+
+
+/* Creates the thread key of the caches. Called once. */
+static void SymTableConc_makeKey(void) {
+    int error;
+
+    error = pthread_key_create(&SymTableConc_cacheKey, SymTableConc_cacheFree);
+    assert(!error);
+}
+
+
+/* Returns the cache of the calling thread for symtable, creating it on
+first use. Caches of freed tables are freed on the way, and the returned
+cache is moved to the front of the list of the thread. */
+static struct ccache *SymTableConc_cache(struct SymTableConc *symtable) {
+    struct ccache *first, *cache, **link;
+    struct SymTableConc *owner;
+    int i;
+
+    pthread_once(&SymTableConc_once, SymTableConc_makeKey);
+    first = pthread_getspecific(SymTableConc_cacheKey);
+    link = &first;
+    while(*link) {
+        cache = *link;
+        owner = __atomic_load_n(&cache->symtable, __ATOMIC_ACQUIRE);
+        if (owner == symtable) {
+            break;
+        }
+        if (owner) {
+            link = &cache->thread_next;
+            continue;
+        }
+        *link = cache->thread_next;
+        free(cache);
+    }
+
+    cache = *link;
+    if (cache) {
+        *link = cache->thread_next;
+    }
+    else {
+        cache = malloc(sizeof(struct ccache));
+        assert(cache);
+        cache->symtable = symtable;
+        for (i = 0; i < CACHE_SIZE; i++) {
+            cache->entries[i].ulEpoch = 0;
+        }
+        pthread_mutex_lock(&SymTableConc_cacheLock);
+        cache->prev = NULL;
+        cache->next = symtable->caches;
+        if (cache->next) {
+            cache->next->prev = cache;
+        }
+        symtable->caches = cache;
+        pthread_mutex_unlock(&SymTableConc_cacheLock);
+    }
+    cache->thread_next = first;
+    if (cache != pthread_getspecific(SymTableConc_cacheKey)) {
+        pthread_setspecific(SymTableConc_cacheKey, cache);
+    }
+
+    return cache;
+}
+
+
+/* Finds in stripe the binding with key equal to pcKey. The stripe must be
+locked by the caller.
+
+Returns: the binding or NULL if such binding was not found */
+static struct cbind *SymTableConc_find(struct cstripe *stripe,
+    const char *pcKey, unsigned int hash) {
+    struct cbind *ptr;
+
+    ptr = stripe->first;
+    while(ptr) {
+        if (ptr->hash == hash && !strcmp(ptr->key, pcKey)) {
+            return ptr;
+        }
+        ptr = ptr->next;
+    }
+
+    return NULL;
+}
+
+
+/* Creates a new binding from pcKey and hash and inserts it first in
+stripe. The stripe must be write-locked by the caller.
+
+Asserts: if necessary memory was allocated succesfully at runtime.
+
+Returns: the new binding */
+static struct cbind *SymTableConc_insert(struct SymTableConc *symtable,
+    struct cstripe *stripe, const char *pcKey, unsigned int hash) {
+    struct cbind *new_bind;
+
+    new_bind = malloc(sizeof(struct cbind));
+    assert(new_bind);
+    new_bind->key = malloc((strlen(pcKey) + 1) * sizeof(char));
+    assert(new_bind->key);
+    strcpy(new_bind->key, pcKey);
+    new_bind->value.pvValue = NULL;
+    new_bind->hash = hash;
+
+    new_bind->next = stripe->first;
+    stripe->first = new_bind;
+    __atomic_add_fetch(&symtable->uiSize, 1, __ATOMIC_RELAXED);
+
+    return new_bind;
+}
+
+
+/* Creates a SymTableConc struct with no bindings.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableConc_T SymTableConc_new(void) {
+    struct SymTableConc *symtable;
+    int i;
+
+    symtable = malloc(sizeof(struct SymTableConc));
+    assert(symtable);
+    symtable->uiSize = 0U;
+
+    /* epoch 0 marks empty cache entries */
+    symtable->ulEpoch = 1;
+    symtable->caches = NULL;
+    symtable->ulSnap = 0;
+    pthread_mutex_init(&symtable->snap_lock, NULL);
+    pthread_mutex_init(&symtable->pending_lock, NULL);
+    pthread_cond_init(&symtable->pending_done, NULL);
+    symtable->pending = NULL;
+    for (i = 0; i < NSTRIPES; i++) {
+        pthread_rwlock_init(&symtable->stripes[i].lock, NULL);
+        symtable->stripes[i].first = NULL;
+        symtable->stripes[i].ulCopied = 0;
+        symtable->stripes[i].saved = NULL;
+    }
+
+    return (SymTableConc_T) symtable;
+}
+
+
+/* Frees all memory used by oSymTable. No other thread may use oSymTable
+during or after this call.
+
+Parameters:
+* oSymTable: a SymTableConc_T type */
+void SymTableConc_free(SymTableConc_T oSymTable) {
+    struct ccache *cache, *cache_next;
+    struct SymTableConc *symtable;
+    int i;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return;
+    }
+    for (i = 0; i < NSTRIPES; i++) {
+        SymTableConc_freeList(symtable->stripes[i].first);
+        SymTableConc_freeList(symtable->stripes[i].saved);
+        pthread_rwlock_destroy(&symtable->stripes[i].lock);
+    }
+    pthread_mutex_destroy(&symtable->snap_lock);
+    pthread_mutex_destroy(&symtable->pending_lock);
+    pthread_cond_destroy(&symtable->pending_done);
+
+    /* the caches belong to their threads, which free them when they see
+    that the table is gone */
+    pthread_mutex_lock(&SymTableConc_cacheLock);
+    cache = symtable->caches;
+    while(cache) {
+        cache_next = cache->next;
+        __atomic_store_n(&cache->symtable, NULL, __ATOMIC_RELEASE);
+        cache = cache_next;
+    }
+    pthread_mutex_unlock(&SymTableConc_cacheLock);
+    free(symtable);
+
+    return;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type */
+unsigned int SymTableConc_getLength(SymTableConc_T oSymTable) {
+    struct SymTableConc *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return __atomic_load_n(&symtable->uiSize, __ATOMIC_RELAXED);
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableConc_put(SymTableConc_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *new_bind;
+    unsigned int hash;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_wrlock(&stripe->lock);
+    if (SymTableConc_find(stripe, pcKey, hash)) {
+        pthread_rwlock_unlock(&stripe->lock);
+        return 0;
+    }
+    SymTableConc_save(symtable, stripe);
+    new_bind = SymTableConc_insert(symtable, stripe, pcKey, hash);
+    new_bind->value.pvValue = (void *) pvValue;
+    SymTableConc_bump(symtable);
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return 1;
+}
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableConc_remove(SymTableConc_T oSymTable, const char *pcKey) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr, **link;
+    unsigned int hash;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_wrlock(&stripe->lock);
+    link = &stripe->first;
+    while(*link) {
+        ptr = *link;
+        if (ptr->hash == hash && !strcmp(ptr->key, pcKey)) {
+            SymTableConc_save(symtable, stripe);
+            *link = ptr->next;
+            __atomic_sub_fetch(&symtable->uiSize, 1, __ATOMIC_RELAXED);
+            SymTableConc_bump(symtable);
+            pthread_rwlock_unlock(&stripe->lock);
+            free(ptr->key);
+            free(ptr);
+            return 1;
+        }
+        link = &ptr->next;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return 0;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableConc_contains(SymTableConc_T oSymTable, const char *pcKey) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    unsigned int hash;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_rdlock(&stripe->lock);
+    found = SymTableConc_find(stripe, pcKey, hash) != NULL;
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return found;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableConc_get(SymTableConc_T oSymTable, const char *pcKey) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    unsigned int hash;
+    void *value;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    value = ptr ? ptr->value.pvValue : NULL;
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return value;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey, like
+SymTableConc_get, using the lookup cache of the calling thread. Repeated
+lookups of the same key by a thread do not access the shared table until a
+writer changes oSymTable. Counters of SymTableConc_addInt are not cached.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if memory was allocated succesfully for the cache at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableConc_getCached(SymTableConc_T oSymTable, const char *pcKey) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    struct centry *entry;
+    unsigned int hash;
+    unsigned long epoch;
+    void *value;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    if (strlen(pcKey) >= CACHE_KEY_MAX) {
+        return SymTableConc_get(symtable, pcKey);
+    }
+
+    /* the epoch is read before the lookup: a change made after this point
+    increments the epoch and invalidates the entry filled below */
+    epoch = __atomic_load_n(&symtable->ulEpoch, __ATOMIC_ACQUIRE);
+    entry = &SymTableConc_cache(symtable)->entries[hash % CACHE_SIZE];
+    if (entry->ulEpoch == epoch && entry->hash == hash
+        && !strcmp(entry->key, pcKey)) {
+        return entry->value;
+    }
+
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    value = ptr ? ptr->value.pvValue : NULL;
+    pthread_rwlock_unlock(&stripe->lock);
+
+    entry->ulEpoch = epoch;
+    entry->hash = hash;
+    entry->value = value;
+    strcpy(entry->key, pcKey);
+
+    return value;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable. Bindings are
+visited one stripe at a time, and each stripe is locked while its bindings
+are visited, therefore pfApply must not modify oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableConc_map(SymTableConc_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableConc *symtable;
+    struct cbind *ptr;
+    int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    for (i = 0; i < NSTRIPES; i++) {
+        pthread_rwlock_rdlock(&symtable->stripes[i].lock);
+        ptr = symtable->stripes[i].first;
+        while(ptr) {
+            pfApply(ptr->key, ptr->value.pvValue, (void *) pvExtra);
+            ptr = ptr->next;
+        }
+        pthread_rwlock_unlock(&symtable->stripes[i].lock);
+    }
+}
+
+
+/* Applies function pfApply to every binding that was in oSymTable when
+the call started, with the value it had then. Writers are not blocked
+while pfApply runs, and pfApply may modify oSymTable. Only one snapshot
+runs at a time; other calls wait for it.
+
+Asserts:
+1) if oSymTable and pfApply are not NULL at runtime
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableConc_mapSnapshot(SymTableConc_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *list, *ptr;
+    unsigned long snap;
+    unsigned int count;
+    int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    pthread_mutex_lock(&symtable->snap_lock);
+
+    /* the snapshot is taken here: writers that read the new number copy
+    their stripe before changing it */
+    snap = __atomic_add_fetch(&symtable->ulSnap, 1, __ATOMIC_SEQ_CST);
+
+    count = 0;
+    for (i = 0; i < NSTRIPES; i++) {
+        stripe = &symtable->stripes[i];
+        pthread_rwlock_wrlock(&stripe->lock);
+        if (stripe->ulCopied == snap) {
+            list = stripe->saved;
+            stripe->saved = NULL;
+        }
+        else {
+            list = SymTableConc_copy(stripe->first);
+            stripe->ulCopied = snap;
+        }
+        pthread_rwlock_unlock(&stripe->lock);
+
+        for (ptr = list; ptr; ptr = ptr->next) {
+            pfApply(ptr->key, ptr->value.pvValue, (void *) pvExtra);
+            count++;
+        }
+        SymTableConc_freeList(list);
+    }
+    pthread_mutex_unlock(&symtable->snap_lock);
+
+    return count;
+}
+
+
+/* Finds in oSymTable the binding with key equal to pcKey, creating it with
+a NULL value if it does not exist, and replaces its value with the value
+returned by pfUpdate. The lookup and pfUpdate run atomically with respect
+to all other writers of the binding, therefore pfUpdate must not use
+oSymTable.
+
+Asserts:
+1) if oSymTable, pcKey and pfUpdate are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pfUpdate: function that returns the new value, given the current value
+(NULL for a new binding)
+* pvExtra: a pointer to any value. Used by pfUpdate.
+
+Returns: 1 if the binding was created, 0 if it already existed. */
+int SymTableConc_update(SymTableConc_T oSymTable, const char *pcKey,
+    void *(*pfUpdate)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    unsigned int hash;
+    int created;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+    assert(pfUpdate);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_wrlock(&stripe->lock);
+    SymTableConc_save(symtable, stripe);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    created = !ptr;
+    if (created) {
+        ptr = SymTableConc_insert(symtable, stripe, pcKey, hash);
+    }
+    ptr->value.pvValue = pfUpdate(ptr->key, ptr->value.pvValue, (void *) pvExtra);
+    SymTableConc_bump(symtable);
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return created;
+}
+
+
+/* Adds lDelta to the integer counter stored in the binding with key equal
+to pcKey, creating the binding with a counter of 0 if it does not exist.
+Counters are stored in place of the value pointer: a binding used with
+SymTableConc_addInt must only be read with SymTableConc_getInt.
+
+Incrementing an existing counter takes the shared lock of its stripe and
+adds atomically, so it does not exclude other readers or incrementers of
+the same stripe. It is not lock-free: writers of the stripe exclude it.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* lDelta: value to add
+
+Returns: the new value of the counter */
+long SymTableConc_addInt(SymTableConc_T oSymTable, const char *pcKey, long lDelta) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    unsigned int hash;
+    long count;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+
+    /* shared path: the binding exists, the shared lock keeps it alive and
+    the counter is updated atomically. This is not lock-free: a lookup
+    without the lock would need the removed bindings to be reclaimed
+    safely. A stripe that must be copied for a snapshot takes the
+    exclusive path. */
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    if (ptr && !SymTableConc_mustSave(symtable, stripe)) {
+        count = __atomic_add_fetch(&ptr->value.lCount, lDelta, __ATOMIC_RELAXED);
+        pthread_rwlock_unlock(&stripe->lock);
+        return count;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    /* exclusive path: another thread may have created the binding after
+    the shared lock was released */
+    pthread_rwlock_wrlock(&stripe->lock);
+    SymTableConc_save(symtable, stripe);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    if (!ptr) {
+        ptr = SymTableConc_insert(symtable, stripe, pcKey, hash);
+        ptr->value.lCount = 0;
+        SymTableConc_bump(symtable);
+    }
+    count = __atomic_add_fetch(&ptr->value.lCount, lDelta, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return count;
+}
+
+
+/* Returns the integer counter stored in the binding with key equal to
+pcKey by SymTableConc_addInt.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: the value of the counter or 0 if such binding was not found. */
+long SymTableConc_getInt(SymTableConc_T oSymTable, const char *pcKey) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    unsigned int hash;
+    long count;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    count = ptr ? __atomic_load_n(&ptr->value.lCount, __ATOMIC_RELAXED) : 0;
+    pthread_rwlock_unlock(&stripe->lock);
+
+    return count;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey. If there is none,
+binds pcKey to the value returned by pfCompute. When several threads miss
+on the same key, only one of them calls pfCompute and the others wait for
+its value. pfCompute is called without holding any lock and may use
+oSymTable, but not to compute pcKey again.
+
+Asserts:
+1) if oSymTable, pcKey and pfCompute are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pfCompute: function that returns the value of a missing key
+* pvExtra: a pointer to any value. Used by pfCompute.
+
+Returns: the value bound to pcKey. If another thread put pcKey with
+SymTableConc_put while pfCompute was running, that value is kept and
+returned. */
+void* SymTableConc_getOrCompute(SymTableConc_T oSymTable, const char *pcKey,
+    void *(*pfCompute)(const char *pcKey, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableConc *symtable;
+    struct cstripe *stripe;
+    struct cbind *ptr;
+    struct cpending *pending, **link;
+    unsigned int hash;
+    void *value;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+    assert(pfCompute);
+
+    hash = SymTableConc_hash(pcKey);
+    stripe = SymTableConc_stripe(symtable, hash);
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    value = ptr ? ptr->value.pvValue : NULL;
+    pthread_rwlock_unlock(&stripe->lock);
+    if (ptr) {
+        return value;
+    }
+
+    pthread_mutex_lock(&symtable->pending_lock);
+    pending = symtable->pending;
+    while(pending) {
+        if (pending->hash == hash && !strcmp(pending->key, pcKey)) {
+            break;
+        }
+        pending = pending->next;
+    }
+
+    /* another thread computes the value: wait for it */
+    if (pending) {
+        pending->iRefs++;
+        while(!pending->iDone) {
+            pthread_cond_wait(&symtable->pending_done, &symtable->pending_lock);
+        }
+        value = pending->value;
+        if (--pending->iRefs == 0) {
+            free(pending->key);
+            free(pending);
+        }
+        pthread_mutex_unlock(&symtable->pending_lock);
+        return value;
+    }
+
+    /* a computation that ended after the first lookup has already put its
+    value in the table before removing its pending entry */
+    pthread_rwlock_rdlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    value = ptr ? ptr->value.pvValue : NULL;
+    pthread_rwlock_unlock(&stripe->lock);
+    if (ptr) {
+        pthread_mutex_unlock(&symtable->pending_lock);
+        return value;
+    }
+
+    pending = malloc(sizeof(struct cpending));
+    assert(pending);
+    pending->key = malloc((strlen(pcKey) + 1) * sizeof(char));
+    assert(pending->key);
+    strcpy(pending->key, pcKey);
+    pending->hash = hash;
+    pending->iDone = 0;
+    pending->iRefs = 1;
+    pending->next = symtable->pending;
+    symtable->pending = pending;
+    pthread_mutex_unlock(&symtable->pending_lock);
+
+    value = pfCompute(pcKey, (void *) pvExtra);
+
+    pthread_rwlock_wrlock(&stripe->lock);
+    ptr = SymTableConc_find(stripe, pcKey, hash);
+    if (ptr) {
+        value = ptr->value.pvValue;
+    }
+    else {
+        SymTableConc_save(symtable, stripe);
+        ptr = SymTableConc_insert(symtable, stripe, pcKey, hash);
+        ptr->value.pvValue = value;
+        SymTableConc_bump(symtable);
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    pthread_mutex_lock(&symtable->pending_lock);
+    link = &symtable->pending;
+    while(*link != pending) {
+        link = &(*link)->next;
+    }
+    *link = pending->next;
+    pending->value = value;
+    pending->iDone = 1;
+    pthread_cond_broadcast(&symtable->pending_done);
+    if (--pending->iRefs == 0) {
+        free(pending->key);
+        free(pending);
+    }
+    pthread_mutex_unlock(&symtable->pending_lock);
+
+    return value;
+}
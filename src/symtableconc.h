@@ -0,0 +1,221 @@
+/* Library for creating and using Symbol tables that can be shared by
+many threads */
+
+#ifndef SYMTABLECONC_INCLUDE
+#define SYMTABLECONC_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymTableConc_T;
+
+
+/* Creates a SymTableConc struct with no bindings.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableConc_T SymTableConc_new(void);
+
+
+/* Frees all memory used by oSymTable. No other thread may use oSymTable
+during or after this call.
+
+Parameters:
+* oSymTable: a SymTableConc_T type */
+void SymTableConc_free(SymTableConc_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type */
+unsigned int SymTableConc_getLength(SymTableConc_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableConc_put(SymTableConc_T oSymTable, const char *pcKey, const void *pvValue);
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableConc_remove(SymTableConc_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableConc_contains(SymTableConc_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableConc_get(SymTableConc_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey, like
+SymTableConc_get, using the lookup cache of the calling thread. Repeated
+lookups of the same key by a thread do not access the shared table until a
+writer changes oSymTable. Counters of SymTableConc_addInt are not cached.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if memory was allocated succesfully for the cache at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableConc_getCached(SymTableConc_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable. Bindings are
+visited one stripe at a time, and each stripe is locked while its bindings
+are visited, therefore pfApply must not modify oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableConc_map(SymTableConc_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Applies function pfApply to every binding that was in oSymTable when
+the call started, with the value it had then. Writers are not blocked
+while pfApply runs, and pfApply may modify oSymTable. Only one snapshot
+runs at a time; other calls wait for it.
+
+Asserts:
+1) if oSymTable and pfApply are not NULL at runtime
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableConc_mapSnapshot(SymTableConc_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Finds in oSymTable the binding with key equal to pcKey, creating it with
+a NULL value if it does not exist, and replaces its value with the value
+returned by pfUpdate. The lookup and pfUpdate run atomically with respect
+to all other writers of the binding, therefore pfUpdate must not use
+oSymTable.
+
+Asserts:
+1) if oSymTable, pcKey and pfUpdate are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pfUpdate: function that returns the new value, given the current value
+(NULL for a new binding)
+* pvExtra: a pointer to any value. Used by pfUpdate.
+
+Returns: 1 if the binding was created, 0 if it already existed. */
+int SymTableConc_update(SymTableConc_T oSymTable, const char *pcKey,
+        void *(*pfUpdate)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Adds lDelta to the integer counter stored in the binding with key equal
+to pcKey, creating the binding with a counter of 0 if it does not exist.
+Counters are stored in place of the value pointer: a binding used with
+SymTableConc_addInt must only be read with SymTableConc_getInt.
+
+Incrementing an existing counter takes the shared lock of its stripe and
+adds atomically, so it does not exclude other readers or incrementers of
+the same stripe. It is not lock-free: writers of the stripe exclude it.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* lDelta: value to add
+
+Returns: the new value of the counter */
+long SymTableConc_addInt(SymTableConc_T oSymTable, const char *pcKey, long lDelta);
+
+
+/* Returns the integer counter stored in the binding with key equal to
+pcKey by SymTableConc_addInt.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: the value of the counter or 0 if such binding was not found. */
+long SymTableConc_getInt(SymTableConc_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey. If there is none,
+binds pcKey to the value returned by pfCompute. When several threads miss
+on the same key, only one of them calls pfCompute and the others wait for
+its value. pfCompute is called without holding any lock and may use
+oSymTable, but not to compute pcKey again.
+
+Asserts:
+1) if oSymTable, pcKey and pfCompute are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableConc_T type
+* pcKey: a character array (key). Must be null terminated.
+* pfCompute: function that returns the value of a missing key
+* pvExtra: a pointer to any value. Used by pfCompute.
+
+Returns: the value bound to pcKey. If another thread put pcKey with
+SymTableConc_put while pfCompute was running, that value is kept and
+returned. */
+void* SymTableConc_getOrCompute(SymTableConc_T oSymTable, const char *pcKey,
+        void *(*pfCompute)(const char *pcKey, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
@@ -0,0 +1,916 @@
+/* Library for creating and using Symbol tables stored in a file.
+
+The file is an array of SYMTABLEDISK_PAGE byte pages. Page 0 holds the
+root page number, the number of pages and the number of bindings. The
+other pages are nodes of a B+-tree:
+
+* a page starts with a header: type (leaf or internal), used bytes and a
+link, which is the next leaf for leaves and the first child for internal
+nodes.
+* the header is followed by entries sorted by key. An entry is the key
+length and value length (2 bytes each), the key and the value. The value
+of an internal entry is the 4 byte number of the child that holds the keys
+>= the key of the entry.
+
+Pages are read with pread into a buffer pool of a fixed number of frames
+and written back with pwrite when they are evicted (clock replacement) or
+when the table is closed. All numbers are stored big endian.
+
+A page is pinned only while it is used: an insert unpins each internal node
+before it descends to the child and pins it again only if the child was
+split, so at most two pages are pinned at any time. A failed read or write
+marks the table as failed and every later operation returns an error. */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "symtabledisk.h"
+
+#define PAGE SYMTABLEDISK_PAGE
+#define MAX_ENTRY SYMTABLEDISK_MAX_ENTRY
+
+#define PAGE_HEADER 8       /* type, used bytes (offset 2), link (offset 4) */
+#define ENTRY_HEADER 4      /* key length, value length */
+#define PAGE_LEAF 1
+#define PAGE_INTERNAL 2
+#define NO_PAGE (~0UL)      /* frame that holds no page */
+
+#define META_MAGIC "SYMTDSK1"
+
+
+/* Struct that represents a frame of the buffer pool. iUsed is the
+reference bit of the clock and iPins the number of users of the page. */
+struct dframe {
+    unsigned long ulPage;
+    int iDirty;
+    int iUsed;
+    int iPins;
+    unsigned char *data;
+};
+
+
+/* Struct that represents a symbol table stored in a file. frame_of maps
+every page number to the frame that holds it, or -1. tmp holds the entries
+of a page that is split, sep the key that separates the two halves, and
+key and value the binding returned by a get or passed to a scan
+function. iFailed is 1 after a page could not be read or written. */
+struct SymTableDisk {
+    int fd;
+    int iFailed;
+    unsigned long ulRoot;
+    unsigned long ulPages;
+    unsigned int uiSize;
+    unsigned long ulReads, ulWrites;
+    struct dframe *frames;
+    unsigned int uiFrames;
+    unsigned int uiHand;
+    int *frame_of;
+    unsigned long ulMapSize;
+    unsigned char tmp[2 * PAGE];
+    unsigned char sep[MAX_ENTRY];
+    size_t uiSepLen;
+    char key[MAX_ENTRY + 1];
+    char value[MAX_ENTRY + 1];
+};
+
+
+/* Writes value to dst as 2 bytes */
+static void SymTableDisk_put16(unsigned char *dst, unsigned int value) {
+    dst[0] = (value >> 8) & 0xff;
+    dst[1] = value & 0xff;
+}
+
+
+/* Returns the 2 byte number stored at src */
+static unsigned int SymTableDisk_get16(const unsigned char *src) {
+    return ((unsigned int) src[0] << 8) | src[1];
+}
+
+
+/* Writes value to dst as 4 bytes */
+static void SymTableDisk_put32(unsigned char *dst, unsigned long value) {
+    dst[0] = (value >> 24) & 0xff;
+    dst[1] = (value >> 16) & 0xff;
+    dst[2] = (value >> 8) & 0xff;
+    dst[3] = value & 0xff;
+}
+
+
+/* Returns the 4 byte number stored at src */
+static unsigned long SymTableDisk_get32(const unsigned char *src) {
+    return ((unsigned long) src[0] << 24) | ((unsigned long) src[1] << 16) |
+           ((unsigned long) src[2] << 8) | src[3];
+}
+
+
+/* Returns the size of the entry at entry */
+static size_t SymTableDisk_entrySize(const unsigned char *entry) {
+    return ENTRY_HEADER + SymTableDisk_get16(entry) + SymTableDisk_get16(entry + 2);
+}
+
+
+/* Compares the key of entry with pcKey of length uiLen in strcmp order.
+
+Returns: <0, 0 or >0 if the key of entry is less, equal or greater */
+static int SymTableDisk_compare(const unsigned char *entry, const char *pcKey,
+    size_t uiLen) {
+    size_t len;
+    int cmp;
+
+    len = SymTableDisk_get16(entry);
+    cmp = memcmp(entry + ENTRY_HEADER, pcKey, len < uiLen ? len : uiLen);
+    if (cmp) {
+        return cmp;
+    }
+
+    return len < uiLen ? -1 : len > uiLen;
+}
+
+
+/* Writes an entry with pcKey and pvValue to entry.
+
+Returns: the size of the entry */
+static size_t SymTableDisk_makeEntry(unsigned char *entry, const void *pcKey,
+    size_t uiKeyLen, const void *pvValue, size_t uiValueLen) {
+    SymTableDisk_put16(entry, uiKeyLen);
+    SymTableDisk_put16(entry + 2, uiValueLen);
+    memcpy(entry + ENTRY_HEADER, pcKey, uiKeyLen);
+    memcpy(entry + ENTRY_HEADER + uiKeyLen, pvValue, uiValueLen);
+
+    return ENTRY_HEADER + uiKeyLen + uiValueLen;
+}
+
+
+/* Writes page of symtable from frame to the file.
+
+Returns: 1 if the page was written, 0 if the write failed */
+static int SymTableDisk_write(struct SymTableDisk *symtable,
+    struct dframe *frame) {
+    ssize_t n;
+
+    n = pwrite(symtable->fd, frame->data, PAGE, (off_t) frame->ulPage * PAGE);
+    if (n != PAGE) {
+        symtable->iFailed = 1;
+        return 0;
+    }
+    frame->iDirty = 0;
+    symtable->ulWrites++;
+
+    return 1;
+}
+
+
+/* Returns the data of page, reading it into a frame if it is not in
+memory. A page that was never written (iNew) is filled with zeros instead.
+The page stays in memory until SymTableDisk_unpin. Returns NULL if the
+page could not be read or the evicted page could not be written. */
+static unsigned char *SymTableDisk_pin(struct SymTableDisk *symtable,
+    unsigned long page, int iNew) {
+    struct dframe *frame;
+    unsigned long i;
+    unsigned int tries;
+    ssize_t n;
+
+    if (page < symtable->ulMapSize && symtable->frame_of[page] >= 0) {
+        frame = &symtable->frames[symtable->frame_of[page]];
+        frame->iPins++;
+        frame->iUsed = 1;
+        return frame->data;
+    }
+
+    /* clock: evict the first unpinned frame whose reference bit is clear */
+    for (tries = 0; ; tries++) {
+        assert(tries < 3 * symtable->uiFrames);
+        frame = &symtable->frames[symtable->uiHand];
+        symtable->uiHand = (symtable->uiHand + 1) % symtable->uiFrames;
+        if (frame->iPins) {
+            continue;
+        }
+        if (frame->iUsed) {
+            frame->iUsed = 0;
+            continue;
+        }
+        break;
+    }
+    if (frame->ulPage != NO_PAGE) {
+        if (frame->iDirty && !SymTableDisk_write(symtable, frame)) {
+            return NULL;
+        }
+        symtable->frame_of[frame->ulPage] = -1;
+        frame->ulPage = NO_PAGE;
+    }
+
+    if (page >= symtable->ulMapSize) {
+        i = symtable->ulMapSize;
+        while(page >= symtable->ulMapSize) {
+            symtable->ulMapSize *= 2;
+        }
+        symtable->frame_of = realloc(symtable->frame_of,
+                                     symtable->ulMapSize * sizeof(int));
+        assert(symtable->frame_of);
+        for (; i < symtable->ulMapSize; i++) {
+            symtable->frame_of[i] = -1;
+        }
+    }
+
+    if (iNew) {
+        memset(frame->data, 0, PAGE);
+    }
+    else {
+        n = pread(symtable->fd, frame->data, PAGE, (off_t) page * PAGE);
+        if (n != PAGE) {
+            symtable->iFailed = 1;
+            return NULL;
+        }
+        symtable->ulReads++;
+    }
+    frame->ulPage = page;
+    frame->iDirty = iNew;
+    frame->iUsed = 1;
+    frame->iPins = 1;
+    symtable->frame_of[page] = frame - symtable->frames;
+
+    return frame->data;
+}
+
+
+/* Releases page after SymTableDisk_pin. iDirty is 1 if the page was
+changed. */
+static void SymTableDisk_unpin(struct SymTableDisk *symtable,
+    unsigned long page, int iDirty) {
+    struct dframe *frame;
+
+    frame = &symtable->frames[symtable->frame_of[page]];
+    frame->iPins--;
+    frame->iDirty |= iDirty;
+}
+
+
+/* Adds an empty page of type iType to the end of the file and sets page
+to its number.
+
+Returns: the data of the page, which is pinned, or NULL if no frame could
+be freed for it */
+static unsigned char *SymTableDisk_newPage(struct SymTableDisk *symtable,
+    int iType, unsigned long *page) {
+    unsigned char *data;
+
+    *page = symtable->ulPages;
+    data = SymTableDisk_pin(symtable, *page, 1);
+    if (!data) {
+        return NULL;
+    }
+    symtable->ulPages++;
+    data[0] = iType;
+    SymTableDisk_put16(data + 2, PAGE_HEADER);
+
+    return data;
+}
+
+
+/* Finds the entry of data with key pcKey of length uiLen.
+
+Returns: the offset of the entry, or of the first entry with a greater key
+(the end of the entries if there is none). found is set to 1 if the entry
+was found, 0 otherwise. */
+static size_t SymTableDisk_search(const unsigned char *data,
+    const char *pcKey, size_t uiLen, int *found) {
+    size_t offset, used;
+    int cmp;
+
+    used = SymTableDisk_get16(data + 2);
+    for (offset = PAGE_HEADER; offset < used;
+         offset += SymTableDisk_entrySize(data + offset)) {
+        cmp = SymTableDisk_compare(data + offset, pcKey, uiLen);
+        if (cmp >= 0) {
+            *found = !cmp;
+            return offset;
+        }
+    }
+    *found = 0;
+
+    return used;
+}
+
+
+/* Finds the child of the internal node data that holds pcKey.
+
+Returns: the child. offset is set to the offset of the first entry with
+a key greater than pcKey. */
+static unsigned long SymTableDisk_child(const unsigned char *data,
+    const char *pcKey, size_t uiLen, size_t *offset) {
+    unsigned long child;
+    size_t used;
+
+    child = SymTableDisk_get32(data + 4);
+    used = SymTableDisk_get16(data + 2);
+    for (*offset = PAGE_HEADER; *offset < used;
+         *offset += SymTableDisk_entrySize(data + *offset)) {
+        if (SymTableDisk_compare(data + *offset, pcKey, uiLen) > 0) {
+            break;
+        }
+        child = SymTableDisk_get32(data + *offset + ENTRY_HEADER +
+                                   SymTableDisk_get16(data + *offset));
+    }
+
+    return child;
+}
+
+
+/* Returns the leaf that holds pcKey, or the first leaf if pcKey is NULL.
+Returns 0 (the meta page) if a page could not be read. */
+static unsigned long SymTableDisk_leaf(struct SymTableDisk *symtable,
+    const char *pcKey) {
+    unsigned long page, child;
+    unsigned char *data;
+    size_t offset;
+
+    page = symtable->ulRoot;
+    while(1) {
+        data = SymTableDisk_pin(symtable, page, 0);
+        if (!data) {
+            return 0;
+        }
+        if (data[0] == PAGE_LEAF) {
+            SymTableDisk_unpin(symtable, page, 0);
+            return page;
+        }
+        if (pcKey) {
+            child = SymTableDisk_child(data, pcKey, strlen(pcKey), &offset);
+        }
+        else {
+            child = SymTableDisk_get32(data + 4);
+        }
+        SymTableDisk_unpin(symtable, page, 0);
+        page = child;
+    }
+}
+
+
+/* Inserts entry of size uiSize at offset of page, whose data is pinned.
+If the page is full, it is split in two pages of about the same size:
+right is set to the new right page and sep to the first key of the right
+page, otherwise right is set to 0.
+
+For an internal node the middle entry moves up: its key becomes sep and
+its child the first child of the right page.
+
+Returns: 1 if the entry was inserted, 0 if the new page could not be
+created. The page is not changed then. */
+static int SymTableDisk_add(struct SymTableDisk *symtable,
+    unsigned long page, unsigned char *data, size_t offset,
+    const unsigned char *entry, size_t uiSize, unsigned long *right) {
+    unsigned char *right_data, *middle;
+    size_t used, total, split, middle_size;
+
+    *right = 0;
+    used = SymTableDisk_get16(data + 2);
+    if (used + uiSize <= PAGE) {
+        memmove(data + offset + uiSize, data + offset, used - offset);
+        memcpy(data + offset, entry, uiSize);
+        SymTableDisk_put16(data + 2, used + uiSize);
+        return 1;
+    }
+
+    right_data = SymTableDisk_newPage(symtable, data[0], right);
+    if (!right_data) {
+        *right = 0;
+        return 0;
+    }
+
+    /* all entries with the new one, split at half of their size */
+    total = used - PAGE_HEADER + uiSize;
+    memcpy(symtable->tmp, data + PAGE_HEADER, offset - PAGE_HEADER);
+    memcpy(symtable->tmp + offset - PAGE_HEADER, entry, uiSize);
+    memcpy(symtable->tmp + offset - PAGE_HEADER + uiSize, data + offset,
+           used - offset);
+    for (split = 0; split < total / 2;
+         split += SymTableDisk_entrySize(symtable->tmp + split));
+
+    middle = symtable->tmp + split;
+    symtable->uiSepLen = SymTableDisk_get16(middle);
+    memcpy(symtable->sep, middle + ENTRY_HEADER, symtable->uiSepLen);
+
+    memcpy(data + PAGE_HEADER, symtable->tmp, split);
+    SymTableDisk_put16(data + 2, PAGE_HEADER + split);
+    if (data[0] == PAGE_LEAF) {
+        memcpy(right_data + PAGE_HEADER, middle, total - split);
+        SymTableDisk_put16(right_data + 2, PAGE_HEADER + total - split);
+        memcpy(right_data + 4, data + 4, 4);
+        SymTableDisk_put32(data + 4, *right);
+    }
+    else {
+        middle_size = SymTableDisk_entrySize(middle);
+        memcpy(right_data + 4, middle + ENTRY_HEADER + symtable->uiSepLen, 4);
+        memcpy(right_data + PAGE_HEADER, middle + middle_size,
+               total - split - middle_size);
+        SymTableDisk_put16(right_data + 2,
+                           PAGE_HEADER + total - split - middle_size);
+    }
+    SymTableDisk_unpin(symtable, *right, 1);
+
+    return 1;
+}
+
+
+/* Inserts (pcKey, pcValue) in the subtree of page. If page was split,
+right is set to the new right page and sep to its first key, otherwise
+right is set to 0.
+
+Returns: 1 if the binding was created, 0 if pcKey exists, -1 if a page
+could not be read or written */
+static int SymTableDisk_insert(struct SymTableDisk *symtable,
+    unsigned long page, const char *pcKey, const char *pcValue,
+    unsigned long *right) {
+    unsigned char *data, entry[ENTRY_HEADER + MAX_ENTRY], child_page[4];
+    unsigned long child, child_right;
+    size_t offset, size;
+    int found, created;
+
+    *right = 0;
+    data = SymTableDisk_pin(symtable, page, 0);
+    if (!data) {
+        return -1;
+    }
+    if (data[0] == PAGE_LEAF) {
+        offset = SymTableDisk_search(data, pcKey, strlen(pcKey), &found);
+        if (found) {
+            SymTableDisk_unpin(symtable, page, 0);
+            return 0;
+        }
+        size = SymTableDisk_makeEntry(entry, pcKey, strlen(pcKey), pcValue,
+                                      strlen(pcValue));
+        if (!SymTableDisk_add(symtable, page, data, offset, entry, size, right)) {
+            SymTableDisk_unpin(symtable, page, 0);
+            return -1;
+        }
+        SymTableDisk_unpin(symtable, page, 1);
+        return 1;
+    }
+
+    /* the page is unpinned while the subtree of child changes and pinned
+    again if child was split. offset stays valid, since only the subtree
+    changes, and the entry for the split child goes there. */
+    child = SymTableDisk_child(data, pcKey, strlen(pcKey), &offset);
+    SymTableDisk_unpin(symtable, page, 0);
+    created = SymTableDisk_insert(symtable, child, pcKey, pcValue, &child_right);
+    if (created < 0 || !child_right) {
+        return created;
+    }
+    data = SymTableDisk_pin(symtable, page, 0);
+    if (!data) {
+        return -1;
+    }
+    SymTableDisk_put32(child_page, child_right);
+    size = SymTableDisk_makeEntry(entry, symtable->sep, symtable->uiSepLen,
+                                  child_page, 4);
+    if (!SymTableDisk_add(symtable, page, data, offset, entry, size, right)) {
+        SymTableDisk_unpin(symtable, page, 0);
+        return -1;
+    }
+    SymTableDisk_unpin(symtable, page, 1);
+
+    return created;
+}
+
+
+/* Opens the table stored in the file pcPath, or creates an empty table if
+the file does not exist or is empty. At most uiPages pages are kept in
+memory.
+
+Asserts:
+1) if pcPath is not NULL and uiPages is >= 8 at runtime.
+2) if memory was allocated succesfully for oSymTable at runtime.
+
+Parameters:
+* pcPath: path of the file. Must be null terminated.
+* uiPages: number of pages in the buffer pool
+
+Returns: a SymTableDisk_T type or NULL if the file could not be opened or
+does not contain a table. */
+SymTableDisk_T SymTableDisk_open(const char *pcPath, unsigned int uiPages) {
+    struct SymTableDisk *symtable;
+    unsigned char meta[PAGE];
+    unsigned int i;
+    ssize_t n;
+    int fd;
+
+    assert(pcPath);
+    assert(uiPages >= 8);
+
+    fd = open(pcPath, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    n = pread(fd, meta, PAGE, 0);
+    if (n != 0 && (n != PAGE || memcmp(meta, META_MAGIC, 8))) {
+        close(fd);
+        return NULL;
+    }
+
+    symtable = malloc(sizeof(struct SymTableDisk));
+    assert(symtable);
+    symtable->fd = fd;
+    symtable->iFailed = 0;
+    symtable->ulReads = 0;
+    symtable->ulWrites = 0;
+    symtable->uiFrames = uiPages;
+    symtable->uiHand = 0;
+    symtable->frames = malloc(uiPages * sizeof(struct dframe));
+    assert(symtable->frames);
+    for (i = 0; i < uiPages; i++) {
+        symtable->frames[i].ulPage = NO_PAGE;
+        symtable->frames[i].iDirty = 0;
+        symtable->frames[i].iUsed = 0;
+        symtable->frames[i].iPins = 0;
+        symtable->frames[i].data = malloc(PAGE);
+        assert(symtable->frames[i].data);
+    }
+    symtable->ulMapSize = 1024;
+    symtable->frame_of = malloc(symtable->ulMapSize * sizeof(int));
+    assert(symtable->frame_of);
+    for (i = 0; i < symtable->ulMapSize; i++) {
+        symtable->frame_of[i] = -1;
+    }
+
+    if (n == 0) {
+
+        /* new file: page 0 is the meta page, page 1 an empty leaf */
+        symtable->ulPages = 1;
+        symtable->uiSize = 0;
+        SymTableDisk_newPage(symtable, PAGE_LEAF, &symtable->ulRoot);
+        SymTableDisk_unpin(symtable, symtable->ulRoot, 1);
+    }
+    else {
+        symtable->ulRoot = SymTableDisk_get32(meta + 8);
+        symtable->ulPages = SymTableDisk_get32(meta + 12);
+        symtable->uiSize = SymTableDisk_get32(meta + 16);
+    }
+
+    return (SymTableDisk_T) symtable;
+}
+
+
+/* Writes all changed pages of oSymTable to its file, closes the file and
+frees all memory used by oSymTable. Changes are not guaranteed to be in
+the file before this call.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+
+Returns: 1 if all pages were read and written succesfully since the table
+was opened, 0 otherwise. The file may then not hold all changes. */
+int SymTableDisk_close(SymTableDisk_T oSymTable) {
+    struct SymTableDisk *symtable;
+    unsigned char meta[PAGE];
+    unsigned int i;
+    ssize_t n;
+    int ok;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return 1;
+    }
+    for (i = 0; i < symtable->uiFrames; i++) {
+        if (symtable->frames[i].ulPage != NO_PAGE && symtable->frames[i].iDirty) {
+            SymTableDisk_write(symtable, &symtable->frames[i]);
+        }
+        free(symtable->frames[i].data);
+    }
+
+    /* the meta page is written last */
+    memset(meta, 0, PAGE);
+    memcpy(meta, META_MAGIC, 8);
+    SymTableDisk_put32(meta + 8, symtable->ulRoot);
+    SymTableDisk_put32(meta + 12, symtable->ulPages);
+    SymTableDisk_put32(meta + 16, symtable->uiSize);
+    n = pwrite(symtable->fd, meta, PAGE, 0);
+    ok = n == PAGE && !symtable->iFailed;
+    close(symtable->fd);
+
+    free(symtable->frames);
+    free(symtable->frame_of);
+    free(symtable);
+
+    return ok;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type */
+unsigned int SymTableDisk_getLength(SymTableDisk_T oSymTable) {
+    struct SymTableDisk *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->uiSize;
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pcValue.
+
+Asserts:
+1) if oSymTable, pcKey and pcValue are not NULL at runtime.
+2) if the length of pcKey plus the length of pcValue is at most
+SYMTABLEDISK_MAX_ENTRY at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+* pcValue: a character array (value). Must be null terminated.
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey, -1 if a page could not be read or
+written. */
+int SymTableDisk_put(SymTableDisk_T oSymTable, const char *pcKey,
+    const char *pcValue) {
+    struct SymTableDisk *symtable;
+    unsigned char *data, entry[ENTRY_HEADER + MAX_ENTRY], child_page[4];
+    unsigned long right, root;
+    size_t size;
+    int created;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+    assert(pcValue);
+    assert(strlen(pcKey) + strlen(pcValue) <= MAX_ENTRY);
+
+    if (symtable->iFailed) {
+        return -1;
+    }
+    created = SymTableDisk_insert(symtable, symtable->ulRoot, pcKey, pcValue,
+                                  &right);
+    if (created < 0) {
+        return -1;
+    }
+    if (right) {
+
+        /* the root was split: the new root points to both halves */
+        data = SymTableDisk_newPage(symtable, PAGE_INTERNAL, &root);
+        if (!data) {
+            return -1;
+        }
+        SymTableDisk_put32(data + 4, symtable->ulRoot);
+        SymTableDisk_put32(child_page, right);
+        size = SymTableDisk_makeEntry(entry, symtable->sep, symtable->uiSepLen,
+                                      child_page, 4);
+        memcpy(data + PAGE_HEADER, entry, size);
+        SymTableDisk_put16(data + 2, PAGE_HEADER + size);
+        SymTableDisk_unpin(symtable, root, 1);
+        symtable->ulRoot = root;
+    }
+    symtable->uiSize += created;
+
+    return created;
+}
+
+
+/* Removes from oSymTable the binding with key equal to pcKey. Pages that
+become empty stay in the file and are not merged with their neighbours.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was succesful, 0 if key was not found, -1 if a page
+could not be read or written */
+int SymTableDisk_remove(SymTableDisk_T oSymTable, const char *pcKey) {
+    struct SymTableDisk *symtable;
+    unsigned long page;
+    unsigned char *data;
+    size_t offset, size, used;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    if (symtable->iFailed) {
+        return -1;
+    }
+    page = SymTableDisk_leaf(symtable, pcKey);
+    data = page ? SymTableDisk_pin(symtable, page, 0) : NULL;
+    if (!data) {
+        return -1;
+    }
+    offset = SymTableDisk_search(data, pcKey, strlen(pcKey), &found);
+    if (!found) {
+        SymTableDisk_unpin(symtable, page, 0);
+        return 0;
+    }
+    size = SymTableDisk_entrySize(data + offset);
+    used = SymTableDisk_get16(data + 2);
+    memmove(data + offset, data + offset + size, used - offset - size);
+    SymTableDisk_put16(data + 2, used - size);
+    SymTableDisk_unpin(symtable, page, 1);
+    symtable->uiSize--;
+
+    return 1;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 if not found, -1 if a page could not be
+read or written */
+int SymTableDisk_contains(SymTableDisk_T oSymTable, const char *pcKey) {
+    if (SymTableDisk_get(oSymTable, pcKey)) {
+        return 1;
+    }
+
+    return SymTableDisk_failed(oSymTable) ? -1 : 0;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: the value, which is valid until the next call on oSymTable, or
+NULL if such binding was not found or a page could not be read or
+written (see SymTableDisk_failed). */
+const char *SymTableDisk_get(SymTableDisk_T oSymTable, const char *pcKey) {
+    struct SymTableDisk *symtable;
+    unsigned long page;
+    unsigned char *data;
+    size_t offset, len;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    if (symtable->iFailed) {
+        return NULL;
+    }
+    page = SymTableDisk_leaf(symtable, pcKey);
+    data = page ? SymTableDisk_pin(symtable, page, 0) : NULL;
+    if (!data) {
+        return NULL;
+    }
+    offset = SymTableDisk_search(data, pcKey, strlen(pcKey), &found);
+    if (found) {
+        len = SymTableDisk_get16(data + offset + 2);
+        memcpy(symtable->value, data + offset + ENTRY_HEADER +
+               SymTableDisk_get16(data + offset), len);
+        symtable->value[len] = '\0';
+    }
+    SymTableDisk_unpin(symtable, page, 0);
+
+    return found ? symtable->value : NULL;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+pfApply must not change oSymTable.
+
+Stops early if a page could not be read or written (see
+SymTableDisk_failed).
+
+Asserts: if oSymTable and pfApply are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableDisk_map(SymTableDisk_T oSymTable,
+    void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+    const void *pvExtra) {
+    SymTableDisk_range(oSymTable, NULL, NULL, pfApply, pvExtra);
+}
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. pfApply must not change oSymTable.
+
+Stops early if a page could not be read or written (see
+SymTableDisk_failed).
+
+Asserts: if oSymTable and pfApply are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableDisk_range(SymTableDisk_T oSymTable, const char *pcLow,
+    const char *pcHigh,
+    void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableDisk *symtable;
+    unsigned long page, next;
+    unsigned char *data, *entry;
+    size_t offset, used, key_len, value_len;
+    unsigned int count;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    count = 0;
+    if (symtable->iFailed) {
+        return 0;
+    }
+    page = SymTableDisk_leaf(symtable, pcLow);
+    while(page) {
+        data = SymTableDisk_pin(symtable, page, 0);
+        if (!data) {
+            return count;
+        }
+        offset = PAGE_HEADER;
+        if (pcLow) {
+            offset = SymTableDisk_search(data, pcLow, strlen(pcLow), &found);
+        }
+        used = SymTableDisk_get16(data + 2);
+        for (; offset < used; offset += SymTableDisk_entrySize(entry)) {
+            entry = data + offset;
+            if (pcHigh && SymTableDisk_compare(entry, pcHigh, strlen(pcHigh)) >= 0) {
+                SymTableDisk_unpin(symtable, page, 0);
+                return count;
+            }
+            key_len = SymTableDisk_get16(entry);
+            value_len = SymTableDisk_get16(entry + 2);
+            memcpy(symtable->key, entry + ENTRY_HEADER, key_len);
+            symtable->key[key_len] = '\0';
+            memcpy(symtable->value, entry + ENTRY_HEADER + key_len, value_len);
+            symtable->value[value_len] = '\0';
+            pfApply(symtable->key, symtable->value, (void *) pvExtra);
+            count++;
+        }
+        next = SymTableDisk_get32(data + 4);
+        SymTableDisk_unpin(symtable, page, 0);
+        page = next;
+    }
+
+    return count;
+}
+
+
+/* Returns the number of pages read from and written to the file of
+oSymTable since it was opened.
+
+Asserts: if oSymTable, pulReads and pulWrites are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pulReads: set to the number of pages read
+* pulWrites: set to the number of pages written */
+void SymTableDisk_getIO(SymTableDisk_T oSymTable, unsigned long *pulReads,
+    unsigned long *pulWrites) {
+    struct SymTableDisk *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pulReads);
+    assert(pulWrites);
+
+    *pulReads = symtable->ulReads;
+    *pulWrites = symtable->ulWrites;
+}
+
+
+/* Checks whether a page of oSymTable could not be read or written since
+it was opened. After such an error every operation fails, and the last
+failed put may be partly done.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+
+Returns: 1 if a read or write failed, 0 otherwise */
+int SymTableDisk_failed(SymTableDisk_T oSymTable) {
+    struct SymTableDisk *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->iFailed;
+}
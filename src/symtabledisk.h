@@ -0,0 +1,184 @@
+/* Library for creating and using Symbol tables stored in a file.
+
+The bindings are kept in a B+-tree of fixed size pages. Only a fixed
+number of pages is kept in memory, so a table can be much larger than the
+memory it uses. Keys and values are character arrays.
+
+If a page cannot be read or written, the operation returns an error and so
+does every later operation on the table (see SymTableDisk_failed). */
+
+#ifndef SYMTABLEDISK_INCLUDE
+#define SYMTABLEDISK_INCLUDE
+
+#include <stdio.h>
+
+#define SYMTABLEDISK_PAGE 4096      /* bytes in a page */
+#define SYMTABLEDISK_MAX_ENTRY 1024 /* maximum length of key + value */
+
+typedef void* SymTableDisk_T;
+
+
+/* Opens the table stored in the file pcPath, or creates an empty table if
+the file does not exist or is empty. At most uiPages pages are kept in
+memory.
+
+Asserts:
+1) if pcPath is not NULL and uiPages is >= 8 at runtime.
+2) if memory was allocated succesfully for oSymTable at runtime.
+
+Parameters:
+* pcPath: path of the file. Must be null terminated.
+* uiPages: number of pages in the buffer pool
+
+Returns: a SymTableDisk_T type or NULL if the file could not be opened or
+does not contain a table. */
+SymTableDisk_T SymTableDisk_open(const char *pcPath, unsigned int uiPages);
+
+
+/* Writes all changed pages of oSymTable to its file, closes the file and
+frees all memory used by oSymTable. Changes are not guaranteed to be in
+the file before this call.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+
+Returns: 1 if all pages were read and written succesfully since the table
+was opened, 0 otherwise. The file may then not hold all changes. */
+int SymTableDisk_close(SymTableDisk_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type */
+unsigned int SymTableDisk_getLength(SymTableDisk_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pcValue.
+
+Asserts:
+1) if oSymTable, pcKey and pcValue are not NULL at runtime.
+2) if the length of pcKey plus the length of pcValue is at most
+SYMTABLEDISK_MAX_ENTRY at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+* pcValue: a character array (value). Must be null terminated.
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey, -1 if a page could not be read or
+written. */
+int SymTableDisk_put(SymTableDisk_T oSymTable, const char *pcKey,
+        const char *pcValue);
+
+
+/* Removes from oSymTable the binding with key equal to pcKey. Pages that
+become empty stay in the file and are not merged with their neighbours.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was succesful, 0 if key was not found, -1 if a page
+could not be read or written */
+int SymTableDisk_remove(SymTableDisk_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 if not found, -1 if a page could not be
+read or written */
+int SymTableDisk_contains(SymTableDisk_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: the value, which is valid until the next call on oSymTable, or
+NULL if such binding was not found or a page could not be read or
+written (see SymTableDisk_failed). */
+const char *SymTableDisk_get(SymTableDisk_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+pfApply must not change oSymTable.
+
+Stops early if a page could not be read or written (see
+SymTableDisk_failed).
+
+Asserts: if oSymTable and pfApply are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableDisk_map(SymTableDisk_T oSymTable,
+        void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. pfApply must not change oSymTable.
+
+Stops early if a page could not be read or written (see
+SymTableDisk_failed).
+
+Asserts: if oSymTable and pfApply are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableDisk_range(SymTableDisk_T oSymTable, const char *pcLow,
+        const char *pcHigh,
+        void (*pfApply)(const char *pcKey, const char *pcValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Returns the number of pages read from and written to the file of
+oSymTable since it was opened.
+
+Asserts: if oSymTable, pulReads and pulWrites are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+* pulReads: set to the number of pages read
+* pulWrites: set to the number of pages written */
+void SymTableDisk_getIO(SymTableDisk_T oSymTable, unsigned long *pulReads,
+        unsigned long *pulWrites);
+
+
+/* Checks whether a page of oSymTable could not be read or written since
+it was opened. After such an error every operation fails, and the last
+failed put may be partly done.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableDisk_T type
+
+Returns: 1 if a read or write failed, 0 otherwise */
+int SymTableDisk_failed(SymTableDisk_T oSymTable);
+
+
+#endif
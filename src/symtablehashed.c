@@ -0,0 +1,397 @@
+/* Library for creating and using Symbol tables that do not store their
+keys.
+
+The 128-bit hash of a key is MurmurHash3 (x86, 128-bit variant), which
+only needs 32-bit arithmetic. Its four 32-bit parts are stored in two
+unsigned longs. The bindings are kept in a hash table of lists, selected
+by the low bits of the first word, that doubles its size when it has more
+bindings than lists. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "symtablehashed.h"
+
+#define HASHED_MIN_BUCKETS 16
+#define HASHED_SEED 0x9747b28cU
+
+/* joins two 32-bit parts of the hash in a word, keeping only the low part
+if unsigned long has 32 bits */
+#if ULONG_MAX > 0xffffffffUL
+#define HASHED_WORD(high, low) ((unsigned long) (high) << 16 << 16 | (low))
+#else
+#define HASHED_WORD(high, low) ((unsigned long) (low))
+#endif
+
+
+/* Struct that represents a binding in the symbol table: the hash of its
+key, a pointer to any value and a pointer to the next binding.
+
+Note: A binding does not own its value. */
+struct hbind {
+    unsigned long words[2];
+    void *value;
+    struct hbind *next;
+};
+
+
+/* Struct that represents a symbol table as uiBuckets lists of bindings */
+struct SymTableHashed {
+    unsigned int uiSize;
+    struct hbind **buckets;
+    unsigned int uiBuckets;
+};
+
+
+/* Returns x rotated left by r bits, as a 32-bit number */
+static unsigned int SymTableHashed_rotl(unsigned int x, int r) {
+    x &= 0xffffffffU;
+    return ((x << r) | (x >> (32 - r))) & 0xffffffffU;
+}
+
+
+/* Returns h with all of its bits mixed, as a 32-bit number */
+static unsigned int SymTableHashed_fmix(unsigned int h) {
+    h &= 0xffffffffU;
+    h ^= h >> 16;
+    h = (h * 0x85ebca6bU) & 0xffffffffU;
+    h ^= h >> 13;
+    h = (h * 0xc2b2ae35U) & 0xffffffffU;
+    h ^= h >> 16;
+
+    return h;
+}
+
+
+/* Returns the 32-bit little endian number at p */
+static unsigned int SymTableHashed_get32(const unsigned char *p) {
+    return (unsigned int) p[0] | (unsigned int) p[1] << 8 |
+           (unsigned int) p[2] << 16 | (unsigned int) p[3] << 24;
+}
+
+
+/* Computes the 128-bit hash of pcKey into words */
+static void SymTableHashed_hash(const char *pcKey, unsigned long *words) {
+    const unsigned char *data, *tail;
+    unsigned int h1, h2, h3, h4, k1, k2, k3, k4;
+    unsigned int c1, c2, c3, c4;
+    size_t len, i;
+
+    data = (const unsigned char *) pcKey;
+    len = 0;
+    while(pcKey[len]) {
+        len++;
+    }
+    h1 = h2 = h3 = h4 = HASHED_SEED;
+    c1 = 0x239b961bU;
+    c2 = 0xab0e9789U;
+    c3 = 0x38b34ae5U;
+    c4 = 0xa1e38b93U;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        k1 = SymTableHashed_get32(data + i);
+        k2 = SymTableHashed_get32(data + i + 4);
+        k3 = SymTableHashed_get32(data + i + 8);
+        k4 = SymTableHashed_get32(data + i + 12);
+
+        k1 *= c1; k1 = SymTableHashed_rotl(k1, 15); k1 *= c2; h1 ^= k1;
+        h1 = SymTableHashed_rotl(h1, 19); h1 += h2; h1 = h1 * 5 + 0x561ccd1bU;
+        k2 *= c2; k2 = SymTableHashed_rotl(k2, 16); k2 *= c3; h2 ^= k2;
+        h2 = SymTableHashed_rotl(h2, 17); h2 += h3; h2 = h2 * 5 + 0x0bcaa747U;
+        k3 *= c3; k3 = SymTableHashed_rotl(k3, 17); k3 *= c4; h3 ^= k3;
+        h3 = SymTableHashed_rotl(h3, 15); h3 += h4; h3 = h3 * 5 + 0x96cd1c35U;
+        k4 *= c4; k4 = SymTableHashed_rotl(k4, 18); k4 *= c1; h4 ^= k4;
+        h4 = SymTableHashed_rotl(h4, 13); h4 += h1; h4 = h4 * 5 + 0x32ac3b17U;
+    }
+
+    /* the last len % 16 bytes */
+    tail = data + i;
+    k1 = k2 = k3 = k4 = 0;
+    switch (len & 15) {
+    case 15: k4 ^= (unsigned int) tail[14] << 16;
+    case 14: k4 ^= (unsigned int) tail[13] << 8;
+    case 13: k4 ^= tail[12];
+        k4 *= c4; k4 = SymTableHashed_rotl(k4, 18); k4 *= c1; h4 ^= k4;
+    case 12: k3 ^= (unsigned int) tail[11] << 24;
+    case 11: k3 ^= (unsigned int) tail[10] << 16;
+    case 10: k3 ^= (unsigned int) tail[9] << 8;
+    case 9: k3 ^= tail[8];
+        k3 *= c3; k3 = SymTableHashed_rotl(k3, 17); k3 *= c4; h3 ^= k3;
+    case 8: k2 ^= (unsigned int) tail[7] << 24;
+    case 7: k2 ^= (unsigned int) tail[6] << 16;
+    case 6: k2 ^= (unsigned int) tail[5] << 8;
+    case 5: k2 ^= tail[4];
+        k2 *= c2; k2 = SymTableHashed_rotl(k2, 16); k2 *= c3; h2 ^= k2;
+    case 4: k1 ^= (unsigned int) tail[3] << 24;
+    case 3: k1 ^= (unsigned int) tail[2] << 16;
+    case 2: k1 ^= (unsigned int) tail[1] << 8;
+    case 1: k1 ^= tail[0];
+        k1 *= c1; k1 = SymTableHashed_rotl(k1, 15); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (unsigned int) len; h2 ^= (unsigned int) len;
+    h3 ^= (unsigned int) len; h4 ^= (unsigned int) len;
+    h1 += h2; h1 += h3; h1 += h4;
+    h2 += h1; h3 += h1; h4 += h1;
+    h1 = SymTableHashed_fmix(h1);
+    h2 = SymTableHashed_fmix(h2);
+    h3 = SymTableHashed_fmix(h3);
+    h4 = SymTableHashed_fmix(h4);
+    h1 += h2; h1 += h3; h1 += h4;
+    h2 += h1; h3 += h1; h4 += h1;
+
+    words[0] = HASHED_WORD(h2 & 0xffffffffU, h1 & 0xffffffffU);
+    words[1] = HASHED_WORD(h4 & 0xffffffffU, h3 & 0xffffffffU);
+    return;
+}
+
+
+/* Finds the link (the first pointer of a list or the next pointer of a
+binding) that points to the binding with hash words, or the link at the
+end of its list if there is no such binding */
+static struct hbind **SymTableHashed_locate(struct SymTableHashed *symtable,
+    const unsigned long *words) {
+    struct hbind **link;
+
+    link = &symtable->buckets[words[0] & (symtable->uiBuckets - 1)];
+    while(*link) {
+        if ((*link)->words[0] == words[0] && (*link)->words[1] == words[1]) {
+            return link;
+        }
+        link = &(*link)->next;
+    }
+
+    return link;
+}
+
+
+/* Doubles the number of lists of symtable */
+static void SymTableHashed_grow(struct SymTableHashed *symtable) {
+    struct hbind **buckets, *ptr, *ptr_next;
+    unsigned int i, size;
+
+    size = symtable->uiBuckets * 2;
+    buckets = calloc(size, sizeof(struct hbind *));
+    assert(buckets);
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+            ptr_next = ptr->next;
+            ptr->next = buckets[ptr->words[0] & (size - 1)];
+            buckets[ptr->words[0] & (size - 1)] = ptr;
+        }
+    }
+    free(symtable->buckets);
+    symtable->buckets = buckets;
+    symtable->uiBuckets = size;
+    return;
+}
+
+
+/* Creates a SymTableHashed struct with no bindings.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableHashed_T SymTableHashed_new(void) {
+    struct SymTableHashed *symtable;
+
+    symtable = malloc(sizeof(struct SymTableHashed));
+    assert(symtable);
+    symtable->uiSize = 0U;
+    symtable->uiBuckets = HASHED_MIN_BUCKETS;
+    symtable->buckets = calloc(symtable->uiBuckets, sizeof(struct hbind *));
+    assert(symtable->buckets);
+
+    return (SymTableHashed_T) symtable;
+}
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type */
+void SymTableHashed_free(SymTableHashed_T oSymTable) {
+    struct SymTableHashed *symtable;
+    struct hbind *ptr, *ptr_next;
+    unsigned int i;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return;
+    }
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+            ptr_next = ptr->next;
+            free(ptr);
+        }
+    }
+    free(symtable->buckets);
+    free(symtable);
+    return;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type */
+unsigned int SymTableHashed_getLength(SymTableHashed_T oSymTable) {
+    struct SymTableHashed *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->uiSize;
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+pcKey is not stored.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableHashed_put(SymTableHashed_T oSymTable, const char *pcKey,
+        const void *pvValue) {
+    struct SymTableHashed *symtable;
+    struct hbind **link, *new_bind;
+    unsigned long words[2];
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    SymTableHashed_hash(pcKey, words);
+    link = SymTableHashed_locate(symtable, words);
+    if (*link) {
+        return 0;
+    }
+
+    new_bind = malloc(sizeof(struct hbind));
+    assert(new_bind);
+    new_bind->words[0] = words[0];
+    new_bind->words[1] = words[1];
+    new_bind->value = (void *) pvValue;
+    new_bind->next = NULL;
+    *link = new_bind;
+
+    symtable->uiSize++;
+    if (symtable->uiSize > symtable->uiBuckets) {
+        SymTableHashed_grow(symtable);
+    }
+
+    return 1;
+}
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableHashed_remove(SymTableHashed_T oSymTable, const char *pcKey) {
+    struct SymTableHashed *symtable;
+    struct hbind **link, *ptr;
+    unsigned long words[2];
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    SymTableHashed_hash(pcKey, words);
+    link = SymTableHashed_locate(symtable, words);
+    ptr = *link;
+    if (!ptr) {
+        return 0;
+    }
+    *link = ptr->next;
+    free(ptr);
+    symtable->uiSize--;
+
+    return 1;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableHashed_contains(SymTableHashed_T oSymTable, const char *pcKey) {
+    unsigned long words[2];
+
+    assert(oSymTable);
+    assert(pcKey);
+
+    SymTableHashed_hash(pcKey, words);
+
+    return *SymTableHashed_locate(oSymTable, words) != NULL;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableHashed_get(SymTableHashed_T oSymTable, const char *pcKey) {
+    struct hbind **link;
+    unsigned long words[2];
+
+    assert(oSymTable);
+    assert(pcKey);
+
+    SymTableHashed_hash(pcKey, words);
+    link = SymTableHashed_locate(oSymTable, words);
+
+    return *link ? (*link)->value : NULL;
+}
+
+
+/* Applies function pfApply to the value of every binding in oSymTable.
+The keys are not known. pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableHashed_map(SymTableHashed_T oSymTable,
+        void (*pfApply)(void *pvValue, void *pvExtra),
+        const void *pvExtra) {
+    struct SymTableHashed *symtable;
+    struct hbind *ptr;
+    unsigned int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr->next) {
+            pfApply(ptr->value, (void *) pvExtra);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/* Library for creating and using Symbol tables that do not store their
+keys.
+
+A binding keeps a 128-bit hash of its key instead of a copy of the key, so
+every binding has the same small size and keys are compared as two words.
+Two different keys are taken as equal if their hashes are equal. With n
+keys, the probability that any two of them have the same hash is about
+n^2 / 2^129, less than 10^-20 for a billion keys. On platforms where
+unsigned long has 32 bits the hash has 64 bits and the probability is
+about n^2 / 2^65, 3% for a billion keys and 3 * 10^-8 for a million. */
+
+#ifndef SYMTABLEHASHED_INCLUDE
+#define SYMTABLEHASHED_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymTableHashed_T;
+
+
+/* Creates a SymTableHashed struct with no bindings.
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableHashed_T SymTableHashed_new(void);
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type */
+void SymTableHashed_free(SymTableHashed_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type */
+unsigned int SymTableHashed_getLength(SymTableHashed_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+pcKey is not stored.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableHashed_put(SymTableHashed_T oSymTable, const char *pcKey,
+        const void *pvValue);
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTableHashed_remove(SymTableHashed_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableHashed_contains(SymTableHashed_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableHashed_get(SymTableHashed_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to the value of every binding in oSymTable.
+The keys are not known. pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableHashed_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableHashed_map(SymTableHashed_T oSymTable,
+        void (*pfApply)(void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
@@ -3,30 +3,287 @@
 List based implementation */
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "symtable.h"
+#include "symtablelist.h"
 
+/* this file defines the out-of-line versions of the inline functions */
+#undef SymTable_getLength
+#undef SymTable_contains
+#undef SymTable_get
 
-/* Struct that represents a binding in the symbol table. Each binding
-has a pointer to a character key, a pointer to any value and a pointer to
-the next binding.
+#ifdef SYMTABLE_STATS
+struct SymTableStats SymTable_stats;
+#endif
 
-Note: A binding owns its key. A binding does not own its value. */
-struct abind {
-    char *key;
-    void *value;
-    struct abind *next;
-};
 
+/* Returns the number of bytes used by a binding with key pcKey */
+static size_t SymTable_bindSize(const char *pcKey) {
+    return sizeof(struct abind) + (strlen(pcKey) + 1) * sizeof(char);
+}
+
+
+/* Returns the number of bytes that a new binding with key pcKey adds to
+symtable. A spare binding of a block is already charged, so only its key
+is. */
+static size_t SymTable_newSize(struct SymTable *symtable, const char *pcKey) {
+    size_t bind_size;
+
+    bind_size = SymTable_bindSize(pcKey);
+    if (symtable->spare) {
+        bind_size -= sizeof(struct abind);
+    }
+
+    return bind_size;
+}
 
-/* Struct that represents a symbol table as a list of bindings. Only the
-number of bindings and a pointer to the first binding are required. */
-struct SymTable {
-    unsigned int uiSize;
-    struct abind *first;
-};
+
+/* Creates a new binding for symtable from a given pcKey, its hash and
+pvValue. The binding is not inserted in the list, and must already be
+charged to the budget of symtable (SymTable_newSize bytes).
+
+Asserts: if necessary memory was allocated succesfully at runtime.
+
+Returns: the new binding */
+static struct abind *SymTable_newBind(struct SymTable *symtable,
+    const char *pcKey, unsigned int hash, const void *pvValue) {
+    struct abind *new_bind;
+    char *new_key;
+    size_t bind_size;
+
+    bind_size = SymTable_newSize(symtable, pcKey);
+
+    /* allocate memory for a new binding + key, unless a block has an
+    unused binding */
+    if (symtable->spare) {
+        new_bind = symtable->spare;
+        symtable->spare = new_bind->next;
+        new_bind->iInBlock = BIND_IN_BLOCK;
+    }
+    else {
+        new_bind = malloc(sizeof(struct abind));
+        assert(new_bind);
+        SYMTABLE_COUNT(ulAllocs);
+        new_bind->iInBlock = 0;
+    }
+    new_key = malloc((strlen(pcKey) + 1) * sizeof(char));
+    assert(new_key);
+    SYMTABLE_COUNT(ulAllocs);
+
+    /* copy pcKey into new_key */
+    strcpy(new_key, pcKey);
+
+    /* initialize binding */
+    new_bind->key = new_key;        
+    new_bind->value = (void *) pvValue;
+    new_bind->hash = hash;
+    new_bind->uiGeneration = symtable->uiGeneration;
+    new_bind->next = NULL;
+
+    symtable->uiBytes += bind_size;
+
+    return new_bind;
+}
+
+
+/* Frees bind and its key, unless they are part of a block. A binding of
+a block becomes a spare binding of symtable. */
+static void SymTable_freeBind(struct SymTable *symtable, struct abind *bind) {
+    if (!(bind->iInBlock & KEY_IN_BLOCK)) {
+        free(bind->key);
+    }
+    if (bind->iInBlock & BIND_IN_BLOCK) {
+        bind->next = symtable->spare;
+        symtable->spare = bind;
+    }
+    else {
+        free(bind);
+    }
+}
+
+
+/* Removes bind, a binding of symtable that is no longer in its list,
+from the memory used by symtable and frees it */
+static void SymTable_deleteBind(struct SymTable *symtable, struct abind *bind) {
+    size_t bind_size;
+
+    /* a binding of a block stays charged as a spare binding */
+    bind_size = SymTable_bindSize(bind->key);
+    if (bind->iInBlock & BIND_IN_BLOCK) {
+        bind_size -= sizeof(struct abind);
+    }
+    symtable->uiBytes -= bind_size;
+    if (symtable->oBudget) {
+        SymBudget_release(symtable->oBudget, bind_size);
+    }
+    SymTable_freeBind(symtable, bind);
+}
+
+
+/* Counts bind, a new binding of symtable, and appends it to the dense
+array in SYMTABLE_RANDOM mode.
+
+Asserts: if necessary memory was allocated succesfully at runtime. */
+static void SymTable_addDense(struct SymTable *symtable, struct abind *bind) {
+    if (!(symtable->iMode & SYMTABLE_RANDOM)) {
+        symtable->uiSize += 1;
+        return;
+    }
+    if (symtable->uiSize == symtable->uiDenseCap) {
+        symtable->uiDenseCap = symtable->uiDenseCap ?
+                               2 * symtable->uiDenseCap : 16U;
+        symtable->dense = realloc(symtable->dense,
+                                  symtable->uiDenseCap * sizeof(struct abind *));
+        assert(symtable->dense);
+        SYMTABLE_COUNT(ulAllocs);
+    }
+    bind->uiIndex = symtable->uiSize;
+    symtable->dense[symtable->uiSize] = bind;
+    symtable->uiSize += 1;
+}
+
+
+/* Uncounts bind, a binding of symtable, and in SYMTABLE_RANDOM mode
+removes it from the dense array by moving the last entry to its position */
+static void SymTable_removeDense(struct SymTable *symtable, struct abind *bind) {
+    struct abind *last;
+
+    symtable->uiSize -= 1;
+    if (!(symtable->iMode & SYMTABLE_RANDOM)) {
+        return;
+    }
+    last = symtable->dense[symtable->uiSize];
+    last->uiIndex = bind->uiIndex;
+    symtable->dense[bind->uiIndex] = last;
+}
+
+
+/* Replaces the key of bind, a stale binding of symtable, with pcKey. The
+old key is overwritten if pcKey fits in it. A longer key must already be
+charged to the budget of symtable, a shorter one is released from it.
+
+Asserts: if necessary memory was allocated succesfully at runtime. */
+static void SymTable_rekey(struct SymTable *symtable, struct abind *bind,
+    const char *pcKey, unsigned int hash) {
+    size_t old_size, new_size;
+    char *new_key;
+
+    old_size = SymTable_bindSize(bind->key);
+    new_size = SymTable_bindSize(pcKey);
+    if (new_size > old_size) {
+        new_key = malloc((strlen(pcKey) + 1) * sizeof(char));
+        assert(new_key);
+        SYMTABLE_COUNT(ulAllocs);
+        if (!(bind->iInBlock & KEY_IN_BLOCK)) {
+            free(bind->key);
+        }
+        bind->iInBlock &= ~KEY_IN_BLOCK;
+        bind->key = new_key;
+    }
+    else if (symtable->oBudget) {
+        SymBudget_release(symtable->oBudget, old_size - new_size);
+    }
+    strcpy(bind->key, pcKey);
+    bind->hash = hash;
+    symtable->uiBytes = symtable->uiBytes - old_size + new_size;
+}
+
+
+/* Binds pcKey to pvValue in symtable, given the link returned by
+SymTable_locate for pcKey when no live binding was found. A stale binding
+of pcKey, which in an unsorted table is searched for after the live
+bindings, is revived; otherwise the first stale binding of an unsorted
+table, or the stale binding at link in a sorted table, gets the new key,
+and a new binding is created only if there is none. Unsorted tables put
+the binding first, sorted tables at link.
+
+The binding is charged to the budget of symtable before it is changed or
+created. A shrink callback run by the charge may change symtable and free
+the binding that link points into, which is seen from the version of
+symtable: the charge is then returned and the caller must locate pcKey
+again.
+
+Asserts: if necessary memory was allocated succesfully at runtime.
+
+Returns: 1 if pcKey was bound, 0 if the budget rejected the binding, -1 if
+symtable changed during the charge */
+static int SymTable_insert(struct SymTable *symtable, struct abind **link,
+    const char *pcKey, unsigned int hash, const void *pvValue) {
+    struct abind *bind;
+    unsigned long version;
+    size_t bytes;
+    int rekey;
+
+    if (!symtable->iSorted) {
+        while(*link && SymTable_compare(*link, hash, pcKey)) {
+            SYMTABLE_COUNT(ulVisits);
+            link = &(*link)->next;
+        }
+    }
+    bytes = 0;
+    rekey = 0;
+    bind = *link;
+    if (!bind || SymTable_compare(bind, hash, pcKey)) {
+        /* there is no stale binding of pcKey */
+        if (!symtable->iSorted) {
+            link = symtable->stale;
+            bind = *link;
+        }
+        if (bind && bind->uiGeneration != symtable->uiGeneration) {
+            rekey = 1;
+            if (SymTable_bindSize(pcKey) > SymTable_bindSize(bind->key)) {
+                bytes = SymTable_bindSize(pcKey) - SymTable_bindSize(bind->key);
+            }
+        }
+        else {
+            bind = NULL;
+            bytes = SymTable_newSize(symtable, pcKey);
+        }
+    }
+
+    if (bytes && symtable->oBudget) {
+        version = symtable->ulVersion;
+        if (!SymBudget_charge(symtable->oBudget, bytes)) {
+            return 0;
+        }
+        if (version != symtable->ulVersion) {
+            SymBudget_release(symtable->oBudget, bytes);
+            return -1;
+        }
+    }
+
+    if (!bind) {
+        bind = SymTable_newBind(symtable, pcKey, hash, pvValue);
+        if (symtable->iSorted) {
+            bind->next = *link;
+            *link = bind;
+        }
+        link = NULL;
+    }
+    else if (rekey) {
+        SymTable_rekey(symtable, bind, pcKey, hash);
+    }
+    bind->value = (void *) pvValue;
+    bind->uiGeneration = symtable->uiGeneration;
+    symtable->ulVersion++;
+
+    /* unlink a reused binding of an unsorted table and put it first */
+    if (!symtable->iSorted) {
+        if (link) {
+            *link = bind->next;
+        }
+        bind->next = symtable->first;
+        symtable->first = bind;
+        if (symtable->stale == &symtable->first) {
+            symtable->stale = &bind->next;
+        }
+    }
+    SymTable_addDense(symtable, bind);
+
+    return 1;
+}
 
 
 /* Creates a SymTable struct with no bindings.
@@ -37,8 +294,36 @@ SymTable_T SymTable_new(void) {
 
     symtable = malloc(sizeof(struct SymTable));
     assert(symtable);
+    SYMTABLE_COUNT(ulAllocs);
     symtable->uiSize = 0U;
     symtable->first = NULL;
+    symtable->iSorted = 0;
+    symtable->iMode = 0;
+    symtable->uiBytes = 0;
+    symtable->oBudget = NULL;
+    symtable->blocks = NULL;
+    symtable->spare = NULL;
+    symtable->dense = NULL;
+    symtable->uiDenseCap = 0U;
+    symtable->uiGeneration = 0U;
+    symtable->stale = &symtable->first;
+    symtable->ulVersion = 0UL;
+
+    return (SymTable_T) symtable;
+}
+
+
+/* Creates a SymTable struct with no bindings that keeps its bindings
+ordered by (hash, key). A lookup for a missing key stops as soon as it
+passes the position of the key, and sorted tables can be merged in
+linear time. SymTable_map visits the bindings in (hash, key) order.
+
+Checks: if memory was allocated succesfully for oSymTable at runtime. */
+SymTable_T SymTable_newSorted(void) {
+    struct SymTable *symtable;
+
+    symtable = SymTable_new();
+    symtable->iSorted = 1;
 
     return (SymTable_T) symtable;
 }
@@ -50,6 +335,7 @@ Parameters:
 * oSymTable: a SymTable_T type */
 void SymTable_free(SymTable_T oSymTable) {
     struct abind *ptr, *ptr_next;
+    struct ablock *block, *block_next;
     struct SymTable *symtable;
 
     symtable = oSymTable;
@@ -60,29 +346,247 @@ void SymTable_free(SymTable_T oSymTable) {
     while(ptr) {
         /* remember pointer to next binding before deleting current */
         ptr_next = ptr->next;
-        free(ptr->key); 
-        free(ptr);
+        SymTable_freeBind(symtable, ptr);
         ptr = ptr_next;
     }
+    block = symtable->blocks;
+    while(block) {
+        block_next = block->next;
+        free(block);
+        block = block_next;
+    }
+    if (symtable->oBudget) {
+        SymBudget_release(symtable->oBudget, symtable->uiBytes);
+    }
+    free(symtable->dense);
     free(symtable);
 
     return;
 }
 
 
-/* Returns the number of bindings in oSymTable.
+/* Creates a copy of oSymTable with the same bindings in the same order.
+The copy has its own keys and shares the values of oSymTable. All bindings
+and keys are allocated in one block, so copying takes linear time and one
+allocation. The block is freed by SymTable_free; bindings removed from the
+copy are released from the budget but their memory is kept until then.
+
+The copy is sorted if oSymTable is sorted, and is attached to the budget
+of oSymTable.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+
+Returns: a SymTable_T type or NULL if the budget of oSymTable rejected the
+copy. */
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    struct SymTable *symtable, *clone;
+    struct abind *ptr, *bind, **link;
+    struct ablock *block;
+    char *key;
+    size_t key_bytes, bytes, charged;
+    unsigned long version;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    /* stale bindings are not copied. A shrink callback run by the charge
+    may change oSymTable, and then the keys are counted again and only the
+    difference is charged or released. */
+    charged = 0;
+    while(1) {
+        key_bytes = 0;
+        for (ptr = symtable->first; ptr; ptr = ptr->next) {
+            if (ptr->uiGeneration == symtable->uiGeneration) {
+                key_bytes += strlen(ptr->key) + 1;
+            }
+        }
+        bytes = symtable->uiSize * sizeof(struct abind) + key_bytes;
+        if (!symtable->oBudget) {
+            break;
+        }
+        if (bytes <= charged) {
+            SymBudget_release(symtable->oBudget, charged - bytes);
+            break;
+        }
+        version = symtable->ulVersion;
+        if (!SymBudget_charge(symtable->oBudget, bytes - charged)) {
+            SymBudget_release(symtable->oBudget, charged);
+            return NULL;
+        }
+        charged = bytes;
+        if (version == symtable->ulVersion) {
+            break;
+        }
+    }
+    clone = SymTable_new();
+    clone->iSorted = symtable->iSorted;
+    clone->iMode = symtable->iMode;
+    clone->uiBytes = symtable->uiSize * sizeof(struct abind) + key_bytes;
+    clone->oBudget = symtable->oBudget;
+    if (!symtable->uiSize) {
+        return (SymTable_T) clone;
+    }
+
+    block = malloc(offsetof(struct ablock, binds) +
+                   symtable->uiSize * sizeof(struct abind) + key_bytes);
+    assert(block);
+    SYMTABLE_COUNT(ulAllocs);
+    block->next = NULL;
+    clone->blocks = block;
+    if (clone->iMode & SYMTABLE_RANDOM) {
+        clone->dense = malloc(symtable->uiSize * sizeof(struct abind *));
+        assert(clone->dense);
+        SYMTABLE_COUNT(ulAllocs);
+        clone->uiDenseCap = symtable->uiSize;
+    }
+
+    /* bindings are copied to the array, keys after the array */
+    bind = block->binds;
+    key = (char *) (block->binds + symtable->uiSize);
+    link = &clone->first;
+    for (ptr = symtable->first; ptr; ptr = ptr->next) {
+        SYMTABLE_COUNT(ulVisits);
+        if (ptr->uiGeneration != symtable->uiGeneration) {
+            continue;
+        }
+        strcpy(key, ptr->key);
+        bind->key = key;
+        bind->value = ptr->value;
+        bind->hash = ptr->hash;
+        bind->iInBlock = BIND_IN_BLOCK | KEY_IN_BLOCK;
+        bind->uiGeneration = clone->uiGeneration;
+        SymTable_addDense(clone, bind);
+        *link = bind;
+        link = &bind->next;
+        key += strlen(key) + 1;
+        bind++;
+    }
+    *link = NULL;
+    clone->stale = link;
+
+    return (SymTable_T) clone;
+}
+
+
+/* Allocates room for uiCount more bindings of oSymTable in one block, so
+that the next uiCount new bindings only allocate their keys, and, in
+SYMTABLE_RANDOM mode, makes room for them in the array of bindings. The
+block is charged to the budget of oSymTable at once and puts that use it
+only charge their keys. The block is freed by SymTable_free.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* uiCount: number of bindings
+
+Returns: 1 if the room was allocated, 0 if the budget rejected it */
+int SymTable_reserve(SymTable_T oSymTable, unsigned int uiCount) {
+    struct SymTable *symtable;
+    struct ablock *block;
+    size_t bytes;
+    unsigned int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    if (!uiCount) {
+        return 1;
+    }
+    bytes = uiCount * sizeof(struct abind);
+    if (symtable->oBudget && !SymBudget_charge(symtable->oBudget, bytes)) {
+        return 0;
+    }
+    symtable->uiBytes += bytes;
+    block = malloc(offsetof(struct ablock, binds) + bytes);
+    assert(block);
+    SYMTABLE_COUNT(ulAllocs);
+
+    /* the array of bindings grows once for the whole block */
+    if ((symtable->iMode & SYMTABLE_RANDOM) &&
+        symtable->uiSize + uiCount > symtable->uiDenseCap) {
+        symtable->uiDenseCap = symtable->uiSize + uiCount;
+        symtable->dense = realloc(symtable->dense,
+                                  symtable->uiDenseCap * sizeof(struct abind *));
+        assert(symtable->dense);
+        SYMTABLE_COUNT(ulAllocs);
+    }
+    block->next = symtable->blocks;
+    symtable->blocks = block;
+    symtable->ulVersion++;
+    /* bindings are used in the order of the array */
+    for (i = uiCount; i > 0; i--) {
+        block->binds[i - 1].next = symtable->spare;
+        symtable->spare = &block->binds[i - 1];
+    }
+
+    return 1;
+}
+
+
+/* Removes all bindings from oSymTable. In SYMTABLE_REUSABLE mode this
+takes constant time: the bindings are kept as stale bindings of an older
+generation, which are treated as absent, and a later put of the same key
+revives its binding without allocating. Unsorted tables also reuse any
+stale binding for a new key, sorted tables only the stale binding at the
+position of the new key. Stale bindings keep their memory, which stays
+charged to the budget of oSymTable, until they are reused, the mode is
+turned off or the table is freed. Otherwise the bindings are freed in
+linear time.
 
 Asserts: if oSymTable is not NULL at runtime.
 
 Parameters:
 * oSymTable: a SymTable_T type */
-unsigned int SymTable_getLength(SymTable_T oSymTable) {
+void SymTable_reset(SymTable_T oSymTable) {
     struct SymTable *symtable;
+    struct abind *ptr, *ptr_next;
 
     symtable = oSymTable;
     assert(symtable);
 
-    return (symtable->uiSize);
+    symtable->ulVersion++;
+    if (!(symtable->iMode & SYMTABLE_REUSABLE)) {
+        for (ptr = symtable->first; ptr; ptr = ptr_next) {
+            SYMTABLE_COUNT(ulVisits);
+            ptr_next = ptr->next;
+            SymTable_deleteBind(symtable, ptr);
+        }
+        symtable->first = NULL;
+        symtable->uiSize = 0U;
+        symtable->stale = &symtable->first;
+        return;
+    }
+
+    /* when the counter wraps, the old stamps could become live again, so
+    every binding gets generation 0 and the counter restarts at 1 */
+    symtable->uiGeneration++;
+    if (!symtable->uiGeneration) {
+        for (ptr = symtable->first; ptr; ptr = ptr->next) {
+            ptr->uiGeneration = 0U;
+        }
+        symtable->uiGeneration = 1U;
+    }
+    symtable->uiSize = 0U;
+    symtable->stale = &symtable->first;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type */
+unsigned int SymTable_getLength(SymTable_T oSymTable) {
+    return SymTable_getLengthInline(oSymTable);
 }
 
 
@@ -96,22 +600,103 @@ Parameters:
 
 Returns: 1 if pcKey is found, 0 otherwise */
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-    struct abind *ptr;
+    return SymTable_containsInline(oSymTable, pcKey);
+}
+
+
+/* Attaches oSymTable to oBudget. The memory already used by oSymTable is
+charged to oBudget and every subsequent binding is charged when created and
+released when removed. A NULL oBudget detaches the table.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* oBudget: a SymBudget_T type or NULL
+
+Returns: 1 if oSymTable was attached, 0 if oBudget could not accommodate
+the memory already used by oSymTable. */
+int SymTable_setBudget(SymTable_T oSymTable, SymBudget_T oBudget) {
     struct SymTable *symtable;
 
     symtable = oSymTable;
     assert(symtable);
-    assert(pcKey);
 
-    ptr = symtable->first;
-    while(ptr) {
-        if (!strcmp(ptr->key, pcKey)) {
-            return 1;
+    if (oBudget && !SymBudget_charge(oBudget, symtable->uiBytes)) {
+        return 0;
+    }
+    if (symtable->oBudget) {
+        SymBudget_release(symtable->oBudget, symtable->uiBytes);
+    }
+    symtable->oBudget = oBudget;
+
+    return 1;
+}
+
+
+/* Sets the modes of oSymTable to iMode, the | of any of these flags, or 0
+for none:
+* SYMTABLE_RANDOM: the table keeps an array of pointers to its bindings,
+one pointer per binding, which SymTable_randomBinding needs.
+* SYMTABLE_REUSABLE: SymTable_reset keeps the bindings for reuse.
+A new table has no mode. Turning SYMTABLE_RANDOM on takes linear time,
+and so does turning SYMTABLE_REUSABLE off, which frees the bindings kept
+by SymTable_reset.
+
+Asserts:
+1) if oSymTable is not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* iMode: the modes of the table */
+void SymTable_setMode(SymTable_T oSymTable, int iMode) {
+    struct SymTable *symtable;
+    struct abind *ptr, **link;
+    unsigned int index;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    /* stale bindings are freed, so that all bindings are live again */
+    if (!(iMode & SYMTABLE_REUSABLE) &&
+        (symtable->iMode & SYMTABLE_REUSABLE)) {
+        link = &symtable->first;
+        while(*link) {
+            SYMTABLE_COUNT(ulVisits);
+            ptr = *link;
+            if (ptr->uiGeneration != symtable->uiGeneration) {
+                *link = ptr->next;
+                SymTable_deleteBind(symtable, ptr);
+            }
+            else {
+                link = &ptr->next;
+            }
         }
-        ptr = ptr->next;
+        symtable->stale = link;
+        symtable->ulVersion++;
     }
 
-    return 0;
+    if ((iMode & SYMTABLE_RANDOM) && !(symtable->iMode & SYMTABLE_RANDOM)) {
+        symtable->uiDenseCap = symtable->uiSize ? symtable->uiSize : 16U;
+        symtable->dense = malloc(symtable->uiDenseCap * sizeof(struct abind *));
+        assert(symtable->dense);
+        SYMTABLE_COUNT(ulAllocs);
+        index = 0U;
+        for (ptr = symtable->first; ptr; ptr = ptr->next) {
+            SYMTABLE_COUNT(ulVisits);
+            if (ptr->uiGeneration == symtable->uiGeneration) {
+                ptr->uiIndex = index;
+                symtable->dense[index++] = ptr;
+            }
+        }
+    }
+    else if (!(iMode & SYMTABLE_RANDOM)) {
+        free(symtable->dense);
+        symtable->dense = NULL;
+        symtable->uiDenseCap = 0U;
+    }
+    symtable->iMode = iMode;
 }
 
 
@@ -127,41 +712,112 @@ Parameters:
 * pvValue: pointer to any value
 
 Returns: 1 if binding was created succesfully, 0 if there is already
-a binding with key equal to pcKey. */
+a binding with key equal to pcKey or if the budget of oSymTable rejected
+the binding. */
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    struct abind *new_bind;
+    struct abind **link;
     struct SymTable *symtable;
-    char *new_key;
+    unsigned int hash;
+    int found, inserted;
 
     symtable = oSymTable;
     assert(symtable);
     assert(pcKey);
 
-    /* do nothing if pcKey already exists in the table */
-    if (SymTable_contains(symtable, pcKey)) {
-        return 0;
-    }
+    /* do nothing if pcKey already exists in the table. The binding is
+    inserted first unless the table is sorted, in which case it is inserted
+    at the position found by SymTable_locate, which is found again if a
+    shrink callback changed the table. */
+    hash = SymTable_hash(pcKey);
+    do {
+        link = SymTable_locate(symtable, pcKey, hash, &found);
+        if (found) {
+            return 0;
+        }
+        inserted = SymTable_insert(symtable, link, pcKey, hash, pvValue);
+    } while(inserted < 0);
 
-    /* pcKey not found -> allocate memory for a new binding + key */
-    new_bind = malloc(sizeof(struct abind));
-    assert(new_bind);
-    new_key = malloc((strlen(pcKey) + 1) * sizeof(char));
-    assert(new_key);
+    return inserted;
+}
 
-    /* copy pcKey into new_key */
-    strcpy(new_key, pcKey);
 
-    /* initialize binding */
-    new_bind->key = new_key;        
-    new_bind->value = (void *) pvValue;
+/* Inserts into oDest a copy of every binding of oSrc. When a key exists in
+both tables, the value in oDest is replaced by the value returned by
+pfResolve, or kept unchanged if pfResolve is NULL. If both tables are
+sorted the merge runs in O(length(oDest) + length(oSrc)) time.
 
-    /* binding is inserted first */
-    new_bind->next = symtable->first;
-    symtable->first = new_bind;
+Asserts:
+1) if oDest and oSrc are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
 
-    symtable->uiSize += 1;
+Parameters:
+* oDest: a SymTable_T type
+* oSrc: a SymTable_T type. It is not modified.
+* pfResolve: function that returns the value for a key present in both
+tables, given the value in oDest and the value in oSrc. Can be NULL.
+* pvExtra: a pointer to any value. Used by pfResolve.
+
+Returns: the number of bindings inserted into oDest. Bindings rejected by
+the budget of oDest are skipped. */
+unsigned int SymTable_merge(SymTable_T oDest, SymTable_T oSrc,
+    void *(*pfResolve)(const char *pcKey, void *pvOld, void *pvNew, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTable *dest, *src;
+    struct abind *ptr, **link;
+    unsigned int inserted;
+    int found, result;
+
+    dest = oDest;
+    src = oSrc;
+    assert(dest);
+    assert(src);
+
+    inserted = 0U;
+    link = &dest->first;
+    for (ptr = src->first; ptr; ptr = ptr->next) {
+        SYMTABLE_COUNT(ulVisits);
+        if (ptr->uiGeneration != src->uiGeneration) {
+            continue;
+        }
 
-    return 1;
+        do {
+            /* Both lists are ordered: continue from the last position in
+            oDest instead of searching from the start */
+            if (dest->iSorted && src->iSorted) {
+                while(*link &&
+                      SymTable_compare(*link, ptr->hash, ptr->key) < 0) {
+                    SYMTABLE_COUNT(ulVisits);
+                    link = &(*link)->next;
+                }
+                found = *link &&
+                        !SymTable_compare(*link, ptr->hash, ptr->key) &&
+                        (*link)->uiGeneration == dest->uiGeneration;
+            }
+            else {
+                link = SymTable_locate(dest, ptr->key, ptr->hash, &found);
+            }
+
+            if (found) {
+                if (pfResolve) {
+                    (*link)->value = pfResolve(ptr->key, (*link)->value,
+                                               ptr->value, (void *) pvExtra);
+                }
+                result = 0;
+            }
+            else {
+                result = SymTable_insert(dest, link, ptr->key, ptr->hash,
+                                         ptr->value);
+            }
+
+            /* a shrink callback changed oDest: search from the start */
+            if (result < 0) {
+                link = &dest->first;
+            }
+        } while(result < 0);
+        inserted += result;
+    }
+
+    return inserted;
 }
 
 
@@ -184,38 +840,73 @@ void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void
 
     ptr = symtable->first;
     while(ptr) {
-        pfApply(ptr->key, ptr->value, (void *) pvExtra);
+        SYMTABLE_COUNT(ulVisits);
+        if (ptr->uiGeneration == symtable->uiGeneration) {
+            pfApply(ptr->key, ptr->value, (void *) pvExtra);
+        }
         ptr = ptr->next;
     }
 }
 
 
-/* Finds in oSymTable a binding with key equal to pcKey.
+/* Applies function pfApply to the bindings of oSymTable in chunks of at
+most SYMTABLE_BATCH bindings. pfApply receives uiCount keys and the values
+of their bindings in two arrays, so that one call can process many
+bindings with a loop the compiler can unroll or vectorize. The arrays are
+valid only during the call. Bindings are visited in the order of
+SymTable_map.
 
-Asserts: if oSymTable and pcKey are not NULL at runtime.
+Asserts: if oSymTable and pfApply are not NULL at runtime
 
 Parameters:
 * oSymTable: a SymTable_T type
-* pcKey: a character array (key). Must be null terminated.
-
-Returns: a pointer to the value or NULL if such binding was not found. */
-void* SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTable_mapBatch(SymTable_T oSymTable,
+    void (*pfApply)(const char **ppcKeys, void **ppvValues,
+                    unsigned int uiCount, void *pvExtra),
+    const void *pvExtra) {
+    const char *keys[SYMTABLE_BATCH];
+    void *values[SYMTABLE_BATCH];
+    unsigned int count;
     struct abind *ptr;
     struct SymTable *symtable;
 
     symtable = oSymTable;
     assert(symtable);
-    assert(pcKey);
+    assert(pfApply);
 
-    ptr = symtable->first;
-    while(ptr) {
-        if (!strcmp(ptr->key, pcKey)) {
-            return ptr->value;
+    count = 0;
+    for (ptr = symtable->first; ptr; ptr = ptr->next) {
+        SYMTABLE_COUNT(ulVisits);
+        if (ptr->uiGeneration != symtable->uiGeneration) {
+            continue;
+        }
+        keys[count] = ptr->key;
+        values[count] = ptr->value;
+        count++;
+        if (count == SYMTABLE_BATCH) {
+            pfApply(keys, values, count, (void *) pvExtra);
+            count = 0;
         }
-        ptr = ptr->next;
     }
+    if (count) {
+        pfApply(keys, values, count, (void *) pvExtra);
+    }
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
 
-    return NULL;
+Parameters:
+* oSymTable: a SymTable_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    return SymTable_getInline(oSymTable, pcKey);
 }
 
 
@@ -229,37 +920,109 @@ Parameters:
 
 Returns: 1 if removal was successful, 0 if such binding was not found */
 int SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-    struct abind *ptr, *ptr_prev;
+    struct abind *ptr, **link;
     struct SymTable *symtable;
+    int found;
 
     symtable = oSymTable;
     assert(symtable);
     assert(pcKey);
 
-    ptr = symtable->first;
-    while(ptr) {
-        /* compare pcKey with the key of each binding*/
-        if (strcmp(ptr->key, pcKey)) {  
-            ptr_prev = ptr;
-            ptr = ptr->next;
-            continue;       
-        }
+    link = SymTable_locate(symtable, pcKey, SymTable_hash(pcKey), &found);
+    if (!found) {
+        return 0;
+    }
 
-        /* pcKey was found. When found in first position, update the first
-        key to point to the 2nd one. When not found in first position, update
-        the previous key to point to the next one. */
-        if (ptr == symtable->first) {
-            symtable->first = ptr->next;
-        }
-        else {
-            ptr_prev->next = ptr->next;
-        }
+    /* pcKey was found. Update the link that points to the binding (the
+    first pointer or the next pointer of the previous binding) to point to
+    the next one. */
+    ptr = *link;
+    *link = ptr->next;
+    if (symtable->stale == &ptr->next) {
+        symtable->stale = link;
+    }
 
-        symtable->uiSize -= 1;
-        free(ptr->key);     
-        free(ptr);
-        return 1;
+    SymTable_removeDense(symtable, ptr);
+    SymTable_deleteBind(symtable, ptr);
+    symtable->ulVersion++;
+
+    return 1;
+}
+
+
+/* Picks a binding of oSymTable uniformly at random in constant time.
+*pulRandom is the state of a xorshift generator owned by the caller: it
+can be seeded with any value and is advanced by every call.
+
+Asserts:
+1) if oSymTable and pulRandom are not NULL at runtime.
+2) if oSymTable is in SYMTABLE_RANDOM mode at runtime.
+
+Parameters:
+* oSymTable: a SymTable_T type
+* pulRandom: state of the random number generator
+* ppcKey: set to the key of the binding, if not NULL. The key belongs to
+the binding.
+* ppvValue: set to the value of the binding, if not NULL
+
+Returns: 1 if a binding was picked, 0 if oSymTable is empty */
+int SymTable_randomBinding(SymTable_T oSymTable, unsigned long *pulRandom,
+    const char **ppcKey, void **ppvValue) {
+    struct SymTable *symtable;
+    struct abind *bind;
+    unsigned long x, limit;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pulRandom);
+    assert(symtable->iMode & SYMTABLE_RANDOM);
+
+    if (!symtable->uiSize) {
+        return 0;
+    }
+
+    /* 32-bit xorshift, whose state must not be 0. It returns 1 to 2^32 - 1,
+    so x - 1 covers 0 to 2^32 - 2, and values at or above the largest
+    multiple of uiSize are rejected so that every index is equally
+    likely. */
+    limit = 0xffffffffUL - 0xffffffffUL % symtable->uiSize;
+    x = *pulRandom & 0xffffffffUL;
+    do {
+        if (!x) {
+            x = 0x9e3779b9UL;
+        }
+        x ^= (x << 13) & 0xffffffffUL;
+        x ^= x >> 17;
+        x ^= (x << 5) & 0xffffffffUL;
+    } while(x - 1 >= limit);
+    *pulRandom = x;
+
+    bind = symtable->dense[(x - 1) % symtable->uiSize];
+    if (ppcKey) {
+        *ppcKey = bind->key;
+    }
+    if (ppvValue) {
+        *ppvValue = bind->value;
     }
 
-    return 0;
+    return 1;
+}
+
+
+#ifdef SYMTABLE_STATS
+/* Copies the operation counts of the library to pStats and resets them
+to 0. Only available when the library is built with SYMTABLE_STATS.
+
+Asserts: if pStats is not NULL at runtime.
+
+Parameters:
+* pStats: a SymTableStats struct */
+void SymTable_takeStats(struct SymTableStats *pStats) {
+    assert(pStats);
+
+    *pStats = SymTable_stats;
+    SymTable_stats.ulCompares = 0;
+    SymTable_stats.ulVisits = 0;
+    SymTable_stats.ulAllocs = 0;
 }
+#endif
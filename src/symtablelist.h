@@ -0,0 +1,239 @@
+/* Library for creating and using Symbol tables. List based implementation.
+
+Single header build: including this file instead of symtable.h exposes
+the table structs, and SymTable_get, SymTable_contains and
+SymTable_getLength become inline functions that the compiler can
+specialize at each call. Exactly one source file of a program must define
+SYMTABLE_IMPLEMENTATION before including it, which compiles the rest of
+the library (symtablelist.c) into that file:
+
+    #define SYMTABLE_IMPLEMENTATION
+    #include "symtablelist.h"
+
+Programs built this way are not linked with symtablelist.o. */
+
+#ifndef SYMTABLELIST_INCLUDE
+#define SYMTABLELIST_INCLUDE
+
+#include <string.h>
+#include <assert.h>
+#include "symtable.h"
+
+#ifdef __GNUC__
+#define SYMTABLE_INLINE static __inline__
+#else
+#define SYMTABLE_INLINE static
+#endif
+
+#define HASH_MULTIPLIER 65599
+
+/* SYMTABLE_COUNT(field) increments a field of the operation counts in
+instrumented builds and does nothing otherwise */
+#ifdef SYMTABLE_STATS
+extern struct SymTableStats SymTable_stats;
+#define SYMTABLE_COUNT(field) (SymTable_stats.field++)
+#else
+#define SYMTABLE_COUNT(field) ((void) 0)
+#endif
+
+
+/* Struct that represents a binding in the symbol table. Each binding has a
+pointer to a character key, the hash of the key, a pointer to any value and
+a pointer to the next binding. iInBlock tells which parts were allocated in
+a block: BIND_IN_BLOCK for the binding (SymTable_clone and
+SymTable_reserve) and KEY_IN_BLOCK for its key (SymTable_clone). uiIndex is
+the position of the binding in the dense array of a table in
+SYMTABLE_RANDOM mode, and uiGeneration the generation of the table in which
+it was put. A binding of an older generation is stale: it is treated as
+absent and is reused by a later put.
+
+Note: A binding owns its key. A binding does not own its value. */
+struct abind {
+    char *key;
+    void *value;
+    unsigned int hash;
+    int iInBlock;
+    unsigned int uiIndex;
+    unsigned int uiGeneration;
+    struct abind *next;
+};
+
+
+#define BIND_IN_BLOCK 1
+#define KEY_IN_BLOCK 2
+
+
+/* Struct that represents a block allocated by SymTable_clone (an array of
+bindings followed by their keys) or by SymTable_reserve (an array of
+bindings). A block is freed with its table. */
+struct ablock {
+    struct ablock *next;
+    struct abind binds[1];
+};
+
+
+/* Struct that represents a symbol table as a list of bindings. Only the
+number of bindings and a pointer to the first binding are required. When
+iSorted is 1 the bindings are kept ordered by (hash, key). iMode is the
+mode set by SymTable_setMode. uiBytes is the memory used by the bindings
+and is charged to oBudget when the table is attached to a budget. blocks is
+the list of blocks allocated by SymTable_clone and SymTable_reserve. spare
+is the list of unused bindings of the blocks, which are used before
+allocating new ones. Spare bindings stay charged to oBudget, so a put that
+uses one only charges its key. In SYMTABLE_RANDOM mode dense is an array of
+uiDenseCap pointers whose first uiSize entries point to the bindings in no
+particular order, for SymTable_randomBinding; otherwise it is NULL. In
+SYMTABLE_REUSABLE mode uiGeneration is incremented by SymTable_reset, which
+makes every binding stale; otherwise it stays 0. The live bindings of an
+unsorted table come before its stale ones, and stale is the link to the
+first stale binding. ulVersion is incremented by every change to the
+bindings, so that a put can tell whether a shrink callback of oBudget
+changed the table. */
+struct SymTable {
+    unsigned int uiSize;
+    struct abind *first;
+    int iSorted;
+    int iMode;
+    size_t uiBytes;
+    SymBudget_T oBudget;
+    struct ablock *blocks;
+    struct abind *spare;
+    struct abind **dense;
+    unsigned int uiDenseCap;
+    unsigned int uiGeneration;
+    struct abind **stale;
+    unsigned long ulVersion;
+};
+
+
+/* Returns a hash code for pcKey */
+SYMTABLE_INLINE unsigned int SymTable_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Compares binding bind with the pair (hash, pcKey).
+
+Returns: <0, 0 or >0 if bind orders before, equal or after (hash, pcKey) */
+SYMTABLE_INLINE int SymTable_compare(const struct abind *bind, unsigned int hash,
+    const char *pcKey) {
+    if (bind->hash != hash) {
+        return bind->hash < hash ? -1 : 1;
+    }
+    SYMTABLE_COUNT(ulCompares);
+
+    return strcmp(bind->key, pcKey);
+}
+
+
+/* Finds the link (the first pointer of oSymTable or the next pointer of a
+binding) that points to the binding with key pcKey. If there is no such
+binding, the returned link points to the position where it should be
+inserted: for sorted tables this is the first binding that orders after
+pcKey, for unsorted tables the end of the live bindings. A stale binding
+with key pcKey of a sorted table is returned but is not found. The stale
+bindings of an unsorted table come after its live ones and are not
+visited.
+
+Parameters:
+* symtable: a SymTable struct
+* pcKey: a character array (key). Must be null terminated.
+* hash: the hash of pcKey
+* found: set to 1 if a live binding was found, 0 otherwise
+
+Returns: a pointer to the link */
+SYMTABLE_INLINE struct abind **SymTable_locate(struct SymTable *symtable,
+    const char *pcKey, unsigned int hash, int *found) {
+    struct abind **link;
+    int cmp;
+
+    link = &symtable->first;
+    while(*link && (symtable->iSorted || link != symtable->stale)) {
+        SYMTABLE_COUNT(ulVisits);
+        if (symtable->iSorted) {
+            cmp = SymTable_compare(*link, hash, pcKey);
+            if (cmp >= 0) {
+                *found = !cmp &&
+                         (*link)->uiGeneration == symtable->uiGeneration;
+                return link;
+            }
+        }
+        else if ((*link)->hash == hash && (SYMTABLE_COUNT(ulCompares),
+                                           !strcmp((*link)->key, pcKey))) {
+            *found = 1;
+            return link;
+        }
+        link = &(*link)->next;
+    }
+    *found = 0;
+
+    return link;
+}
+
+
+/* Inline version of SymTable_getLength */
+SYMTABLE_INLINE unsigned int SymTable_getLengthInline(SymTable_T oSymTable) {
+    struct SymTable *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return (symtable->uiSize);
+}
+
+
+/* Inline version of SymTable_contains */
+SYMTABLE_INLINE int SymTable_containsInline(SymTable_T oSymTable,
+    const char *pcKey) {
+    struct SymTable *symtable;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    SymTable_locate(symtable, pcKey, SymTable_hash(pcKey), &found);
+
+    return found;
+}
+
+
+/* Inline version of SymTable_get */
+SYMTABLE_INLINE void *SymTable_getInline(SymTable_T oSymTable,
+    const char *pcKey) {
+    struct abind **link;
+    struct SymTable *symtable;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    link = SymTable_locate(symtable, pcKey, SymTable_hash(pcKey), &found);
+    if (found) {
+        return (*link)->value;
+    }
+
+    return NULL;
+}
+
+
+#ifdef SYMTABLE_IMPLEMENTATION
+#include "symtablelist.c"
+#endif
+
+/* defined after the implementation so that its definitions keep their
+names */
+#define SymTable_getLength(oSymTable) SymTable_getLengthInline(oSymTable)
+#define SymTable_contains(oSymTable, pcKey) SymTable_containsInline(oSymTable, pcKey)
+#define SymTable_get(oSymTable, pcKey) SymTable_getInline(oSymTable, pcKey)
+
+#endif
@@ -0,0 +1,614 @@
+/* Library for creating and using write-optimized Symbol tables.
+
+New bindings and removals go to a sorted buffer in memory (the memtable).
+A full memtable is written to an immutable sorted run of level 0, and a
+background thread merges LSM_MERGE_RUNS runs of the same level into one run
+of the next level (size-tiered merging). A run of level L holds about
+LSM_MERGE_RUNS^L memtables, so every binding is copied once per level, that
+is O(log N) times. A removal is stored as a tombstone that hides older
+bindings until it is merged into the oldest run. Every run has a Bloom
+filter, so a get looks only into the runs that may contain the key. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symtablelsm.h"
+
+#define HASH_MULTIPLIER 65599
+#define LSM_MEMTABLE 4096   /* bindings in the memtable before a flush */
+#define LSM_MERGE_RUNS 4    /* runs of the same level that are merged */
+#define LSM_MAX_RUNS 48     /* runs that block a flush until a merge ends */
+#define LSM_BLOOM_BITS 10   /* Bloom filter bits per binding */
+#define LSM_BLOOM_HASHES 7  /* Bloom filter probes per key */
+
+
+/* Struct that represents a binding or a tombstone */
+struct lentry {
+    const char *key;
+    void *value;
+    int iDeleted;
+};
+
+
+/* Struct that represents an immutable sorted run. The keys of all
+entries are stored in one block. uiLevel is 0 for a flushed memtable and
+one more than the level of the merged runs otherwise. */
+struct lrun {
+    unsigned int uiCount;
+    unsigned int uiLevel;
+    struct lentry *entries;
+    char *keys;
+    unsigned char *bloom;
+    unsigned int uiBloomBits;
+};
+
+
+/* Struct that represents a write-optimized symbol table. The memtable is
+only used by the caller's thread. runs holds uiRuns runs, newest first, and
+is shared with the merge thread under lock. The levels of the runs never
+decrease from the newest run to the oldest, so the runs of a level are
+adjacent. */
+struct SymTableLsm {
+    struct lentry *mem;
+    unsigned int uiMem;
+    struct lrun *runs[LSM_MAX_RUNS];
+    unsigned int uiRuns;
+    int iStop;
+    pthread_mutex_t lock;
+    pthread_cond_t merge;   /* signalled when a merge may be needed */
+    pthread_cond_t space;   /* signalled when a merge ends */
+    pthread_t merger;
+};
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymTableLsm_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Returns the second hash code for the Bloom filter from the first one */
+static unsigned int SymTableLsm_hash2(unsigned int hash) {
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+
+    return hash | 1U;
+}
+
+
+/* Adds pcKey to the Bloom filter of run */
+static void SymTableLsm_bloomAdd(struct lrun *run, const char *pcKey) {
+    unsigned int hash, hash2;
+    int i;
+
+    hash = SymTableLsm_hash(pcKey);
+    hash2 = SymTableLsm_hash2(hash);
+    for (i = 0; i < LSM_BLOOM_HASHES; i++) {
+        run->bloom[(hash % run->uiBloomBits) / 8] |=
+            (unsigned char) (1 << (hash % run->uiBloomBits % 8));
+        hash += hash2;
+    }
+    return;
+}
+
+
+/* Returns 0 if pcKey with hash code hash is surely not in run */
+static int SymTableLsm_bloomHas(struct lrun *run, const char *pcKey,
+    unsigned int hash) {
+    unsigned int hash2;
+    int i;
+
+    hash2 = SymTableLsm_hash2(hash);
+    for (i = 0; i < LSM_BLOOM_HASHES; i++) {
+        if (!(run->bloom[(hash % run->uiBloomBits) / 8] &
+              (1 << (hash % run->uiBloomBits % 8)))) {
+            return 0;
+        }
+        hash += hash2;
+    }
+
+    return 1;
+}
+
+
+/* Returns the index of the first of the uiCount entries that has a key
+>= pcKey. Sets *piFound to 1 if that key is equal to pcKey. */
+static unsigned int SymTableLsm_search(struct lentry *entries,
+    unsigned int uiCount, const char *pcKey, int *piFound) {
+    unsigned int low, high, mid;
+    int cmp;
+
+    low = 0;
+    high = uiCount;
+    *piFound = 0;
+    while(low < high) {
+        mid = low + (high - low) / 2;
+        cmp = strcmp(entries[mid].key, pcKey);
+        if (cmp == 0) {
+            *piFound = 1;
+            return mid;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+
+/* Creates a run from the uiCount entries, which must be sorted and have
+distinct keys. The keys are copied, and tombstones are dropped if
+iDropDeleted is set. */
+static struct lrun *SymTableLsm_newRun(struct lentry *entries,
+    unsigned int uiCount, int iDropDeleted) {
+    struct lrun *run;
+    unsigned int i, count;
+    size_t bytes;
+    char *key;
+
+    run = malloc(sizeof(struct lrun));
+    assert(run);
+    bytes = 1;
+    count = 0;
+    for (i = 0; i < uiCount; i++) {
+        if (!iDropDeleted || !entries[i].iDeleted) {
+            bytes += strlen(entries[i].key) + 1;
+            count++;
+        }
+    }
+    run->uiCount = count;
+    run->uiLevel = 0;
+    run->entries = malloc((count ? count : 1) * sizeof(struct lentry));
+    run->keys = malloc(bytes);
+    run->uiBloomBits = (count ? count : 1) * LSM_BLOOM_BITS;
+    run->bloom = calloc((run->uiBloomBits + 7) / 8, 1);
+    assert(run->entries && run->keys && run->bloom);
+
+    key = run->keys;
+    count = 0;
+    for (i = 0; i < uiCount; i++) {
+        if (iDropDeleted && entries[i].iDeleted) {
+            continue;
+        }
+        strcpy(key, entries[i].key);
+        run->entries[count] = entries[i];
+        run->entries[count].key = key;
+        SymTableLsm_bloomAdd(run, key);
+        key += strlen(key) + 1;
+        count++;
+    }
+
+    return run;
+}
+
+
+/* Frees all memory used by run */
+static void SymTableLsm_freeRun(struct lrun *run) {
+    free(run->entries);
+    free(run->keys);
+    free(run->bloom);
+    free(run);
+    return;
+}
+
+
+/* Merges the uiCount runs, newest first, into one run. If a key is in
+more than one run, the entry of the newest run is kept. Tombstones are
+dropped if iDropDeleted is set. */
+static struct lrun *SymTableLsm_mergeRuns(struct lrun **runs,
+    unsigned int uiCount, int iDropDeleted) {
+    struct lentry *merged;
+    struct lrun *run;
+    unsigned int *next;
+    unsigned int i, total, count, best;
+    int cmp;
+
+    total = 0;
+    for (i = 0; i < uiCount; i++) {
+        total += runs[i]->uiCount;
+    }
+    merged = malloc((total ? total : 1) * sizeof(struct lentry));
+    next = calloc(uiCount, sizeof(unsigned int));
+    assert(merged && next);
+
+    count = 0;
+    for (;;) {
+        best = uiCount;
+        for (i = 0; i < uiCount; i++) {
+            if (next[i] == runs[i]->uiCount) {
+                continue;
+            }
+            if (best == uiCount) {
+                best = i;
+                continue;
+            }
+            cmp = strcmp(runs[i]->entries[next[i]].key,
+                         runs[best]->entries[next[best]].key);
+            if (cmp < 0) {
+                best = i;
+            }
+            else if (cmp == 0) {
+                next[i]++;
+            }
+        }
+        if (best == uiCount) {
+            break;
+        }
+        merged[count++] = runs[best]->entries[next[best]];
+        next[best]++;
+    }
+
+    run = SymTableLsm_newRun(merged, count, iDropDeleted);
+    free(merged);
+    free(next);
+
+    return run;
+}
+
+
+/* Returns the index of the newest of the LSM_MERGE_RUNS oldest runs of
+the oldest level that has that many runs, or uiRuns if there is no such
+level. Merging the oldest runs of a level keeps the levels ordered. Must
+be called under lock. */
+static unsigned int SymTableLsm_pickMerge(struct SymTableLsm *symtable) {
+    unsigned int i, same;
+
+    same = 0;
+    for (i = symtable->uiRuns; i > 0; i--) {
+        if (i < symtable->uiRuns &&
+            symtable->runs[i - 1]->uiLevel == symtable->runs[i]->uiLevel) {
+            same++;
+        }
+        else {
+            same = 1;
+        }
+        if (same == LSM_MERGE_RUNS) {
+            return i - 1;
+        }
+    }
+
+    return symtable->uiRuns;
+}
+
+
+/* Body of the merge thread: whenever a level has LSM_MERGE_RUNS runs,
+merges them into one run of the next level. The runs are immutable, so
+they are merged without holding the lock. Runs flushed meanwhile are newer
+and stay in front of the merged run. A merge that includes the oldest run
+holds every older binding, so its tombstones are dropped. */
+static void *SymTableLsm_merger(void *arg) {
+    struct SymTableLsm *symtable;
+    struct lrun *old[LSM_MERGE_RUNS];
+    struct lrun *run;
+    unsigned int i, first, count;
+
+    symtable = arg;
+    pthread_mutex_lock(&symtable->lock);
+    while(!symtable->iStop) {
+        first = SymTableLsm_pickMerge(symtable);
+        if (first == symtable->uiRuns) {
+            pthread_cond_wait(&symtable->merge, &symtable->lock);
+            continue;
+        }
+        count = symtable->uiRuns;
+        memcpy(old, symtable->runs + first,
+               LSM_MERGE_RUNS * sizeof(struct lrun *));
+        pthread_mutex_unlock(&symtable->lock);
+
+        run = SymTableLsm_mergeRuns(old, LSM_MERGE_RUNS,
+                                    first + LSM_MERGE_RUNS == count);
+        run->uiLevel = old[0]->uiLevel + 1;
+
+        pthread_mutex_lock(&symtable->lock);
+        first += symtable->uiRuns - count;
+        symtable->runs[first] = run;
+        memmove(symtable->runs + first + 1,
+                symtable->runs + first + LSM_MERGE_RUNS,
+                (symtable->uiRuns - first - LSM_MERGE_RUNS) *
+                sizeof(struct lrun *));
+        symtable->uiRuns -= LSM_MERGE_RUNS - 1;
+        pthread_cond_broadcast(&symtable->space);
+        pthread_mutex_unlock(&symtable->lock);
+        for (i = 0; i < LSM_MERGE_RUNS; i++) {
+            SymTableLsm_freeRun(old[i]);
+        }
+        pthread_mutex_lock(&symtable->lock);
+    }
+    pthread_mutex_unlock(&symtable->lock);
+
+    return NULL;
+}
+
+
+/* Writes the memtable of symtable to a new run and empties it */
+static void SymTableLsm_flush(struct SymTableLsm *symtable) {
+    struct lrun *run;
+    unsigned int i;
+
+    run = SymTableLsm_newRun(symtable->mem, symtable->uiMem, 0);
+    for (i = 0; i < symtable->uiMem; i++) {
+        free((char *) symtable->mem[i].key);
+    }
+    symtable->uiMem = 0;
+
+    pthread_mutex_lock(&symtable->lock);
+    while(symtable->uiRuns == LSM_MAX_RUNS) {
+        pthread_cond_wait(&symtable->space, &symtable->lock);
+    }
+    memmove(symtable->runs + 1, symtable->runs,
+            symtable->uiRuns * sizeof(struct lrun *));
+    symtable->runs[0] = run;
+    symtable->uiRuns++;
+    if (symtable->uiRuns >= LSM_MERGE_RUNS) {
+        pthread_cond_signal(&symtable->merge);
+    }
+    pthread_mutex_unlock(&symtable->lock);
+    return;
+}
+
+
+/* Writes pcKey to the memtable of symtable as a binding to pvValue or as
+a tombstone if iDeleted is set, and flushes the memtable if it is full. */
+static void SymTableLsm_write(struct SymTableLsm *symtable, const char *pcKey,
+    const void *pvValue, int iDeleted) {
+    struct lentry *entry;
+    unsigned int index;
+    int found;
+    char *key;
+
+    index = SymTableLsm_search(symtable->mem, symtable->uiMem, pcKey, &found);
+    entry = &symtable->mem[index];
+    if (!found) {
+        key = malloc(strlen(pcKey) + 1);
+        assert(key);
+        strcpy(key, pcKey);
+        memmove(entry + 1, entry,
+                (symtable->uiMem - index) * sizeof(struct lentry));
+        entry->key = key;
+        symtable->uiMem++;
+    }
+    entry->value = (void *) pvValue;
+    entry->iDeleted = iDeleted;
+
+    if (symtable->uiMem == LSM_MEMTABLE) {
+        SymTableLsm_flush(symtable);
+    }
+    return;
+}
+
+
+/* Finds the newest entry with key equal to pcKey. Sets *ppvValue to its
+value and returns 1 if it is a binding, returns 0 if it is a tombstone or
+there is no such entry. */
+static int SymTableLsm_lookup(struct SymTableLsm *symtable, const char *pcKey,
+    void **ppvValue) {
+    struct lrun *run;
+    unsigned int i, index, hash;
+    int found, result;
+
+    index = SymTableLsm_search(symtable->mem, symtable->uiMem, pcKey, &found);
+    if (found) {
+        *ppvValue = symtable->mem[index].value;
+        return !symtable->mem[index].iDeleted;
+    }
+
+    hash = SymTableLsm_hash(pcKey);
+    result = 0;
+    pthread_mutex_lock(&symtable->lock);
+    for (i = 0; i < symtable->uiRuns; i++) {
+        run = symtable->runs[i];
+        if (!SymTableLsm_bloomHas(run, pcKey, hash)) {
+            continue;
+        }
+        index = SymTableLsm_search(run->entries, run->uiCount, pcKey, &found);
+        if (found) {
+            *ppvValue = run->entries[index].value;
+            result = !run->entries[index].iDeleted;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&symtable->lock);
+
+    return result;
+}
+
+
+/* Creates a SymTableLsm struct with no bindings and starts its merge
+thread.
+
+Asserts:
+1) if memory was allocated succesfully for oSymTable at runtime.
+2) if the merge thread was created succesfully at runtime. */
+SymTableLsm_T SymTableLsm_new(void) {
+    struct SymTableLsm *symtable;
+    int error;
+
+    symtable = malloc(sizeof(struct SymTableLsm));
+    assert(symtable);
+    symtable->mem = malloc(LSM_MEMTABLE * sizeof(struct lentry));
+    assert(symtable->mem);
+    symtable->uiMem = 0;
+    symtable->uiRuns = 0;
+    symtable->iStop = 0;
+    pthread_mutex_init(&symtable->lock, NULL);
+    pthread_cond_init(&symtable->merge, NULL);
+    pthread_cond_init(&symtable->space, NULL);
+    error = pthread_create(&symtable->merger, NULL, SymTableLsm_merger,
+                           symtable);
+    assert(!error);
+
+    return (SymTableLsm_T) symtable;
+}
+
+
+/* Stops the merge thread and frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type */
+void SymTableLsm_free(SymTableLsm_T oSymTable) {
+    struct SymTableLsm *symtable;
+    unsigned int i;
+
+    if (oSymTable == NULL) {
+        return;
+    }
+    symtable = oSymTable;
+
+    pthread_mutex_lock(&symtable->lock);
+    symtable->iStop = 1;
+    pthread_cond_signal(&symtable->merge);
+    pthread_mutex_unlock(&symtable->lock);
+    pthread_join(symtable->merger, NULL);
+
+    for (i = 0; i < symtable->uiMem; i++) {
+        free((char *) symtable->mem[i].key);
+    }
+    for (i = 0; i < symtable->uiRuns; i++) {
+        SymTableLsm_freeRun(symtable->runs[i]);
+    }
+    pthread_mutex_destroy(&symtable->lock);
+    pthread_cond_destroy(&symtable->merge);
+    pthread_cond_destroy(&symtable->space);
+    free(symtable->mem);
+    free(symtable);
+    return;
+}
+
+
+/* Binds pcKey to pvValue in oSymTable, replacing the value of an
+existing binding with key equal to pcKey.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value */
+void SymTableLsm_put(SymTableLsm_T oSymTable, const char *pcKey,
+        const void *pvValue) {
+    assert(oSymTable && pcKey);
+
+    SymTableLsm_write(oSymTable, pcKey, pvValue, 0);
+    return;
+}
+
+
+/* Removes from oSymTable the binding with key equal to pcKey, if there is
+one.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymTableLsm_remove(SymTableLsm_T oSymTable, const char *pcKey) {
+    assert(oSymTable && pcKey);
+
+    SymTableLsm_write(oSymTable, pcKey, NULL, 1);
+    return;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableLsm_contains(SymTableLsm_T oSymTable, const char *pcKey) {
+    void *value;
+
+    assert(oSymTable && pcKey);
+
+    return SymTableLsm_lookup(oSymTable, pcKey, &value);
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableLsm_get(SymTableLsm_T oSymTable, const char *pcKey) {
+    void *value;
+
+    assert(oSymTable && pcKey);
+
+    if (!SymTableLsm_lookup(oSymTable, pcKey, &value)) {
+        return NULL;
+    }
+
+    return value;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+The bindings are copied first, so pfApply may change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of bindings */
+unsigned int SymTableLsm_map(SymTableLsm_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra) {
+    struct SymTableLsm *symtable;
+    struct lrun *runs[LSM_MAX_RUNS + 1];
+    struct lrun mem;
+    struct lrun *merged;
+    unsigned int i, count;
+
+    assert(oSymTable && pfApply);
+    symtable = oSymTable;
+
+    /* the memtable is the newest run */
+    mem.uiCount = symtable->uiMem;
+    mem.entries = symtable->mem;
+    runs[0] = &mem;
+
+    pthread_mutex_lock(&symtable->lock);
+    memcpy(runs + 1, symtable->runs, symtable->uiRuns * sizeof(struct lrun *));
+    merged = SymTableLsm_mergeRuns(runs, symtable->uiRuns + 1, 1);
+    pthread_mutex_unlock(&symtable->lock);
+
+    count = merged->uiCount;
+    for (i = 0; i < count; i++) {
+        (*pfApply)(merged->entries[i].key, merged->entries[i].value,
+                   (void *) pvExtra);
+    }
+    SymTableLsm_freeRun(merged);
+
+    return count;
+}
@@ -0,0 +1,99 @@
+/* Library for creating and using write-optimized Symbol tables.
+
+Puts and removes are buffered in memory and written in batches to
+immutable sorted runs, which a background thread merges. A put does not
+look up the key first: it replaces the value of an existing binding. */
+
+#ifndef SYMTABLELSM_INCLUDE
+#define SYMTABLELSM_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymTableLsm_T;
+
+
+/* Creates a SymTableLsm struct with no bindings and starts its merge
+thread.
+
+Asserts:
+1) if memory was allocated succesfully for oSymTable at runtime.
+2) if the merge thread was created succesfully at runtime. */
+SymTableLsm_T SymTableLsm_new(void);
+
+
+/* Stops the merge thread and frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type */
+void SymTableLsm_free(SymTableLsm_T oSymTable);
+
+
+/* Binds pcKey to pvValue in oSymTable, replacing the value of an
+existing binding with key equal to pcKey.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value */
+void SymTableLsm_put(SymTableLsm_T oSymTable, const char *pcKey,
+        const void *pvValue);
+
+
+/* Removes from oSymTable the binding with key equal to pcKey, if there is
+one.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated. */
+void SymTableLsm_remove(SymTableLsm_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableLsm_contains(SymTableLsm_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableLsm_get(SymTableLsm_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+The bindings are copied first, so pfApply may change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableLsm_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of bindings */
+unsigned int SymTableLsm_map(SymTableLsm_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
@@ -0,0 +1,442 @@
+/* Library for creating and using Symbol tables whose keys use a small
+alphabet.
+
+Every character of the alphabet gets a code from 1 to the size of the
+alphabet, in the order of the characters, and a code takes uiBits bits.
+A key of at most uiPacked characters of the alphabet is packed into two
+words: its first character goes to the most significant bits of the first
+word and unused bits are 0. Packed keys are compared as words, and two
+packed keys order like their strcmp order. Other keys are stored as
+character arrays.
+
+The bindings are kept in a hash table of lists that doubles its size when
+it has more bindings than lists. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "symtablepacked.h"
+
+#define HASH_MULTIPLIER 65599
+#define WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+#define PACKED_MIN_BUCKETS 16
+
+
+/* Struct that represents a binding in the symbol table. A packed key is
+stored in words and key is NULL, otherwise key is a character array.
+
+Note: A binding owns its key. A binding does not own its value. */
+struct pbind {
+    unsigned long words[2];
+    char *key;
+    void *value;
+    struct pbind *next;
+};
+
+
+/* Struct that represents a symbol table. codes maps a character to its
+code, or 0 if it is not in the alphabet, and chars maps a code back to its
+character. uiPerWord characters are packed in a word. */
+struct SymTablePacked {
+    unsigned int uiSize;
+    struct pbind **buckets;
+    unsigned int uiBuckets;
+    unsigned char codes[UCHAR_MAX + 1];
+    char chars[UCHAR_MAX + 1];
+    unsigned int uiBits;
+    unsigned int uiPerWord;
+    unsigned int uiPacked;
+};
+
+
+/* Returns a hash code for pcKey */
+static unsigned int SymTablePacked_hash(const char *pcKey) {
+    unsigned int hash;
+
+    hash = 0U;
+    while(*pcKey) {
+        hash = hash * HASH_MULTIPLIER + (unsigned char) *pcKey;
+        pcKey++;
+    }
+
+    return hash;
+}
+
+
+/* Returns a hash code for a packed key */
+static unsigned int SymTablePacked_hashWords(const unsigned long *words) {
+    unsigned long hash;
+
+    hash = words[0] ^ (words[1] * 0x9e3779b9UL);
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bUL;
+    hash ^= hash >> 16;
+
+    return (unsigned int) (hash ^ (hash >> 16 >> 16));
+}
+
+
+/* Packs pcKey into words.
+
+Returns: 1 if pcKey was packed, 0 if it is too long or has a character
+that is not in the alphabet */
+static int SymTablePacked_pack(struct SymTablePacked *symtable,
+    const char *pcKey, unsigned long *words) {
+    unsigned int i, code;
+
+    words[0] = words[1] = 0UL;
+    for (i = 0; pcKey[i]; i++) {
+        code = symtable->codes[(unsigned char) pcKey[i]];
+        if (!code || i == symtable->uiPacked) {
+            return 0;
+        }
+        words[i / symtable->uiPerWord] |= (unsigned long) code <<
+            (WORD_BITS - symtable->uiBits * (i % symtable->uiPerWord + 1));
+    }
+
+    return 1;
+}
+
+
+/* Unpacks the packed key words into pcKey, which must have room for
+uiPacked + 1 characters */
+static void SymTablePacked_unpack(struct SymTablePacked *symtable,
+    const unsigned long *words, char *pcKey) {
+    unsigned int i, code;
+
+    for (i = 0; i < symtable->uiPacked; i++) {
+        code = (unsigned int) (words[i / symtable->uiPerWord] >>
+            (WORD_BITS - symtable->uiBits * (i % symtable->uiPerWord + 1))) &
+            ((1U << symtable->uiBits) - 1);
+        if (!code) {
+            break;
+        }
+        pcKey[i] = symtable->chars[code];
+    }
+    pcKey[i] = '\0';
+    return;
+}
+
+
+/* Finds the link (the first pointer of a list or the next pointer of a
+binding) that points to the binding with key pcKey, or the link at the
+end of its list if there is no such binding. Sets *packed to 1 and words to
+the packed key if pcKey can be packed. */
+static struct pbind **SymTablePacked_locate(struct SymTablePacked *symtable,
+    const char *pcKey, unsigned long *words, int *packed) {
+    struct pbind **link;
+    unsigned int hash;
+
+    *packed = SymTablePacked_pack(symtable, pcKey, words);
+    hash = *packed ? SymTablePacked_hashWords(words) : SymTablePacked_hash(pcKey);
+    link = &symtable->buckets[hash & (symtable->uiBuckets - 1)];
+    while(*link) {
+        if (*packed) {
+            if (!(*link)->key && (*link)->words[0] == words[0] &&
+                (*link)->words[1] == words[1]) {
+                return link;
+            }
+        }
+        else if ((*link)->key && !strcmp((*link)->key, pcKey)) {
+            return link;
+        }
+        link = &(*link)->next;
+    }
+
+    return link;
+}
+
+
+/* Doubles the number of lists of symtable */
+static void SymTablePacked_grow(struct SymTablePacked *symtable) {
+    struct pbind **buckets, *ptr, *ptr_next;
+    unsigned int i, size, hash;
+
+    size = symtable->uiBuckets * 2;
+    buckets = calloc(size, sizeof(struct pbind *));
+    assert(buckets);
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+            ptr_next = ptr->next;
+            hash = ptr->key ? SymTablePacked_hash(ptr->key) :
+                              SymTablePacked_hashWords(ptr->words);
+            ptr->next = buckets[hash & (size - 1)];
+            buckets[hash & (size - 1)] = ptr;
+        }
+    }
+    free(symtable->buckets);
+    symtable->buckets = buckets;
+    symtable->uiBuckets = size;
+    return;
+}
+
+
+/* Creates a SymTablePacked struct with no bindings for keys made of the
+characters of pcAlphabet. Keys of at most SymTablePacked_getPackedLength
+characters of the alphabet are packed.
+
+Asserts:
+1) if pcAlphabet is not NULL and not empty at runtime.
+2) if memory was allocated succesfully for oSymTable at runtime.
+
+Parameters:
+* pcAlphabet: a character array. Must be null terminated. */
+SymTablePacked_T SymTablePacked_new(const char *pcAlphabet) {
+    struct SymTablePacked *symtable;
+    unsigned int c, count;
+
+    assert(pcAlphabet && *pcAlphabet);
+
+    symtable = malloc(sizeof(struct SymTablePacked));
+    assert(symtable);
+    symtable->uiSize = 0U;
+    symtable->uiBuckets = PACKED_MIN_BUCKETS;
+    symtable->buckets = calloc(symtable->uiBuckets, sizeof(struct pbind *));
+    assert(symtable->buckets);
+
+    /* codes follow the order of the characters */
+    memset(symtable->codes, 0, sizeof(symtable->codes));
+    for (; *pcAlphabet; pcAlphabet++) {
+        symtable->codes[(unsigned char) *pcAlphabet] = 1;
+    }
+    count = 0;
+    for (c = 1; c <= UCHAR_MAX; c++) {
+        if (symtable->codes[c]) {
+            symtable->codes[c] = (unsigned char) ++count;
+            symtable->chars[count] = (char) c;
+        }
+    }
+
+    symtable->uiBits = 1;
+    while((1U << symtable->uiBits) <= count) {
+        symtable->uiBits++;
+    }
+    symtable->uiPerWord = WORD_BITS / symtable->uiBits;
+    symtable->uiPacked = 2 * symtable->uiPerWord;
+
+    return (SymTablePacked_T) symtable;
+}
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+void SymTablePacked_free(SymTablePacked_T oSymTable) {
+    struct SymTablePacked *symtable;
+    struct pbind *ptr, *ptr_next;
+    unsigned int i;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return;
+    }
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr_next) {
+            ptr_next = ptr->next;
+            free(ptr->key);
+            free(ptr);
+        }
+    }
+    free(symtable->buckets);
+    free(symtable);
+    return;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+unsigned int SymTablePacked_getLength(SymTablePacked_T oSymTable) {
+    struct SymTablePacked *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->uiSize;
+}
+
+
+/* Returns the maximum length of the keys that oSymTable packs.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+unsigned int SymTablePacked_getPackedLength(SymTablePacked_T oSymTable) {
+    struct SymTablePacked *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return symtable->uiPacked;
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTablePacked_put(SymTablePacked_T oSymTable, const char *pcKey,
+        const void *pvValue) {
+    struct SymTablePacked *symtable;
+    struct pbind **link, *new_bind;
+    unsigned long words[2];
+    int packed;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    link = SymTablePacked_locate(symtable, pcKey, words, &packed);
+    if (*link) {
+        return 0;
+    }
+
+    new_bind = malloc(sizeof(struct pbind));
+    assert(new_bind);
+    new_bind->words[0] = words[0];
+    new_bind->words[1] = words[1];
+    new_bind->key = NULL;
+    if (!packed) {
+        new_bind->key = malloc((strlen(pcKey) + 1) * sizeof(char));
+        assert(new_bind->key);
+        strcpy(new_bind->key, pcKey);
+    }
+    new_bind->value = (void *) pvValue;
+    new_bind->next = NULL;
+    *link = new_bind;
+
+    symtable->uiSize++;
+    if (symtable->uiSize > symtable->uiBuckets) {
+        SymTablePacked_grow(symtable);
+    }
+
+    return 1;
+}
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTablePacked_remove(SymTablePacked_T oSymTable, const char *pcKey) {
+    struct SymTablePacked *symtable;
+    struct pbind **link, *ptr;
+    unsigned long words[2];
+    int packed;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    link = SymTablePacked_locate(symtable, pcKey, words, &packed);
+    ptr = *link;
+    if (!ptr) {
+        return 0;
+    }
+    *link = ptr->next;
+    free(ptr->key);
+    free(ptr);
+    symtable->uiSize--;
+
+    return 1;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTablePacked_contains(SymTablePacked_T oSymTable, const char *pcKey) {
+    unsigned long words[2];
+    int packed;
+
+    assert(oSymTable);
+    assert(pcKey);
+
+    return *SymTablePacked_locate(oSymTable, pcKey, words, &packed) != NULL;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTablePacked_get(SymTablePacked_T oSymTable, const char *pcKey) {
+    struct pbind **link;
+    unsigned long words[2];
+    int packed;
+
+    assert(oSymTable);
+    assert(pcKey);
+
+    link = SymTablePacked_locate(oSymTable, pcKey, words, &packed);
+
+    return *link ? (*link)->value : NULL;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable. Packed keys are
+unpacked into a buffer that is valid only during the call to pfApply.
+pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTablePacked_map(SymTablePacked_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra) {
+    struct SymTablePacked *symtable;
+    struct pbind *ptr;
+    char key[2 * WORD_BITS + 1];
+    unsigned int i;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    for (i = 0; i < symtable->uiBuckets; i++) {
+        for (ptr = symtable->buckets[i]; ptr; ptr = ptr->next) {
+            if (ptr->key) {
+                pfApply(ptr->key, ptr->value, (void *) pvExtra);
+            }
+            else {
+                SymTablePacked_unpack(symtable, ptr->words, key);
+                pfApply(key, ptr->value, (void *) pvExtra);
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/* Library for creating and using Symbol tables whose keys use a small
+alphabet.
+
+A key made of the characters of the alphabet is packed into two machine
+words, a few bits per character, and is stored and compared as words
+without a separate key allocation. Other keys are stored as character
+arrays. */
+
+#ifndef SYMTABLEPACKED_INCLUDE
+#define SYMTABLEPACKED_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymTablePacked_T;
+
+
+/* Creates a SymTablePacked struct with no bindings for keys made of the
+characters of pcAlphabet. Keys of at most SymTablePacked_getPackedLength
+characters of the alphabet are packed.
+
+Asserts:
+1) if pcAlphabet is not NULL and not empty at runtime.
+2) if memory was allocated succesfully for oSymTable at runtime.
+
+Parameters:
+* pcAlphabet: a character array. Must be null terminated. */
+SymTablePacked_T SymTablePacked_new(const char *pcAlphabet);
+
+
+/* Frees all memory used by oSymTable.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+void SymTablePacked_free(SymTablePacked_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+unsigned int SymTablePacked_getLength(SymTablePacked_T oSymTable);
+
+
+/* Returns the maximum length of the keys that oSymTable packs.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type */
+unsigned int SymTablePacked_getPackedLength(SymTablePacked_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTablePacked_put(SymTablePacked_T oSymTable, const char *pcKey,
+        const void *pvValue);
+
+
+/* Removes a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was successful, 0 if such binding was not found */
+int SymTablePacked_remove(SymTablePacked_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTablePacked_contains(SymTablePacked_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTablePacked_get(SymTablePacked_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable. Packed keys are
+unpacked into a buffer that is valid only during the call to pfApply.
+pfApply must not change oSymTable.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTablePacked_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTablePacked_map(SymTablePacked_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif
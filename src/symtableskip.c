@@ -0,0 +1,843 @@
+/* Library for creating and using ordered Symbol tables that can be shared
+by many threads without locks.
+
+The bindings are kept in a lock-free skip list. A binding is removed by
+marking its links, from the top level down to level 0 (the lowest bit of
+a marked link is set). The mark on level 0 decides which thread removed
+the binding. Marked bindings are unlinked by any thread that passes them
+while searching.
+
+Removed bindings are freed with epoch based reclamation: a thread that
+works on the table publishes the epoch it started in, a removed binding is
+retired with the epoch in which it was unlinked, and it is freed once the
+table epoch is 2 ahead, when no thread can still be looking at it.
+
+The library has one thread key, whose value is the list of the records of
+the thread, one per table it used. When a thread exits, its records are
+freed and the bindings it retired are handed to their tables, which free
+them once their epoch is old enough. */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symtableskip.h"
+
+#define SKIP_LEVELS 20      /* maximum levels of a binding */
+#define SKIP_ADVANCE 64     /* retired bindings between epoch advances */
+
+#define STATE_LINKED 1      /* the inserting thread has finished linking */
+#define STATE_REMOVED 2     /* the removing thread has marked level 0 */
+
+
+/* Struct that represents a binding in the skip list. Each binding has a
+pointer to its key, a pointer to any value, the links of its iLevels
+levels and a pointer to the next retired binding. iState tells whether
+both the insertion and the removal of the binding have finished. The key
+is stored after the links.
+
+Note: A binding owns its key. A binding does not own its value. */
+struct snode {
+    char *key;
+    void *value;
+    int iLevels;
+    int iState;
+    unsigned long ulRetired;
+    struct snode *retired_next;
+    struct snode *next[1];
+};
+
+
+/* Struct that represents a thread that uses symtable. ulEpoch is the
+epoch in which its current operation started and iDepth is non zero during
+an operation. Bindings retired by the thread are kept in 3 lists by
+epoch. next links the records of symtable, thread_next the records of the
+thread.
+
+A record is freed by its thread when it exits, or by the thread when it
+next looks for its records if the table was freed first: symtable is set
+to NULL when the table is freed, under SymTableSkip_threadLock. */
+struct sthread {
+    unsigned long ulEpoch;
+    int iDepth;
+    unsigned int uiSeed;
+    unsigned int uiRetired;
+    struct snode *retired[3];
+    struct sthread *next;
+    struct SymTableSkip *symtable;
+    struct sthread *thread_next;
+};
+
+
+/* Struct that represents a symbol table as a skip list. head has
+SKIP_LEVELS levels and no key. uiSize and ulEpoch are updated atomically.
+The threads that use the table are kept in a list protected by
+thread_lock, and so are the bindings retired by threads that exited
+(orphans), which are freed when the epoch advances. */
+struct SymTableSkip {
+    unsigned int uiSize;
+    unsigned long ulEpoch;
+    struct snode *head;
+    pthread_mutex_t thread_lock;
+    struct sthread *threads;
+    struct snode *orphans;
+};
+
+
+/* The thread key of the records, created once for all tables, and the
+lock of the owners of the records */
+static pthread_once_t SymTableSkip_once = PTHREAD_ONCE_INIT;
+static pthread_key_t SymTableSkip_threadKey;
+static pthread_mutex_t SymTableSkip_threadLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* Returns 1 if link is marked, 0 otherwise */
+static int SymTableSkip_isMarked(struct snode *link) {
+    return (unsigned long) link & 1UL;
+}
+
+
+/* Returns link with the mark set */
+static struct snode *SymTableSkip_mark(struct snode *link) {
+    return (struct snode *) ((unsigned long) link | 1UL);
+}
+
+
+/* Returns link with the mark cleared */
+static struct snode *SymTableSkip_unmark(struct snode *link) {
+    return (struct snode *) ((unsigned long) link & ~1UL);
+}
+
+
+/* Returns the link of node at level */
+static struct snode *SymTableSkip_load(struct snode *node, int level) {
+    return __atomic_load_n(&node->next[level], __ATOMIC_ACQUIRE);
+}
+
+
+/* Changes the link of node at level from expected to desired.
+
+Returns: 1 on success, 0 if the link was not equal to expected */
+static int SymTableSkip_cas(struct snode *node, int level,
+    struct snode *expected, struct snode *desired) {
+    return __atomic_compare_exchange_n(&node->next[level], &expected, desired,
+                                       0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+
+/* Allocates a binding with iLevels levels and a copy of pcKey, or the
+head if pcKey is NULL */
+static struct snode *SymTableSkip_newNode(const char *pcKey,
+    const void *pvValue, int iLevels) {
+    struct snode *node;
+    size_t size;
+    int i;
+
+    size = offsetof(struct snode, next) + iLevels * sizeof(struct snode *);
+    node = malloc(size + (pcKey ? strlen(pcKey) + 1 : 0));
+    assert(node);
+    node->key = NULL;
+    if (pcKey) {
+        node->key = (char *) node + size;
+        strcpy(node->key, pcKey);
+    }
+    node->value = (void *) pvValue;
+    node->iLevels = iLevels;
+    node->iState = 0;
+    node->retired_next = NULL;
+    for (i = 0; i < iLevels; i++) {
+        node->next[i] = NULL;
+    }
+
+    return node;
+}
+
+
+/* Frees the records of a thread that exits. A record of a table that is
+not freed is removed from the threads of the table, and the bindings it
+retired become orphans of the table. Registered as the destructor of the
+thread key. */
+static void SymTableSkip_threadExit(void *pvThread) {
+    struct sthread *thread, *thread_next, **link;
+    struct SymTableSkip *symtable;
+    struct snode *node;
+    int i;
+
+    pthread_mutex_lock(&SymTableSkip_threadLock);
+    for (thread = pvThread; thread; thread = thread_next) {
+        thread_next = thread->thread_next;
+        symtable = __atomic_load_n(&thread->symtable, __ATOMIC_ACQUIRE);
+        if (symtable) {
+            pthread_mutex_lock(&symtable->thread_lock);
+            for (link = &symtable->threads; *link != thread;
+                 link = &(*link)->next);
+            *link = thread->next;
+            for (i = 0; i < 3; i++) {
+                while((node = thread->retired[i])) {
+                    thread->retired[i] = node->retired_next;
+                    node->retired_next = symtable->orphans;
+                    symtable->orphans = node;
+                }
+            }
+            pthread_mutex_unlock(&symtable->thread_lock);
+        }
+        free(thread);
+    }
+    pthread_mutex_unlock(&SymTableSkip_threadLock);
+}
+
+
+/* Creates the thread key of the records. Called once. */
+static void SymTableSkip_makeKey(void) {
+    int error;
+
+    error = pthread_key_create(&SymTableSkip_threadKey, SymTableSkip_threadExit);
+    assert(!error);
+}
+
+
+/* Returns the record of the calling thread, which is created when the
+thread uses symtable for the first time. Records of freed tables are freed
+on the way, and the returned record is moved to the front of the list of
+the thread. */
+static struct sthread *SymTableSkip_thread(struct SymTableSkip *symtable) {
+    struct sthread *first, *thread, **link;
+    struct SymTableSkip *owner;
+
+    pthread_once(&SymTableSkip_once, SymTableSkip_makeKey);
+    first = pthread_getspecific(SymTableSkip_threadKey);
+    if (first && __atomic_load_n(&first->symtable, __ATOMIC_ACQUIRE) == symtable) {
+        return first;
+    }
+    link = &first;
+    while(*link) {
+        thread = *link;
+        owner = __atomic_load_n(&thread->symtable, __ATOMIC_ACQUIRE);
+        if (owner == symtable) {
+            *link = thread->thread_next;
+            thread->thread_next = first;
+            pthread_setspecific(SymTableSkip_threadKey, thread);
+            return thread;
+        }
+        if (owner) {
+            link = &thread->thread_next;
+            continue;
+        }
+        *link = thread->thread_next;
+        free(thread);
+    }
+
+    thread = malloc(sizeof(struct sthread));
+    assert(thread);
+    thread->ulEpoch = 0;
+    thread->iDepth = 0;
+    thread->uiSeed = (unsigned int) (unsigned long) thread | 1U;
+    thread->uiRetired = 0;
+    thread->retired[0] = thread->retired[1] = thread->retired[2] = NULL;
+    thread->symtable = symtable;
+    thread->thread_next = first;
+    pthread_mutex_lock(&symtable->thread_lock);
+    thread->next = symtable->threads;
+    symtable->threads = thread;
+    pthread_mutex_unlock(&symtable->thread_lock);
+    pthread_setspecific(SymTableSkip_threadKey, thread);
+
+    return thread;
+}
+
+
+/* Starts an operation of the calling thread. Bindings seen during the
+operation are not freed until SymTableSkip_exit. Operations can be
+nested. */
+static struct sthread *SymTableSkip_enter(struct SymTableSkip *symtable) {
+    struct sthread *thread;
+    unsigned long epoch;
+
+    thread = SymTableSkip_thread(symtable);
+    __atomic_store_n(&thread->iDepth, thread->iDepth + 1, __ATOMIC_SEQ_CST);
+    if (thread->iDepth > 1) {
+        return thread;
+    }
+
+    /* the epoch may advance before it is published: publish it again */
+    do {
+        epoch = __atomic_load_n(&symtable->ulEpoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&thread->ulEpoch, epoch, __ATOMIC_SEQ_CST);
+    } while(epoch != __atomic_load_n(&symtable->ulEpoch, __ATOMIC_SEQ_CST));
+
+    return thread;
+}
+
+
+/* Ends an operation of thread */
+static void SymTableSkip_exit(struct sthread *thread) {
+    __atomic_store_n(&thread->iDepth, thread->iDepth - 1, __ATOMIC_RELEASE);
+}
+
+
+/* Frees a list of retired bindings */
+static void SymTableSkip_freeRetired(struct snode *node) {
+    struct snode *node_next;
+
+    while(node) {
+        node_next = node->retired_next;
+        free(node);
+        node = node_next;
+    }
+}
+
+
+/* Advances the table epoch if every thread in an operation has started
+in the current epoch, and frees the orphans retired at least 2 epochs
+ago */
+static void SymTableSkip_advance(struct SymTableSkip *symtable) {
+    struct sthread *thread;
+    struct snode *node, **link;
+    unsigned long epoch;
+
+    epoch = __atomic_load_n(&symtable->ulEpoch, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&symtable->thread_lock);
+    for (thread = symtable->threads; thread; thread = thread->next) {
+        if (__atomic_load_n(&thread->iDepth, __ATOMIC_SEQ_CST) &&
+            __atomic_load_n(&thread->ulEpoch, __ATOMIC_SEQ_CST) != epoch) {
+            pthread_mutex_unlock(&symtable->thread_lock);
+            return;
+        }
+    }
+    link = &symtable->orphans;
+    while((node = *link)) {
+        if (node->ulRetired + 2 <= epoch) {
+            *link = node->retired_next;
+            free(node);
+        }
+        else {
+            link = &node->retired_next;
+        }
+    }
+    pthread_mutex_unlock(&symtable->thread_lock);
+    __atomic_compare_exchange_n(&symtable->ulEpoch, &epoch, epoch + 1, 0,
+                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+
+/* Retires node, which is no longer reachable from the head, and frees the
+bindings retired by thread at least 2 epochs ago */
+static void SymTableSkip_retire(struct SymTableSkip *symtable,
+    struct sthread *thread, struct snode *node) {
+    unsigned long epoch;
+    int i;
+
+    epoch = __atomic_load_n(&symtable->ulEpoch, __ATOMIC_SEQ_CST);
+    for (i = 0; i < 3; i++) {
+        if (thread->retired[i] && thread->retired[i]->ulRetired + 2 <= epoch) {
+            SymTableSkip_freeRetired(thread->retired[i]);
+            thread->retired[i] = NULL;
+        }
+    }
+
+    /* all bindings of a list are retired in the same epoch */
+    node->ulRetired = epoch;
+    node->retired_next = thread->retired[epoch % 3];
+    thread->retired[epoch % 3] = node;
+
+    thread->uiRetired++;
+    if (thread->uiRetired % SKIP_ADVANCE == 0) {
+        SymTableSkip_advance(symtable);
+    }
+}
+
+
+/* Finds for every level the last binding with key < pcKey (preds) and the
+binding after it (succs), unlinking the marked bindings it passes.
+
+Returns: 1 on success, 0 if an unlink failed and the search must be
+repeated */
+static int SymTableSkip_search(struct SymTableSkip *symtable,
+    const char *pcKey, struct snode **preds, struct snode **succs) {
+    struct snode *pred, *curr, *succ;
+    int level;
+
+    pred = symtable->head;
+    for (level = SKIP_LEVELS - 1; level >= 0; level--) {
+        curr = SymTableSkip_unmark(SymTableSkip_load(pred, level));
+        while(curr) {
+            succ = SymTableSkip_load(curr, level);
+            if (SymTableSkip_isMarked(succ)) {
+                if (!SymTableSkip_cas(pred, level, curr,
+                                      SymTableSkip_unmark(succ))) {
+                    return 0;
+                }
+                curr = SymTableSkip_unmark(succ);
+            }
+            else if (strcmp(curr->key, pcKey) < 0) {
+                pred = curr;
+                curr = succ;
+            }
+            else {
+                break;
+            }
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+
+    return 1;
+}
+
+
+/* Calls SymTableSkip_search until it succeeds.
+
+Returns: 1 if succs[0] has key equal to pcKey, 0 otherwise */
+static int SymTableSkip_find(struct SymTableSkip *symtable,
+    const char *pcKey, struct snode **preds, struct snode **succs) {
+    while(!SymTableSkip_search(symtable, pcKey, preds, succs));
+
+    return succs[0] && !strcmp(succs[0]->key, pcKey);
+}
+
+
+/* Unlinks on every level all marked bindings with key <= the key of
+node, including node, which must be marked on all its levels. Unlike
+SymTableSkip_search this does not stop at a binding with equal key, since
+the removed node may be linked after a newer binding with the same key.
+
+Returns: 1 on success, 0 if an unlink failed and it must be repeated */
+static int SymTableSkip_unlinkOnce(struct SymTableSkip *symtable,
+    struct snode *node) {
+    struct snode *pred, *prev, *curr, *succ;
+    int level, cmp;
+
+    pred = symtable->head;
+    for (level = SKIP_LEVELS - 1; level >= 0; level--) {
+
+        /* bindings linked after pred was removed are not reachable from it */
+        prev = pred;
+        curr = SymTableSkip_load(prev, level);
+        if (SymTableSkip_isMarked(curr)) {
+            return 0;
+        }
+        while(curr) {
+            succ = SymTableSkip_load(curr, level);
+            if (SymTableSkip_isMarked(succ)) {
+                if (!SymTableSkip_cas(prev, level, curr,
+                                      SymTableSkip_unmark(succ))) {
+                    return 0;
+                }
+                curr = SymTableSkip_unmark(succ);
+                continue;
+            }
+            cmp = strcmp(curr->key, node->key);
+            if (cmp > 0) {
+                break;
+            }
+
+            /* the next level starts from the last binding with a smaller key */
+            if (cmp < 0) {
+                pred = curr;
+            }
+            prev = curr;
+            curr = succ;
+        }
+    }
+
+    return 1;
+}
+
+
+/* Called by the thread that finishes second between the insertion and
+the removal of node: unlinks node from all levels and retires it */
+static void SymTableSkip_release(struct SymTableSkip *symtable,
+    struct sthread *thread, struct snode *node) {
+    while(!SymTableSkip_unlinkOnce(symtable, node));
+    SymTableSkip_retire(symtable, thread, node);
+}
+
+
+/* Returns the first binding that is not removed and has key >= pcKey, or
+the first binding if pcKey is NULL. Does not write to the list. */
+static struct snode *SymTableSkip_seek(struct SymTableSkip *symtable,
+    const char *pcKey) {
+    struct snode *pred, *curr, *succ;
+    int level;
+
+    pred = symtable->head;
+    for (level = SKIP_LEVELS - 1; level >= 0; level--) {
+        curr = SymTableSkip_unmark(SymTableSkip_load(pred, level));
+        while(curr) {
+            succ = SymTableSkip_load(curr, level);
+            if (SymTableSkip_isMarked(succ)) {
+                curr = SymTableSkip_unmark(succ);
+            }
+            else if (pcKey && strcmp(curr->key, pcKey) < 0) {
+                pred = curr;
+                curr = succ;
+            }
+            else {
+                break;
+            }
+        }
+    }
+
+    return curr;
+}
+
+
+/* Returns a random number of levels: 1 with probability 3/4, 2 with
+probability 3/16, ... */
+static int SymTableSkip_randomLevels(struct sthread *thread) {
+    unsigned int x;
+    int levels;
+
+    /* xorshift */
+    x = thread->uiSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread->uiSeed = x;
+
+    levels = 1;
+    while((x & 3U) == 0 && levels < SKIP_LEVELS) {
+        levels++;
+        x >>= 2;
+    }
+
+    return levels;
+}
+
+
+/* Creates a SymTableSkip struct with no bindings. Bindings are ordered by
+key (strcmp order).
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableSkip_T SymTableSkip_new(void) {
+    struct SymTableSkip *symtable;
+
+    symtable = malloc(sizeof(struct SymTableSkip));
+    assert(symtable);
+    symtable->uiSize = 0U;
+    symtable->ulEpoch = 0;
+    symtable->head = SymTableSkip_newNode(NULL, NULL, SKIP_LEVELS);
+    pthread_mutex_init(&symtable->thread_lock, NULL);
+    symtable->threads = NULL;
+    symtable->orphans = NULL;
+
+    return (SymTableSkip_T) symtable;
+}
+
+
+/* Frees all memory used by oSymTable. No other thread may use oSymTable
+during or after this call.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type */
+void SymTableSkip_free(SymTableSkip_T oSymTable) {
+    struct SymTableSkip *symtable;
+    struct snode *node, *node_next;
+    struct sthread *thread, *thread_next;
+    int i;
+
+    symtable = oSymTable;
+    if (!symtable) {
+        return;
+    }
+
+    /* removed bindings are not linked, they are retired or orphans */
+    node = symtable->head;
+    while(node) {
+        node_next = SymTableSkip_unmark(node->next[0]);
+        free(node);
+        node = node_next;
+    }
+    /* the records are freed by their threads, which are still running */
+    pthread_mutex_lock(&SymTableSkip_threadLock);
+    thread = symtable->threads;
+    while(thread) {
+        thread_next = thread->next;
+        for (i = 0; i < 3; i++) {
+            SymTableSkip_freeRetired(thread->retired[i]);
+            thread->retired[i] = NULL;
+        }
+        __atomic_store_n(&thread->symtable, NULL, __ATOMIC_RELEASE);
+        thread = thread_next;
+    }
+    pthread_mutex_unlock(&SymTableSkip_threadLock);
+
+    /* exiting threads stopped adding orphans when the records were taken */
+    SymTableSkip_freeRetired(symtable->orphans);
+    pthread_mutex_destroy(&symtable->thread_lock);
+    free(symtable);
+
+    return;
+}
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type */
+unsigned int SymTableSkip_getLength(SymTableSkip_T oSymTable) {
+    struct SymTableSkip *symtable;
+
+    symtable = oSymTable;
+    assert(symtable);
+
+    return __atomic_load_n(&symtable->uiSize, __ATOMIC_RELAXED);
+}
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableSkip_put(SymTableSkip_T oSymTable, const char *pcKey,
+    const void *pvValue) {
+    struct SymTableSkip *symtable;
+    struct sthread *thread;
+    struct snode *node, *succ, *preds[SKIP_LEVELS], *succs[SKIP_LEVELS];
+    int level;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    thread = SymTableSkip_enter(symtable);
+    node = NULL;
+
+    /* link level 0: this makes the binding visible */
+    while(1) {
+        if (SymTableSkip_find(symtable, pcKey, preds, succs)) {
+            free(node);
+            SymTableSkip_exit(thread);
+            return 0;
+        }
+        if (!node) {
+            node = SymTableSkip_newNode(pcKey, pvValue,
+                                        SymTableSkip_randomLevels(thread));
+        }
+        for (level = 0; level < node->iLevels; level++) {
+            node->next[level] = succs[level];
+        }
+        if (SymTableSkip_cas(preds[0], 0, succs[0], node)) {
+            break;
+        }
+    }
+    __atomic_add_fetch(&symtable->uiSize, 1, __ATOMIC_RELAXED);
+
+    /* link the upper levels, unless a remove has started marking them */
+    for (level = 1; level < node->iLevels; level++) {
+        while(1) {
+            succ = SymTableSkip_load(node, level);
+            if (SymTableSkip_isMarked(succ)) {
+                break;
+            }
+            if (succ != succs[level] &&
+                !SymTableSkip_cas(node, level, succ, succs[level])) {
+                break;
+            }
+            if (SymTableSkip_cas(preds[level], level, succs[level], node)) {
+                break;
+            }
+            SymTableSkip_find(symtable, pcKey, preds, succs);
+        }
+        if (SymTableSkip_isMarked(SymTableSkip_load(node, level))) {
+            break;
+        }
+    }
+
+    if (__atomic_fetch_or(&node->iState, STATE_LINKED, __ATOMIC_ACQ_REL) &
+        STATE_REMOVED) {
+        SymTableSkip_release(symtable, thread, node);
+    }
+    SymTableSkip_exit(thread);
+
+    return 1;
+}
+
+
+/* Removes from oSymTable the binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was succesful, 0 if key was not found */
+int SymTableSkip_remove(SymTableSkip_T oSymTable, const char *pcKey) {
+    struct SymTableSkip *symtable;
+    struct sthread *thread;
+    struct snode *node, *succ, *preds[SKIP_LEVELS], *succs[SKIP_LEVELS];
+    int level;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    thread = SymTableSkip_enter(symtable);
+    if (!SymTableSkip_find(symtable, pcKey, preds, succs)) {
+        SymTableSkip_exit(thread);
+        return 0;
+    }
+    node = succs[0];
+
+    /* mark the upper levels so that they are not linked any more */
+    for (level = node->iLevels - 1; level >= 1; level--) {
+        do {
+            succ = SymTableSkip_load(node, level);
+        } while(!SymTableSkip_isMarked(succ) &&
+                !SymTableSkip_cas(node, level, succ, SymTableSkip_mark(succ)));
+    }
+
+    /* the thread that marks level 0 removes the binding */
+    while(1) {
+        succ = SymTableSkip_load(node, 0);
+        if (SymTableSkip_isMarked(succ)) {
+            SymTableSkip_exit(thread);
+            return 0;
+        }
+        if (SymTableSkip_cas(node, 0, succ, SymTableSkip_mark(succ))) {
+            break;
+        }
+    }
+    __atomic_sub_fetch(&symtable->uiSize, 1, __ATOMIC_RELAXED);
+
+    if (__atomic_fetch_or(&node->iState, STATE_REMOVED, __ATOMIC_ACQ_REL) &
+        STATE_LINKED) {
+        SymTableSkip_release(symtable, thread, node);
+    }
+    SymTableSkip_exit(thread);
+
+    return 1;
+}
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableSkip_contains(SymTableSkip_T oSymTable, const char *pcKey) {
+    struct SymTableSkip *symtable;
+    struct sthread *thread;
+    struct snode *node;
+    int found;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    thread = SymTableSkip_enter(symtable);
+    node = SymTableSkip_seek(symtable, pcKey);
+    found = node && !strcmp(node->key, pcKey);
+    SymTableSkip_exit(thread);
+
+    return found;
+}
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableSkip_get(SymTableSkip_T oSymTable, const char *pcKey) {
+    struct SymTableSkip *symtable;
+    struct sthread *thread;
+    struct snode *node;
+    void *value;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pcKey);
+
+    thread = SymTableSkip_enter(symtable);
+    node = SymTableSkip_seek(symtable, pcKey);
+    value = node && !strcmp(node->key, pcKey) ? node->value : NULL;
+    SymTableSkip_exit(thread);
+
+    return value;
+}
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+Bindings put or removed by other threads during the call may or may not
+be visited.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableSkip_map(SymTableSkip_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    SymTableSkip_range(oSymTable, NULL, NULL, pfApply, pvExtra);
+}
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. Bindings put or removed by other
+threads during the call may or may not be visited.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableSkip_range(SymTableSkip_T oSymTable, const char *pcLow,
+    const char *pcHigh,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct SymTableSkip *symtable;
+    struct sthread *thread;
+    struct snode *node, *succ;
+    unsigned int count;
+
+    symtable = oSymTable;
+    assert(symtable);
+    assert(pfApply);
+
+    count = 0;
+    thread = SymTableSkip_enter(symtable);
+    node = SymTableSkip_seek(symtable, pcLow);
+    while(node && (!pcHigh || strcmp(node->key, pcHigh) < 0)) {
+        succ = SymTableSkip_load(node, 0);
+        if (!SymTableSkip_isMarked(succ)) {
+            pfApply(node->key, node->value, (void *) pvExtra);
+            count++;
+        }
+        node = SymTableSkip_unmark(succ);
+    }
+    SymTableSkip_exit(thread);
+
+    return count;
+}
@@ -0,0 +1,124 @@
+/* Library for creating and using ordered Symbol tables that can be shared
+by many threads without locks */
+
+#ifndef SYMTABLESKIP_INCLUDE
+#define SYMTABLESKIP_INCLUDE
+
+#include <stdio.h>
+
+typedef void* SymTableSkip_T;
+
+
+/* Creates a SymTableSkip struct with no bindings. Bindings are ordered by
+key (strcmp order).
+
+Asserts: if memory was allocated succesfully for oSymTable at runtime. */
+SymTableSkip_T SymTableSkip_new(void);
+
+
+/* Frees all memory used by oSymTable. No other thread may use oSymTable
+during or after this call.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type */
+void SymTableSkip_free(SymTableSkip_T oSymTable);
+
+
+/* Returns the number of bindings in oSymTable.
+
+Asserts: if oSymTable is not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type */
+unsigned int SymTableSkip_getLength(SymTableSkip_T oSymTable);
+
+
+/* Creates a new binding for oSymTable from a given pcKey and pvValue.
+
+Asserts:
+1) if oSymTable and pcKey are not NULL at runtime.
+2) if necessary memory was allocated succesfully at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+* pvValue: pointer to any value
+
+Returns: 1 if binding was created succesfully, 0 if there is already
+a binding with key equal to pcKey. */
+int SymTableSkip_put(SymTableSkip_T oSymTable, const char *pcKey,
+        const void *pvValue);
+
+
+/* Removes from oSymTable the binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: 1 if removal was succesful, 0 if key was not found */
+int SymTableSkip_remove(SymTableSkip_T oSymTable, const char *pcKey);
+
+
+/* Checks whether a binding with key equal to pcKey is present in oSymTable.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type.
+* pcKey: character array (key). Must be null terminated.
+
+Returns: 1 if pcKey is found, 0 otherwise */
+int SymTableSkip_contains(SymTableSkip_T oSymTable, const char *pcKey);
+
+
+/* Finds in oSymTable a binding with key equal to pcKey.
+
+Asserts: if oSymTable and pcKey are not NULL at runtime.
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcKey: a character array (key). Must be null terminated.
+
+Returns: a pointer to the value or NULL if such binding was not found. */
+void* SymTableSkip_get(SymTableSkip_T oSymTable, const char *pcKey);
+
+
+/* Applies function pfApply to every binding in oSymTable in key order.
+Bindings put or removed by other threads during the call may or may not
+be visited.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply. */
+void SymTableSkip_map(SymTableSkip_T oSymTable,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+/* Applies function pfApply in key order to every binding in oSymTable
+whose key is >= pcLow and < pcHigh. Bindings put or removed by other
+threads during the call may or may not be visited.
+
+Asserts: if oSymTable and pfApply are not NULL at runtime
+
+Parameters:
+* oSymTable: a SymTableSkip_T type
+* pcLow: a character array or NULL for no lower bound
+* pcHigh: a character array or NULL for no upper bound
+* pfApply: function to apply
+* pvExtra: a pointer to any value. Used by pfApply.
+
+Returns: the number of visited bindings */
+unsigned int SymTableSkip_range(SymTableSkip_T oSymTable, const char *pcLow,
+        const char *pcHigh,
+        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+        const void *pvExtra);
+
+
+#endif